@@ -1,4 +1,11 @@
 {
+    "variables": {
+        # build offscreen renderer on Linux (node-gyp rebuild --headless=1)
+        "headless%": "0",
+
+        # NEON matrix kernels on 32-bit ARM (Raspberry Pi 2 and later, use --neon=0 on Pi 1 and Zero)
+        "neon%": "1"
+    },
     "targets": [
         {
             "target_name": "aminonative",
@@ -19,6 +26,7 @@
                 "src/fonts.cpp",
                 "src/images.cpp",
                 "src/videos.cpp",
+                "src/animations.cpp",
                 "src/shaders.cpp",
                 "src/renderer.cpp",
                 "src/mathutils.cpp"
@@ -57,6 +65,7 @@
                     ],
                     "sources": [
                         "src/mac.cpp",
+                        "src/mac_video.cpp"
                     ],
                     "defines": [
                         "MAC",
@@ -126,12 +135,23 @@
                                 # get stack trace on ARM
                                 "-funwind-tables",
                                 "-rdynamic"
+                            ],
+                            "conditions": [
+                                # ARMv7 with NEON (Raspbian: hard float)
+                                ["neon=='1'", {
+                                    "cflags": [
+                                        "-march=armv7-a",
+                                        "-mfpu=neon-vfpv4",
+                                        "-mfloat-abi=hard"
+                                    ]
+                                }]
                             ]
 		                }],
 
-		                ["target_arch!='arm'", {
+		                ["target_arch!='arm' and headless!='1'", {
 		                    "sources": [
-		                        "src/mac.cpp"
+		                        "src/mac.cpp",
+		                        "src/mac_video.cpp"
 		                    ],
 		                    "libraries":[
 		                        '<!@(freetype-config --libs)',
@@ -147,6 +167,30 @@
 		                        "../../../../../staging/usr/include/freetype2",
 		                        "<!@(freetype-config --cflags)"
 		                    ]
+		                }],
+
+		                # Headless (EGL offscreen)
+		                ["target_arch!='arm' and headless=='1'", {
+		                    "sources": [
+		                        "src/headless.cpp",
+		                        "src/mac_video.cpp"
+		                    ],
+		                    "libraries":[
+		                        '<!@(freetype-config --libs)',
+		                        "-lGLESv2",
+		                        "-lEGL",
+		                        "-ljpeg",
+		                        "-lpng",
+		                        '-lavcodec',
+		                        '-lavformat',
+		                        '-lswscale'
+		                    ],
+		                    "defines": [
+		                        "HEADLESS"
+		                    ],
+		                    "include_dirs": [
+		                        "<!@(freetype-config --cflags)"
+		                    ]
 		                }]
 		            ]
                 }]
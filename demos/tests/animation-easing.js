@@ -0,0 +1,50 @@
+'use strict';
+
+/*
+ * Shows all time functions, a cubic-bezier curve, a spring and a keyframe track.
+ */
+
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //root
+    const root = this.createGroup();
+
+    this.setRoot(root);
+
+    //rects
+    const w = this.w();
+    const timeFuncs = ['linear', 'cubicIn', 'cubicOut', 'cubicInOut',
+        'elasticIn', 'elasticOut', 'elasticInOut',
+        'bounceIn', 'bounceOut', 'bounceInOut'];
+    let y = 10;
+
+    const createRect = () => {
+        const rect = this.createRect().w(20).h(20).y(y).fill('#0000FF');
+
+        root.add(rect);
+        y += 30;
+
+        return rect;
+    };
+
+    for (let tf of timeFuncs) {
+        createRect().x.anim().from(0).to(w - 20).dur(2000).autoreverse(true).loop(-1).timeFunc(tf).start();
+    }
+
+    //cubic-bezier
+    createRect().fill('#FF0000').x.anim().from(0).to(w - 20).dur(2000).autoreverse(true).loop(-1).bezier(0.68, -0.55, 0.27, 1.55).start();
+
+    //spring
+    createRect().fill('#FF0000').x.anim().from(0).to(w - 20).dur(2000).autoreverse(true).loop(-1).spring(6, 25).start();
+
+    //keyframes
+    createRect().fill('#00FF00').x.anim().keyframes([0, w - 20, w / 2, w - 20], [0, 0.5, 0.75, 1]).dur(4000).loop(-1).timeFunc('linear').start();
+});
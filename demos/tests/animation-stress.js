@@ -0,0 +1,46 @@
+'use strict';
+
+/*
+ * Runs many concurrent float animations.
+ *
+ * Usage: node animation-stress.js [count]
+ */
+
+const count = process.argv.length > 2 ? parseInt(process.argv[2]) : 10000;
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //root
+    const root = this.createGroup();
+
+    this.setRoot(root);
+
+    //rects
+    const w = this.w();
+    const h = this.h();
+    const timeFuncs = ['linear', 'cubicIn', 'cubicOut', 'cubicInOut'];
+
+    for (let i = 0; i < count; i++) {
+        const rect = this.createRect().w(4).h(4).x(Math.random() * w).fill('#00FF00');
+
+        rect.y.anim().from(0).to(h - 4).dur(1000 + Math.random() * 2000).autoreverse(true).loop(-1).timeFunc(timeFuncs[i % 4]).start();
+
+        root.add(rect);
+    }
+
+    console.log('animations: ' + count);
+
+    //stats
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('fps: ' + JSON.stringify(stats.fps) + ' tracks: ' + stats.animationTracks);
+    }, 1000);
+});
@@ -0,0 +1,49 @@
+'use strict';
+
+/*
+ * Glyph atlas cache benchmark.
+ *
+ * Loads Latin-1 in several font sizes. Run twice: the first run (cold) renders all glyphs, the second run (warm) restores
+ * them from the cache directory.
+ *
+ * Usage: node font-cache.js [cacheDir]
+ */
+
+const os = require('os');
+const path = require('path');
+const amino = require('../../main.js');
+
+const cacheDir = process.argv.length > 2 ? process.argv[2] : path.join(os.tmpdir(), 'amino-font-cache');
+const sizes = [ 12, 14, 16, 18, 20, 24, 28, 32, 40, 48, 60 ];
+
+amino.fonts.setCacheDir(cacheDir);
+
+const startTime = Date.now();
+let open = sizes.length;
+let glyphs = 0;
+
+for (const size of sizes) {
+    amino.fonts.getFont({ size: size }, (err, fontSize) => {
+        if (err) {
+            console.log('could not load font: ' + err.message);
+            return;
+        }
+
+        fontSize.preload([ [ 0x20, 0x7E ], [ 0xA0, 0xFF ] ], (err, count) => {
+            if (err) {
+                console.log('preload error: ' + err.message);
+                return;
+            }
+
+            glyphs += count;
+            open--;
+
+            if (open === 0) {
+                console.log('cache: ' + cacheDir);
+                console.log('sizes: ' + sizes.length + ', glyphs: ' + glyphs + ', time: ' + (Date.now() - startTime) + ' ms');
+
+                //Note: cache is saved on exit
+            }
+        });
+    });
+}
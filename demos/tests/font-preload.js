@@ -0,0 +1,54 @@
+'use strict';
+
+/*
+ * Preloads glyphs before a text is shown.
+ *
+ * Compare the atlas upload bytes of the first frames (see renderer stats).
+ */
+
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //root
+    const root = this.createGroup();
+
+    this.setRoot(root);
+
+    amino.fonts.getFont({ size: 40 }, (err, fontSize) => {
+        if (err) {
+            console.log('could not load font: ' + err.message);
+            return;
+        }
+
+        const startTime = Date.now();
+
+        //Latin-1 and a few words
+        fontSize.preload([ [ 0x20, 0xFF ], 'Grüße ÀÉÎÕÜ' ], (err, count) => {
+            if (err) {
+                console.log('preload error: ' + err.message);
+                return;
+            }
+
+            console.log('preloaded ' + count + ' glyphs in ' + (Date.now() - startTime) + ' ms');
+
+            //show text
+            const text = this.createText().text('Größenwahn à la française').fontSize(40).x(20).y(100).fill('#FFFFFF');
+
+            root.add(text);
+        });
+    });
+
+    //stats
+    setInterval(() => {
+        const stats = gfx.getStats();
+
+        console.log('stats: ' + JSON.stringify(stats.renderer) + ' ' + JSON.stringify(stats.fonts));
+    }, 1000);
+});
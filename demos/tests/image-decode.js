@@ -0,0 +1,63 @@
+'use strict';
+
+const amino = require('../../main.js');
+const path = require('path');
+
+/*
+ * Decode images at full and display size (JPEG DCT scaling, PNG downsampling).
+ *
+ * Optional argument: decoding memory budget in MB.
+ */
+
+if (process.argv.length > 2) {
+    amino.AminoImage.setDecodeBudget(parseFloat(process.argv[2]) * 1024 * 1024);
+}
+
+const files = [
+    '../slideshow/images/DSC_0041.jpg',
+    '../slideshow/images/iTermScreenSnapz001.png'
+];
+
+const options = [
+    {},
+    { maxWidth: 300, maxHeight: 200 },
+    { maxWidth: 300, maxHeight: 200, fit: 'cover' },
+    { scale: 0.25 }
+];
+
+/**
+ * Load all combinations one after the other.
+ */
+function next(i) {
+    if (i >= files.length * options.length) {
+        return;
+    }
+
+    const file = files[Math.floor(i / options.length)];
+    const opts = options[i % options.length];
+    const img = new amino.AminoImage();
+    const startTime = process.hrtime();
+
+    img.maxWidth = opts.maxWidth;
+    img.maxHeight = opts.maxHeight;
+    img.scale = opts.scale;
+    img.fit = opts.fit;
+
+    img.onload = function (err) {
+        if (err) {
+            console.log('could not load image: ' + err.message);
+            return;
+        }
+
+        const diff = process.hrtime(startTime);
+        const ms = diff[0] * 1000 + diff[1] / 1000000;
+
+        console.log(path.basename(file) + ' ' + JSON.stringify(opts) + ': ' + this.w + 'x' + this.h + ' (' + (this.buffer.length / 1024).toFixed(0) + ' KB, ' + ms.toFixed(1) + ' ms)');
+
+        next(i + 1);
+    };
+
+    img.src = path.join(__dirname, file);
+}
+
+next(0);
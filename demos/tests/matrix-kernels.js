@@ -0,0 +1,15 @@
+'use strict';
+
+/*
+ * Matrix kernel test.
+ *
+ * Compares the SIMD matrix kernels (NEON) with the scalar reference on random input and times chained mul_matrix()
+ * calls. Prints the active kernels and exits with 1 if a result differs.
+ */
+
+const amino = require('../../main.js');
+
+if (!amino.AminoGfx.checkMatrixPerformance()) {
+    console.log('matrix kernels: failed');
+    process.exit(1);
+}
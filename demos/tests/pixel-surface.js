@@ -0,0 +1,77 @@
+'use strict';
+
+/*
+ * Pixel surface benchmark.
+ *
+ * Plots a scrolling sine wave into a PixelView: every 16 ms a new column is drawn and committed (one dirty rectangle).
+ * Reports the JS time per update, the slowest frame and the runtime stats.
+ *
+ * Arguments: plot width (default: 1000), plot height (default: 500)
+ */
+
+const amino = require('../../main.js');
+
+const pw = process.argv.length > 2 ? parseInt(process.argv[2]) : 1000;
+const ph = process.argv.length > 3 ? parseInt(process.argv[3]) : 500;
+const duration = 5000;
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const pv = this.createPixelView().pw(pw).ph(ph).w(this.w()).h(this.h()).size('stretch');
+
+    root.add(pv);
+    this.setRoot(root);
+
+    //plot
+    let col = 0;
+    let updates = 0;
+    let jsTime = 0;
+    let maxCycle = 0;
+
+    const timer = setInterval(() => {
+        const startTime = process.hrtime();
+        const x = col % pw;
+        const y = Math.round((Math.sin(col / 50) + 1) / 2 * (ph - 1));
+
+        for (let i = 0; i < ph; i++) {
+            if (i == y) {
+                pv.setPixel(x, i, 255, 255, 255, 255);
+            } else {
+                pv.setPixel(x, i, 0, 0, 64, 255);
+            }
+        }
+
+        pv.updateTexture();
+
+        const diff = process.hrtime(startTime);
+
+        jsTime += diff[0] * 1000 + diff[1] / 1000000;
+        updates++;
+        col++;
+
+        const fps = gfx.getStats().fps;
+
+        if (fps) {
+            maxCycle = Math.max(maxCycle, fps.max);
+        }
+    }, 16);
+
+    //results
+    setTimeout(() => {
+        clearInterval(timer);
+
+        console.log('surface: ' + pw + 'x' + ph);
+        console.log('updates: ' + updates + ' (' + (jsTime / updates).toFixed(3) + ' ms/update)');
+        console.log('slowest frame: ' + maxCycle.toFixed(1) + ' ms');
+        console.log('stats: ' + JSON.stringify(gfx.getStats()));
+
+        gfx.destroy();
+    }, duration);
+});
@@ -0,0 +1,51 @@
+'use strict';
+
+/*
+ * Renders many small rects in a single group.
+ *
+ * Consecutive rects are batched (see renderer stats).
+ */
+
+const count = process.argv.length > 2 ? parseInt(process.argv[2]) : 1000;
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //root
+    const root = this.createGroup();
+
+    this.setRoot(root);
+
+    //rects
+    const w = this.w();
+    const h = this.h();
+
+    for (let i = 0; i < count; i++) {
+        const rect = this.createRect().w(10).h(10).x(Math.random() * w).y(Math.random() * h).fill('#0000FF');
+
+        //rotate a few
+        if (i % 10 == 0) {
+            rect.rz(45);
+        }
+
+        //semi-transparent
+        if (i % 7 == 0) {
+            rect.opacity(0.5);
+        }
+
+        root.add(rect);
+    }
+
+    console.log('rects: ' + count);
+
+    //stats
+    setInterval(() => {
+        console.log('stats: ' + JSON.stringify(gfx.getStats().renderer));
+    }, 1000);
+});
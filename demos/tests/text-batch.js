@@ -0,0 +1,52 @@
+'use strict';
+
+/*
+ * Renders many texts in a single group.
+ *
+ * Consecutive texts using the same atlas page are batched (see renderer stats).
+ */
+
+const count = process.argv.length > 2 ? parseInt(process.argv[2]) : 500;
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //root
+    const root = this.createGroup();
+
+    this.setRoot(root);
+
+    //texts
+    const w = this.w();
+    const h = this.h();
+    const colors = [ '#FFFFFF', '#FF0000', '#00FF00', '#FFFF00' ];
+
+    for (let i = 0; i < count; i++) {
+        const text = this.createText().x(Math.random() * w).y(Math.random() * h).fontSize(14).text('Label ' + i).fill(colors[i % colors.length]);
+
+        //rotate a few
+        if (i % 10 == 0) {
+            text.rz(30);
+        }
+
+        //semi-transparent
+        if (i % 7 == 0) {
+            text.opacity(0.5);
+        }
+
+        root.add(text);
+    }
+
+    console.log('texts: ' + count);
+
+    //stats
+    setInterval(() => {
+        console.log('stats: ' + JSON.stringify(gfx.getStats().renderer));
+    }, 1000);
+});
@@ -0,0 +1,213 @@
+'use strict';
+
+/*
+ * Text layout benchmark.
+ *
+ * Measures 10k Latin strings twice: first run loads the glyphs, second run only uses glyph and kerning lookups.
+ * Then wraps all strings and lays out wrapped text nodes (layout thread and atlas updates) until all layouts were applied.
+ *
+ * Half of the strings are CJK if a CJK font file is passed (e.g. NotoSansCJK-Regular.ttc), the default font has no CJK
+ * glyphs.
+ *
+ * Arguments: string count (default: 10000), text node count (default: 1000), CJK font file (optional)
+ */
+
+const path = require('path');
+const count = process.argv.length > 2 ? parseInt(process.argv[2]) : 10000;
+const nodeCount = process.argv.length > 3 ? parseInt(process.argv[3]) : 1000;
+const cjkFile = process.argv.length > 4 ? process.argv[4] : null;
+const wrapWidth = 300;
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+if (cjkFile) {
+    amino.fonts.registerFont({
+        name: 'cjk',
+        path: path.dirname(path.resolve(cjkFile)),
+        weights: {
+            400: {
+                normal: path.basename(cjkFile)
+            }
+        }
+    });
+} else {
+    console.log('warning: no CJK font file passed, using Latin strings only');
+}
+
+/**
+ * Create a random string.
+ */
+function createString(i) {
+    const latin = 'AVATAR To Wa Yo fj The quick brown fox jumps over the lazy dog. ';
+    const len = 20 + i % 40;
+    const cjk = cjkFile && i % 2 == 0;
+    let str = '';
+
+    for (let j = 0; j < len; j++) {
+        if (cjk) {
+            //CJK (3000 codepoints)
+            str += String.fromCharCode(0x4E00 + Math.floor(Math.random() * 3000));
+        } else {
+            str += latin.charAt(Math.floor(Math.random() * latin.length));
+        }
+    }
+
+    return {
+        str: str,
+        cjk: cjk
+    };
+}
+
+/**
+ * Load the Latin and CJK fonts.
+ */
+function loadFonts(callback) {
+    amino.fonts.getFont(null, (err, latin) => {
+        if (err) {
+            callback(err);
+            return;
+        }
+
+        if (!cjkFile) {
+            callback(null, { latin: latin, cjk: null });
+            return;
+        }
+
+        amino.fonts.getFont({ name: 'cjk' }, (err, cjk) => {
+            if (err) {
+                callback(err);
+                return;
+            }
+
+            callback(null, { latin: latin, cjk: cjk });
+        });
+    });
+}
+
+/**
+ * Measure all strings.
+ */
+function measure(fonts, strings) {
+    const startTime = process.hrtime();
+    let total = 0;
+
+    for (const item of strings) {
+        const fontSize = item.cjk ? fonts.cjk : fonts.latin;
+
+        fontSize.calcTextWidth(item.str, (err, width) => {
+            total += width;
+        });
+    }
+
+    const diff = process.hrtime(startTime);
+
+    return {
+        ms: diff[0] * 1000 + diff[1] / 1000000,
+        width: total
+    };
+}
+
+/**
+ * Wrap all strings.
+ */
+function wrap(fonts, strings) {
+    const startTime = process.hrtime();
+    let lines = 0;
+
+    for (const item of strings) {
+        const fontSize = item.cjk ? fonts.cjk : fonts.latin;
+
+        fontSize.wrapText(item.str, wrapWidth, (err, res) => {
+            lines += res.length;
+        });
+    }
+
+    const diff = process.hrtime(startTime);
+
+    return {
+        ms: diff[0] * 1000 + diff[1] / 1000000,
+        lines: lines
+    };
+}
+
+/**
+ * Create wrapped text nodes and wait until all layouts were applied.
+ */
+function layout(strings, callback) {
+    const root = gfx.createGroup();
+    const startTime = process.hrtime();
+    let queued = false;
+
+    for (let i = 0; i < nodeCount; i++) {
+        const item = strings[i % strings.length];
+        const text = gfx.createText().text(item.str).w(wrapWidth).wrap('word');
+
+        if (item.cjk) {
+            text.fontName('cjk');
+        }
+
+        text.x(i % 4 * wrapWidth).y(Math.floor(i / 4) % 20 * 30);
+        root.add(text);
+    }
+
+    gfx.setRoot(root);
+
+    //Note: layouts are queued on the next frame and applied one frame after the layout thread finished
+    const timer = setInterval(() => {
+        const pending = gfx.getStats().textLayouts;
+
+        if (pending > 0) {
+            queued = true;
+            return;
+        }
+
+        if (!queued) {
+            return;
+        }
+
+        clearInterval(timer);
+
+        const diff = process.hrtime(startTime);
+
+        callback(diff[0] * 1000 + diff[1] / 1000000);
+    }, 2);
+}
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //strings
+    const strings = [];
+
+    for (let i = 0; i < count; i++) {
+        strings.push(createString(i));
+    }
+
+    //default font (and CJK font)
+    loadFonts((err, fonts) => {
+        if (err) {
+            console.log('could not load font: ' + err.message);
+            return;
+        }
+
+        const cold = measure(fonts, strings);
+        const warm = measure(fonts, strings);
+        const wrapped = wrap(fonts, strings);
+
+        console.log('strings: ' + count + (cjkFile ? ' (Latin and CJK)' : ' (Latin)'));
+        console.log('cold: ' + cold.ms.toFixed(1) + ' ms');
+        console.log('warm: ' + warm.ms.toFixed(1) + ' ms (' + (warm.ms * 1000 / count).toFixed(2) + ' us/string)');
+        console.log('wrapText: ' + wrapped.ms.toFixed(1) + ' ms (' + (wrapped.ms * 1000 / count).toFixed(2) + ' us/string, ' + wrapped.lines + ' lines)');
+
+        layout(strings, ms => {
+            console.log('text nodes: ' + nodeCount + ' (' + ms.toFixed(1) + ' ms until laid out)');
+            console.log('fonts: ' + JSON.stringify(gfx.getStats().fonts));
+
+            gfx.destroy();
+        });
+    });
+});
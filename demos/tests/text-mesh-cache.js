@@ -0,0 +1,51 @@
+'use strict';
+
+/*
+ * Shared text meshes.
+ *
+ * Creates a grid of labels with repeated content (units and prices). Identical texts share one vertex buffer.
+ */
+
+const count = process.argv.length > 2 ? parseInt(process.argv[2]) : 1000;
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //labels
+    const labels = [ 'kg', 'CHF', '9.90', '12.50', 'Price', 'Total', 'pcs' ];
+    const texts = [];
+
+    for (let i = 0; i < count; i++) {
+        const t = this.createText().x(10 + (i % 20) * 60).y(20 + Math.floor(i / 20) * 14).fontSize(12).text(labels[i % labels.length]);
+
+        texts.push(t);
+        g.add(t);
+    }
+
+    //change some texts
+    setInterval(() => {
+        for (let i = 0; i < 50; i++) {
+            const t = texts[Math.floor(Math.random() * texts.length)];
+
+            t.text(labels[Math.floor(Math.random() * labels.length)]);
+        }
+    }, 500);
+
+    //stats
+    setInterval(() => {
+        console.log('text meshes: ' + JSON.stringify(gfx.getStats().textMeshes));
+    }, 2000);
+});
@@ -0,0 +1,60 @@
+'use strict';
+
+/*
+ * Signed distance field text.
+ *
+ * Animates the font size, scale and rotation of SDF text (glyphs are rasterized once at the base size). The upper text
+ * uses the regular font (new glyphs for each size) for comparison.
+ */
+
+const amino = require('../../main.js');
+
+//SDF variant of the default font
+const source = amino.fonts.fonts.source;
+
+amino.fonts.registerFont({
+    name: 'source-sdf',
+    weights: source.weights,
+    sdf: true
+});
+
+const gfx = new amino.AminoGfx();
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    this.fill('#000000');
+
+    //create group
+    const g = this.createGroup();
+
+    this.setRoot(g);
+
+    //regular font (font size animation)
+    const t1 = this.createText().x(20).y(100).text('Regular Text').fontSize(12);
+
+    t1.fontSize.anim().from(12).to(120).dur(4000).autoreverse(true).loop(-1).start();
+    g.add(t1);
+
+    //SDF font (font size animation)
+    const t2 = this.createText().x(20).y(300).text('Distance Field').fontName('source-sdf').fontSize(12);
+
+    t2.fontSize.anim().from(12).to(120).dur(4000).autoreverse(true).loop(-1).start();
+    g.add(t2);
+
+    //SDF font (scale & rotation)
+    const t3 = this.createText().x(400).y(500).text('Zoom & Rotate').fontName('source-sdf').fontSize(24);
+
+    t3.sx.anim().from(0.5).to(6).dur(3000).autoreverse(true).loop(-1).start();
+    t3.sy.anim().from(0.5).to(6).dur(3000).autoreverse(true).loop(-1).start();
+    t3.rz.anim().from(0).to(360).dur(8000).loop(-1).start();
+    g.add(t3);
+
+    //stats
+    setInterval(() => {
+        console.log('fonts: ' + JSON.stringify(gfx.getStats().fonts));
+    }, 2000);
+});
@@ -0,0 +1,138 @@
+'use strict';
+
+/*
+ * Line breaking benchmark.
+ *
+ * Wraps a 10 KB Latin paragraph at 100 widths. The first call shapes the text (glyphs, kerning and break opportunities),
+ * all further widths only re-run the linear line breaking pass.
+ *
+ * A CJK paragraph is wrapped too if a CJK font file is passed (e.g. NotoSansCJK-Regular.ttc), the default font has no
+ * CJK glyphs.
+ *
+ * Arguments: width count (default: 100), CJK font file (optional)
+ */
+
+const path = require('path');
+const widths = process.argv.length > 2 ? parseInt(process.argv[2]) : 100;
+const cjkFile = process.argv.length > 3 ? process.argv[3] : null;
+const amino = require('../../main.js');
+
+const gfx = new amino.AminoGfx();
+
+if (cjkFile) {
+    amino.fonts.registerFont({
+        name: 'cjk',
+        path: path.dirname(path.resolve(cjkFile)),
+        weights: {
+            400: {
+                normal: path.basename(cjkFile)
+            }
+        }
+    });
+} else {
+    console.log('warning: no CJK font file passed, wrapping Latin text only');
+}
+
+/**
+ * Create a paragraph of about 10 KB (UTF-8).
+ */
+function createParagraph(cjk) {
+    const words = [ 'AVATAR', 'To', 'Wa', 'Yo', 'fj', 'The', 'quick', 'brown', 'fox', 'jumps', 'over', 'the', 'lazy', 'dog.', '(line-breaking),' ];
+    let str = '';
+
+    while (Buffer.byteLength(str) < 10240) {
+        if (cjk) {
+            //CJK (3000 codepoints, sentence punctuation)
+            str += String.fromCharCode(0x4E00 + Math.floor(Math.random() * 3000));
+
+            if (Math.random() < 0.05) {
+                str += '。';
+            }
+        } else {
+            str += words[Math.floor(Math.random() * words.length)] + ' ';
+        }
+    }
+
+    return str;
+}
+
+/**
+ * Wrap a paragraph at all widths.
+ */
+function wrap(fontSize, str) {
+    let lines = 0;
+
+    //first call (shaping)
+    let startTime = process.hrtime();
+
+    fontSize.wrapText(str, 1000, (err, res) => {
+        lines += res.length;
+    });
+
+    let diff = process.hrtime(startTime);
+    const first = diff[0] * 1000 + diff[1] / 1000000;
+
+    //resize
+    startTime = process.hrtime();
+
+    for (let i = 0; i < widths; i++) {
+        fontSize.wrapText(str, 200 + i * 10, (err, res) => {
+            lines += res.length;
+        });
+    }
+
+    diff = process.hrtime(startTime);
+
+    const ms = diff[0] * 1000 + diff[1] / 1000000;
+
+    return {
+        first: first,
+        ms: ms,
+        lines: lines
+    };
+}
+
+/**
+ * Wrap a Latin or CJK paragraph and print the results.
+ */
+function run(fontSize, cjk) {
+    const str = createParagraph(cjk);
+    const res = wrap(fontSize, str);
+
+    console.log((cjk ? 'CJK' : 'Latin') + ': ' + str.length + ' characters');
+    console.log(' first: ' + res.first.toFixed(1) + ' ms');
+    console.log(' resize: ' + res.ms.toFixed(1) + ' ms (' + (res.ms / widths).toFixed(3) + ' ms/width, ' + res.lines + ' lines)');
+}
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    //default font
+    amino.fonts.getFont(null, (err, fontSize) => {
+        if (err) {
+            console.log('could not load font: ' + err.message);
+            return;
+        }
+
+        run(fontSize, false);
+
+        if (!cjkFile) {
+            gfx.destroy();
+            return;
+        }
+
+        //CJK font
+        amino.fonts.getFont({ name: 'cjk' }, (err, fontSize) => {
+            if (err) {
+                console.log('could not load CJK font: ' + err.message);
+            } else {
+                run(fontSize, true);
+            }
+
+            gfx.destroy();
+        });
+    });
+});
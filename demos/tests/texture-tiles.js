@@ -0,0 +1,154 @@
+'use strict';
+
+/*
+ * Large image benchmark.
+ *
+ * Loads a 4K image and reports the slowest frame while the texture is uploaded.
+ *
+ * Arguments: tile size (default: 1024, 0: maximum texture size)
+ *
+ * Compare with a tile size above 3840 (single upload) or 0 (single upload if supported by the GPU).
+ */
+
+const zlib = require('zlib');
+const amino = require('../../main.js');
+
+const tileSize = process.argv.length > 2 ? parseInt(process.argv[2]) : 1024;
+const imgW = 3840;
+const imgH = 2160;
+
+const gfx = new amino.AminoGfx({
+    textureTileSize: tileSize
+});
+
+/**
+ * CRC32 (PNG chunks).
+ */
+const crcTable = [];
+
+for (let n = 0; n < 256; n++) {
+    let c = n;
+
+    for (let k = 0; k < 8; k++) {
+        c = (c & 1) ? (0xEDB88320 ^ (c >>> 1)) : (c >>> 1);
+    }
+
+    crcTable[n] = c >>> 0;
+}
+
+function crc32(buf) {
+    let c = 0xFFFFFFFF;
+
+    for (let i = 0; i < buf.length; i++) {
+        c = crcTable[(c ^ buf[i]) & 0xFF] ^ (c >>> 8);
+    }
+
+    return (c ^ 0xFFFFFFFF) >>> 0;
+}
+
+function chunk(type, data) {
+    const len = Buffer.alloc(4);
+    const typeData = Buffer.concat([ Buffer.from(type, 'ascii'), data ]);
+    const crc = Buffer.alloc(4);
+
+    len.writeUInt32BE(data.length, 0);
+    crc.writeUInt32BE(crc32(typeData), 0);
+
+    return Buffer.concat([ len, typeData, crc ]);
+}
+
+/**
+ * Create a 4K RGB gradient PNG.
+ */
+function createPng() {
+    const rowLen = imgW * 3 + 1;
+    const raw = Buffer.alloc(rowLen * imgH);
+
+    for (let y = 0; y < imgH; y++) {
+        const row = y * rowLen;
+
+        raw[row] = 0; //no filter
+
+        for (let x = 0; x < imgW; x++) {
+            const pos = row + 1 + x * 3;
+
+            raw[pos] = x * 255 / imgW;
+            raw[pos + 1] = y * 255 / imgH;
+            raw[pos + 2] = ((x >> 6) + (y >> 6)) % 2 ? 255 : 0;
+        }
+    }
+
+    const ihdr = Buffer.alloc(13);
+
+    ihdr.writeUInt32BE(imgW, 0);
+    ihdr.writeUInt32BE(imgH, 4);
+    ihdr[8] = 8; //bit depth
+    ihdr[9] = 2; //RGB
+
+    return Buffer.concat([
+        Buffer.from([ 137, 80, 78, 71, 13, 10, 26, 10 ]),
+        chunk('IHDR', ihdr),
+        chunk('IDAT', zlib.deflateSync(raw)),
+        chunk('IEND', Buffer.alloc(0))
+    ]);
+}
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const iv = this.createImageView().w(this.w()).h(this.h()).size('stretch');
+
+    root.add(iv);
+    this.setRoot(root);
+
+    console.log('max texture size: ' + this.runtime.maxTextureSize);
+    console.log('tile size: ' + (tileSize || 'none'));
+
+    //decode
+    const img = new amino.AminoImage();
+
+    img.onload = err => {
+        if (err) {
+            console.log('could not load image: ' + err.message);
+            return;
+        }
+
+        //upload
+        const startTime = Date.now();
+        let maxCycle = 0;
+        let loadTime = 0;
+
+        const timer = setInterval(() => {
+            const fps = gfx.getStats().fps;
+
+            if (fps) {
+                maxCycle = Math.max(maxCycle, fps.max);
+            }
+        }, 250);
+
+        iv.image.watch(texture => {
+            if (texture) {
+                loadTime = Date.now() - startTime;
+            }
+        });
+
+        iv.src(img);
+
+        //results
+        setTimeout(() => {
+            clearInterval(timer);
+
+            console.log('texture loaded: ' + loadTime + ' ms');
+            console.log('slowest frame: ' + maxCycle.toFixed(1) + ' ms');
+            console.log('stats: ' + JSON.stringify(gfx.getStats()));
+
+            gfx.destroy();
+        }, 5000);
+    };
+
+    img.src = createPng();
+});
@@ -0,0 +1,124 @@
+'use strict';
+
+/*
+ * Texture upload benchmark.
+ *
+ * Uploads ten 1080p textures at once and reports the slowest frame, the callback order and the upload queue.
+ *
+ * Arguments: upload budget in KB per frame (default: 8192, 0: no limit), upload time in ms per frame (default: 4, 0: no limit)
+ *
+ * Compare with "0 0" (all textures uploaded in a single frame).
+ */
+
+const amino = require('../../main.js');
+
+const budgetKB = process.argv.length > 2 ? parseInt(process.argv[2]) : 8192;
+const budgetTime = process.argv.length > 3 ? parseFloat(process.argv[3]) : 4;
+const count = 10;
+const w = 1920;
+const h = 1080;
+
+const gfx = new amino.AminoGfx({
+    textureUploadBytes: budgetKB * 1024,
+    textureUploadTime: budgetTime
+});
+
+/**
+ * Create a RGBA pixel buffer.
+ */
+function createBuffer(i) {
+    const buf = Buffer.alloc(w * h * 4);
+
+    for (let y = 0; y < h; y++) {
+        for (let x = 0; x < w; x++) {
+            const pos = (y * w + x) * 4;
+
+            buf[pos] = x * 255 / w;
+            buf[pos + 1] = y * 255 / h;
+            buf[pos + 2] = i * 255 / count;
+            buf[pos + 3] = 255;
+        }
+    }
+
+    return buf;
+}
+
+gfx.start(function (err) {
+    if (err) {
+        console.log('Amino error: ' + err.message);
+        return;
+    }
+
+    const root = this.createGroup();
+    const cols = 4;
+    const cellW = this.w() / cols;
+    const cellH = this.h() / Math.ceil(count / cols);
+
+    this.setRoot(root);
+
+    console.log('budget: ' + (budgetKB ? budgetKB + ' KB' : 'none') + ', ' + (budgetTime ? budgetTime + ' ms' : 'none'));
+
+    //buffers
+    const buffers = [];
+
+    for (let i = 0; i < count; i++) {
+        buffers.push(createBuffer(i));
+    }
+
+    //upload all at once
+    const startTime = Date.now();
+    const order = [];
+    let maxCycle = 0;
+    let maxQueue = 0;
+    let loadTime = 0;
+
+    const timer = setInterval(() => {
+        const stats = gfx.getStats();
+
+        if (stats.fps) {
+            maxCycle = Math.max(maxCycle, stats.fps.max);
+        }
+
+        maxQueue = Math.max(maxQueue, stats.textureUploads.queued);
+    }, 50);
+
+    for (let i = 0; i < count; i++) {
+        const texture = this.createTexture();
+
+        texture.loadTextureFromBuffer({
+            buffer: buffers[i],
+            w: w,
+            h: h,
+            bpp: 4
+        }, err => {
+            if (err) {
+                console.log('could not create texture: ' + err.message);
+                return;
+            }
+
+            order.push(i);
+
+            if (order.length == count) {
+                loadTime = Date.now() - startTime;
+            }
+
+            const iv = this.createImageView().x(i % cols * cellW).y(Math.floor(i / cols) * cellH).w(cellW).h(cellH).size('stretch');
+
+            iv.image(texture);
+            root.add(iv);
+        });
+    }
+
+    //results
+    setTimeout(() => {
+        clearInterval(timer);
+
+        console.log('textures loaded: ' + loadTime + ' ms');
+        console.log('callback order: ' + order.join(', '));
+        console.log('slowest frame: ' + maxCycle.toFixed(1) + ' ms');
+        console.log('max. queued: ' + maxQueue);
+        console.log('stats: ' + JSON.stringify(gfx.getStats()));
+
+        gfx.destroy();
+    }, 5000);
+});
@@ -958,7 +958,10 @@ ImageView.prototype.init = function () {
 
         position: 'center center',
         size: 'resize',
-        repeat: 'no-repeat'
+        repeat: 'no-repeat',
+
+        //decoded image size ('full' or 'display')
+        decodeSize: 'full'
     });
 
     //actually load the image
@@ -1183,6 +1186,15 @@ function setSrc(src, prop, obj) {
 
     obj.tmpImage = img;
 
+    //limit decoded size (not possible if the view size depends on the image)
+    const sizeMode = obj.size ? obj.size() : 'resize';
+
+    if (obj.decodeSize && obj.decodeSize() === 'display' && sizeMode !== 'resize') {
+        img.maxWidth = obj.w();
+        img.maxHeight = obj.h();
+        img.fit = sizeMode === 'contain' ? 'contain' : 'cover';
+    }
+
     img.onload = err => {
         obj.tmpImage = null;
 
@@ -1287,25 +1299,62 @@ PixelView.prototype.init = function () {
 PixelView.prototype.initDone = function () {
     this.pw.watch(rebuildBuffer);
     this.ph.watch(rebuildBuffer);
+    this.bpp.watch(rebuildBuffer);
 
     const self = this;
 
     function rebuildBuffer() {
         const w = self.pw();
         const h = self.ph();
-        const len = w * h * 4;
+        const bpp = self.bpp();
 
-        if (!self.buf || self.buf.length != len) {
-            self.buf = new Buffer(len);
+        if (self.buf && self.surfaceW === w && self.surfaceH === h && self.surfaceBpp === bpp) {
+            return;
         }
 
-        const c1 = [0, 0, 0];
-        const c2 = [255, 255, 255];
+        //surface (double buffered)
+        const texture = self.amino.createTexture();
+
+        self.buffers = texture.createSurface(w, h, bpp, err => {
+            if (err) {
+                if (DEBUG_ERRORS) {
+                    console.log('Could not create texture!');
+                }
+
+                return;
+            }
+        });
+
+        texture.addEventListener('surface', () => {
+            //commit changes made during the last upload (before JS writes to the next buffer)
+            if (self.texture === texture && self.commitPending) {
+                if (self.dirty) {
+                    self.updateTexture();
+                } else {
+                    self.commitTexture([]);
+                }
+            }
+        });
+
+        const oldTexture = self.texture;
+
+        self.texture = texture;
+        self.surfaceW = w;
+        self.surfaceH = h;
+        self.surfaceBpp = bpp;
+        self.bufIndex = 0;
+        self.buf = self.buffers[0];
+        self.commitPending = false;
+        self.dirty = null;
+
+        //pattern
+        const c1 = [0, 0, 0, 255];
+        const c2 = [255, 255, 255, 255];
         const buf = self.buf;
 
         for (let x = 0; x < w; x++) {
             for (let y = 0; y < h; y++) {
-                const i = (x + y * w) * 4;
+                const i = (x + y * w) * bpp;
                 let c;
 
                 if (x % 3 == 0) {
@@ -1314,57 +1363,133 @@ PixelView.prototype.initDone = function () {
                     c = c2;
                 }
 
-                buf[i + 0] = c[0];
-                buf[i + 1] = c[1];
-                buf[i + 2] = c[2];
-                buf[i + 3] = 255;
+                for (let j = 0; j < bpp; j++) {
+                    buf[i + j] = c[j];
+                }
+
+                if (bpp == 2) {
+                    buf[i + 1] = 255;
+                }
             }
         }
 
+        self.image(texture);
         self.updateTexture();
-    };
 
-    //texture
-    this.texture = this.amino.createTexture();
-    this.image(this.texture);
+        //free the previous surface
+        if (oldTexture) {
+            oldTexture.destroy();
+        }
+    };
 
     rebuildBuffer();
 };
 
+/**
+ * Mark a region as modified.
+ *
+ * Note: setPixel() and setPixeli32() mark their pixels, direct writes to buf have to be marked.
+ */
+PixelView.prototype.markDirty = function (x, y, w, h) {
+    const dirty = this.dirty;
+
+    if (!dirty) {
+        this.dirty = [ x, y, x + w, y + h ];
+        return;
+    }
+
+    if (x < dirty[0]) {
+        dirty[0] = x;
+    }
+
+    if (y < dirty[1]) {
+        dirty[1] = y;
+    }
+
+    if (x + w > dirty[2]) {
+        dirty[2] = x + w;
+    }
+
+    if (y + h > dirty[3]) {
+        dirty[3] = y + h;
+    }
+};
+
+/**
+ * Upload the modified pixels.
+ *
+ * Uploads the whole buffer if no region was marked.
+ */
 PixelView.prototype.updateTexture = function () {
-    this.texture.loadTextureFromBuffer({
-        buffer: this.buf,
-        w: this.pw(),
-        h: this.ph(),
-        bpp: this.bpp()
-    }, err => {
-        if (err) {
-            if (DEBUG_ERRORS) {
-                console.log('Could not create texture!');
-            }
+    const dirty = this.dirty;
 
-            return;
-        }
-    });
+    this.dirty = null;
+
+    if (dirty) {
+        this.commitTexture([ dirty[0], dirty[1], dirty[2] - dirty[0], dirty[3] - dirty[1] ]);
+    } else {
+        this.commitTexture();
+    }
 };
 
+/**
+ * Commit the dirty rectangles and switch to the next buffer.
+ */
+PixelView.prototype.commitTexture = function (rects) {
+    const index = this.texture.commitSurface(rects);
+
+    if (index < 0) {
+        //previous commit still uploading (rectangles are kept)
+        this.commitPending = true;
+        return;
+    }
+
+    this.commitPending = false;
+
+    if (index !== this.bufIndex) {
+        this.bufIndex = index;
+        this.buf = this.buffers[index];
+    }
+};
+
+/**
+ * Set a pixel.
+ *
+ * Note: luminance formats (bpp 1 and 2) use r as luminance.
+ */
 PixelView.prototype.setPixel = function (x, y, r, g, b, a) {
-    const w = this.pw();
-    const i = (x + y * w) * 4;
+    const w = this.surfaceW;
+    const bpp = this.surfaceBpp;
+    const i = (x + y * w) * bpp;
 
     const buf = this.buf;
 
     buf[i + 0] = r;
-    buf[i + 1] = g;
-    buf[i + 2] = b;
-    buf[i + 3] = a;
+
+    if (bpp == 2) {
+        buf[i + 1] = a;
+    } else if (bpp > 2) {
+        buf[i + 1] = g;
+        buf[i + 2] = b;
+
+        if (bpp == 4) {
+            buf[i + 3] = a;
+        }
+    }
+
+    this.markDirty(x, y, 1, 1);
 };
 
+/**
+ * Set a RGBA pixel (bpp 4).
+ */
 PixelView.prototype.setPixeli32 = function (x, y, int) {
-    const w = this.pw();
-    const i = (x + y * w) * 4;
+    const w = this.surfaceW;
+    const i = (x + y * w) * this.surfaceBpp;
 
     this.buf.writeUInt32BE(int, i);
+
+    this.markDirty(x, y, 1, 1);
 };
 
 //
@@ -1610,6 +1735,21 @@ Circle.prototype.contains = function (pt) {
 
 const AminoImage = native.AminoImage;
 
+/**
+ * Get decoding options (maxWidth, maxHeight, scale and fit properties).
+ *
+ * JPEG images are scaled while decoding (1/2, 1/4, 1/8), other formats are downsampled. The decoded image is at most
+ * about twice the requested size.
+ */
+function getDecodeOptions(img) {
+    return {
+        maxWidth: img.maxWidth || 0,
+        maxHeight: img.maxHeight || 0,
+        scale: img.scale || 0,
+        fit: img.fit || 'contain'
+    };
+}
+
 /**
  * src property.
  */
@@ -1648,7 +1788,7 @@ Object.defineProperty(AminoImage.prototype, 'src', {
                     //console.log('image: buffer=' + Buffer.isBuffer(buffer) + ' len=' + buffer.length);
 
                     //native call
-                    this.loadImage(buffer, this.onload);
+                    this.loadImage(buffer, getDecodeOptions(this), this.onload);
                 });
 
                 return;
@@ -1666,7 +1806,7 @@ Object.defineProperty(AminoImage.prototype, 'src', {
                 }
 
                 //get image
-                this.loadImage(data, (err, img) => {
+                this.loadImage(data, getDecodeOptions(this), (err, img) => {
                     //call onload
                     if (this.onload) {
                         this.onload(err, img);
@@ -1687,7 +1827,7 @@ Object.defineProperty(AminoImage.prototype, 'src', {
         }
 
         //native call
-        this.loadImage(src, this.onload);
+        this.loadImage(src, getDecodeOptions(this), this.onload);
     }
 });
 
@@ -1720,6 +1860,8 @@ const AminoFonts = native.AminoFonts;
 AminoFonts.prototype.init = function () {
     this.fonts = {};
     this.cache = {};
+    this.maxAtlasPages = null;
+    this.cacheDir = null;
 
     //default fonts
     this.registerFont({
@@ -1784,6 +1926,9 @@ AminoFonts.prototype.init = function () {
 
 /**
  * Register a font.
+ *
+ * Optional preload: warm-up charset of all sizes (string or array of strings and [from, to] codepoint ranges).
+ * Optional sdf: render signed distance field glyphs (rasterized once, shared by all sizes, smooth scaling and rotation).
  */
 AminoFonts.prototype.registerFont = function (font) {
     //check existing font (immutable)
@@ -1904,6 +2049,8 @@ AminoFonts.prototype.getFont = function (descr, callback) {
 
     //load file
     const file = path.join(dir, styleDesc);
+    const preload = font.preload;
+    const sdf = !!font.sdf;
 
     const promise = new Promise((resolve, reject) => {
         fs.readFile(file, (err, data) => {
@@ -1919,7 +2066,11 @@ AminoFonts.prototype.getFont = function (descr, callback) {
 
                 name: name,
                 weight: weight,
-                style: style
+                style: style,
+
+                maxAtlasPages: this.maxAtlasPages,
+                cacheDir: this.cacheDir,
+                sdf: sdf
             });
 
             resolve(font);
@@ -1931,6 +2082,9 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     promise.then(font => {
         this.cache[key] = font;
 
+        //warm-up charset (used by all sizes)
+        font.preloadChars = preload;
+
         font.getSize(size, callback);
     }, err => {
         callback(err);
@@ -1939,6 +2093,54 @@ AminoFonts.prototype.getFont = function (descr, callback) {
     return this;
 };
 
+/**
+ * Set the glyph atlas page budget (512x512 pages per font, default: 4).
+ *
+ * Note: only used for fonts loaded afterwards.
+ */
+AminoFonts.prototype.setMaxAtlasPages = function (pages) {
+    this.maxAtlasPages = pages;
+
+    return this;
+};
+
+/**
+ * Set the glyph atlas cache directory (rendered glyphs are reused after a restart).
+ *
+ * Note: only used for fonts loaded afterwards. The cache is saved on exit.
+ */
+AminoFonts.prototype.setCacheDir = function (dir) {
+    if (dir && !this.cacheDir) {
+        process.on('exit', () => {
+            this.saveCache();
+        });
+    }
+
+    //create directory
+    if (dir && !fs.existsSync(dir)) {
+        fs.mkdirSync(dir);
+    }
+
+    this.cacheDir = dir;
+
+    return this;
+};
+
+/**
+ * Save the glyph atlas cache of all loaded fonts.
+ */
+AminoFonts.prototype.saveCache = function () {
+    for (let key in this.cache) {
+        const font = this.cache[key];
+
+        if (font instanceof AminoFonts.Font) {
+            font._saveCache();
+        }
+    }
+
+    return this;
+};
+
 const fonts = new AminoFonts();
 
 exports.fonts = fonts;
@@ -1963,6 +2165,11 @@ AminoFont.prototype.getSize = function (size, callback) {
     if (!fontSize) {
         fontSize = new AminoFonts.FontSize(this, size);
         this.fontSizes[size] = fontSize;
+
+        //warm-up charset
+        if (this.preloadChars) {
+            fontSize.preload(this.preloadChars);
+        }
     }
 
     callback(null, fontSize);
@@ -1981,6 +2188,78 @@ AminoFontSize.prototype.calcTextWidth = function (text, callback) {
     callback(null, this._calcTextWidth(text));
 };
 
+/**
+ * Break text into lines (word wrapping, same rules as text nodes).
+ *
+ * Callback: (err, lines)
+ */
+AminoFontSize.prototype.wrapText = function (text, width, callback) {
+    callback(null, this._wrapText(text, width));
+};
+
+/**
+ * Load glyphs ahead of time (on a background thread).
+ *
+ * Charset: string or array of strings and [from, to] codepoint ranges.
+ *
+ * Callback: (err, count)
+ */
+AminoFontSize.prototype.preload = function (charset, callback) {
+    const items = Array.isArray(charset) ? charset : [ charset ];
+    let count = 0;
+    let open = items.length;
+    let error = null;
+
+    const done = (err, loaded) => {
+        if (err) {
+            error = err;
+        } else {
+            count += loaded;
+        }
+
+        open--;
+
+        if (open === 0 && callback) {
+            callback(error, count);
+        }
+    };
+
+    if (open === 0) {
+        if (callback) {
+            callback(null, 0);
+        }
+
+        return this;
+    }
+
+    for (const item of items) {
+        if (Array.isArray(item)) {
+            this.preloadRange(item[0], item[1], done);
+        } else {
+            this._preload(String(item), done);
+        }
+    }
+
+    return this;
+};
+
+/**
+ * Load the glyphs of a codepoint range ahead of time (on a background thread).
+ *
+ * Callback: (err, count)
+ */
+AminoFontSize.prototype.preloadRange = function (from, to, callback) {
+    try {
+        this._preloadRange(from, to, callback || (() => {}));
+    } catch (err) {
+        if (callback) {
+            callback(err);
+        }
+    }
+
+    return this;
+};
+
 //
 // AminoGfxTexture
 //
@@ -2268,6 +2547,10 @@ Anim.prototype.init = function () {
     this._delay = 0;
     this._autoreverse = false;
     this._timeFunc = 'cubicInOut';
+    this._bezier = null;
+    this._spring = null;
+    this._keyframes = null;
+    this._keyTimes = null;
     this._then_fun = null;
 
     this.started = false;
@@ -2362,7 +2645,9 @@ Anim.prototype.autoreverse = function(val) {
 };
 
 //Time function values.
-const timeFuncs = ['linear', 'cubicIn', 'cubicOut', 'cubicInOut'];
+const timeFuncs = ['linear', 'cubicIn', 'cubicOut', 'cubicInOut',
+    'bezier', 'elasticIn', 'elasticOut', 'elasticInOut',
+    'bounceIn', 'bounceOut', 'bounceInOut', 'spring'];
 
 /**
  * Time function.
@@ -2371,7 +2656,7 @@ Anim.prototype.timeFunc = function (value) {
     this.checkStarted();
 
     if (timeFuncs.indexOf(value) === -1) {
-        throw new Error('unknown time function: ' + val);
+        throw new Error('unknown time function: ' + value);
     }
 
     this._timeFunc = value;
@@ -2379,6 +2664,55 @@ Anim.prototype.timeFunc = function (value) {
     return this;
 };
 
+/**
+ * CSS-style cubic-bezier time function.
+ */
+Anim.prototype.bezier = function (x1, y1, x2, y2) {
+    this.checkStarted();
+
+    this._timeFunc = 'bezier';
+    this._bezier = [x1, y1, x2, y2];
+
+    return this;
+};
+
+/**
+ * Damped spring time function.
+ */
+Anim.prototype.spring = function (damping, frequency) {
+    this.checkStarted();
+
+    this._timeFunc = 'spring';
+    this._spring = [damping, frequency];
+
+    return this;
+};
+
+/**
+ * Keyframe values (replaces from and to). The time function is applied to each segment.
+ *
+ * @param values array of values.
+ * @param times optional ascending array of normalized times (default: evenly spaced).
+ */
+Anim.prototype.keyframes = function (values, times) {
+    this.checkStarted();
+
+    if (!Array.isArray(values) || values.length < 2) {
+        throw new Error('at least two keyframes needed');
+    }
+
+    if (times && times.length !== values.length) {
+        throw new Error('keyframe times do not match values');
+    }
+
+    this._keyframes = values;
+    this._keyTimes = times;
+    this._from = values[0];
+    this._to = values[values.length - 1];
+
+    return this;
+};
+
 /**
  * Internal: check started state.
  */
@@ -2426,6 +2760,10 @@ Anim.prototype.start = function (refTime) {
             count: this._loop,
             autoreverse: this._autoreverse,
             timeFunc: this._timeFunc,
+            bezier: this._bezier,
+            spring: this._spring,
+            keyframes: this._keyframes,
+            keyTimes: this._keyTimes,
             then: this._then_fun
         });
     }, this._delay);
@@ -0,0 +1,696 @@
+#include "animations.h"
+#include "base.h"
+
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+/**
+ * Move the last item to a position and shrink the vector.
+ */
+template<typename T> static inline void moveLast(std::vector<T> &v, size_t i) {
+    v[i] = v.back();
+    v.pop_back();
+}
+
+//
+// AminoAnimEngine
+//
+
+/**
+ * Constructor.
+ */
+AminoAnimEngine::AminoAnimEngine() {
+    //empty
+}
+
+/**
+ * Destructor.
+ */
+AminoAnimEngine::~AminoAnimEngine() {
+    //empty
+}
+
+/**
+ * Add a started animation.
+ */
+void AminoAnimEngine::add(AminoAnim *anim) {
+    assert(anim);
+    assert(anim->trackIndex == -1);
+
+    anim->trackIndex = anims.size();
+
+    from.push_back(anim->start);
+    to.push_back(anim->end);
+    duration.push_back(anim->duration);
+    invDuration.push_back(anim->duration > 0 ? 1.f / anim->duration : 0.f);
+    startTime.push_back(0);
+    count.push_back(anim->count);
+    reverse.push_back(0);
+    autoreverse.push_back(anim->autoreverse ? 1:0);
+    timeFunc.push_back(anim->timeFunc);
+    started.push_back(0);
+    curves.push_back(anim->curve);
+    anims.push_back(anim);
+
+    if (anim->curve) {
+        curveCount++;
+    }
+
+    pos.push_back(0);
+    value.push_back(anim->start);
+}
+
+/**
+ * Remove an animation.
+ */
+void AminoAnimEngine::remove(AminoAnim *anim) {
+    assert(anim);
+
+    if (anim->trackIndex < 0) {
+        return;
+    }
+
+    removeTrack(anim->trackIndex);
+}
+
+/**
+ * Remove all animations.
+ */
+void AminoAnimEngine::clear() {
+    size_t n = anims.size();
+
+    for (size_t i = 0; i < n; i++) {
+        anims[i]->trackIndex = -1;
+    }
+
+    from.clear();
+    to.clear();
+    duration.clear();
+    invDuration.clear();
+    startTime.clear();
+    count.clear();
+    reverse.clear();
+    autoreverse.clear();
+    timeFunc.clear();
+    started.clear();
+    curves.clear();
+    anims.clear();
+
+    curveCount = 0;
+
+    pos.clear();
+    value.clear();
+}
+
+/**
+ * Number of tracks.
+ */
+size_t AminoAnimEngine::size() {
+    return anims.size();
+}
+
+/**
+ * Remove a track (swap with last).
+ */
+void AminoAnimEngine::removeTrack(size_t i) {
+    assert(i < anims.size());
+
+    anims[i]->trackIndex = -1;
+
+    if (curves[i]) {
+        curveCount--;
+    }
+
+    moveLast(from, i);
+    moveLast(to, i);
+    moveLast(duration, i);
+    moveLast(invDuration, i);
+    moveLast(startTime, i);
+    moveLast(count, i);
+    moveLast(reverse, i);
+    moveLast(autoreverse, i);
+    moveLast(timeFunc, i);
+    moveLast(started, i);
+    moveLast(curves, i);
+    moveLast(anims, i);
+
+    moveLast(pos, i);
+    moveLast(value, i);
+
+    if (i < anims.size()) {
+        anims[i]->trackIndex = i;
+    }
+}
+
+/**
+ * End a track (applies the end value).
+ */
+void AminoAnimEngine::endTrack(size_t i) {
+    anims[i]->endAnimation();
+    removeTrack(i);
+}
+
+/**
+ * Toggle animation direction.
+ *
+ * Note: works only if autoreverse is enabled
+ */
+void AminoAnimEngine::toggle(size_t i) {
+    if (autoreverse[i]) {
+        reverse[i] = 1.f - reverse[i];
+    }
+}
+
+/**
+ * Handle first start.
+ *
+ * @return false if waiting or removed
+ */
+bool AminoAnimEngine::startTrack(size_t i, double currentTime) {
+    AminoAnim *anim = anims[i];
+
+    //check remaining loops
+    if (count[i] == 0 || duration[i] <= 0) {
+        endTrack(i);
+        return false;
+    }
+
+    double start = currentTime;
+
+    //sync with reference time
+    if (anim->hasRefTime) {
+        double diff = currentTime - anim->refTime;
+
+        if (diff < 0) {
+            //in future: wait
+            return false;
+        }
+
+        //check passed iterations
+        int cycles = diff / duration[i];
+
+        if (cycles > 0) {
+            //check end of animation
+            if (count[i] != AminoAnim::FOREVER) {
+                if (cycles >= count[i]) {
+                    //end reached
+                    endTrack(i);
+                    return false;
+                }
+
+                //reduce
+                count[i] -= cycles;
+            }
+
+            diff -= cycles * duration[i];
+
+            //check direction
+            if (cycles & 0x1) {
+                toggle(i);
+            }
+        }
+
+        //shift start time
+        start -= diff;
+    }
+
+    //adjust animation position
+    if (anim->hasZeroPos && anim->zeroPos > from[i] && anim->zeroPos <= to[i]) {
+        float p = (anim->zeroPos - from[i]) / (to[i] - from[i]);
+
+        //shift start time
+        start -= p * duration[i];
+    }
+
+    startTime[i] = start;
+    started[i] = 1;
+    pos[i] = (currentTime - start) * invDuration[i];
+
+    return true;
+}
+
+/**
+ * End of cycle reached.
+ *
+ * @return false if removed
+ */
+bool AminoAnimEngine::nextCycle(size_t i, double currentTime) {
+    double timePassed = currentTime - startTime[i];
+    float d = duration[i];
+    bool doToggle = false;
+
+    if (count[i] == AminoAnim::FOREVER) {
+        doToggle = true;
+    }
+
+    if (count[i] > 0) {
+        count[i]--;
+
+        if (count[i] > 0) {
+            doToggle = true;
+        } else {
+            endTrack(i);
+            return false;
+        }
+    }
+
+    if (doToggle) {
+        //next cycle
+
+        //calc exact time offset
+        double overTime = timePassed - d;
+
+        if (overTime > d) {
+            int times = overTime / d;
+
+            overTime -= times * d;
+
+            if (times & 0x1) {
+                doToggle = false;
+            }
+        }
+
+        startTime[i] = currentTime - overTime;
+        pos[i] = overTime * invDuration[i];
+
+        if (doToggle) {
+            toggle(i);
+        }
+    } else {
+        //end position
+        pos[i] = 1;
+    }
+
+    return true;
+}
+
+/**
+ * Next animation step.
+ */
+void AminoAnimEngine::update(double currentTime) {
+    size_t n = anims.size();
+
+    //validate time (should never happen if time is monotonic)
+    if (currentTime < lastTime) {
+        double shift = currentTime - lastTime;
+
+        for (size_t i = 0; i < n; i++) {
+            startTime[i] += shift;
+        }
+    }
+
+    lastTime = currentTime;
+
+    if (n == 0) {
+        return;
+    }
+
+    // 1) time to position
+    {
+        const double *pStart = startTime.data();
+        const float *pInv = invDuration.data();
+        float *pPos = pos.data();
+
+        for (size_t i = 0; i < n; i++) {
+            pPos[i] = (currentTime - pStart[i]) * pInv[i];
+        }
+    }
+
+    // 2) first start and end of cycle (backwards, tracks might get removed)
+    for (size_t i = n; i-- > 0;) {
+        if (!started[i] && !startTrack(i, currentTime)) {
+            continue;
+        }
+
+        if (pos[i] > 1.f) {
+            nextCycle(i, currentTime);
+        }
+    }
+
+    n = anims.size();
+
+    // 3) time function
+    {
+        const float *pPos = pos.data();
+        const float *pReverse = reverse.data();
+        const uint8_t *pTimeFunc = timeFunc.data();
+        const float *pFrom = from.data();
+        const float *pTo = to.data();
+        float *pValue = value.data();
+
+        for (size_t i = 0; i < n; i++) {
+            float t = pPos[i];
+
+            //direction
+            t += pReverse[i] * (1.f - 2.f * t);
+
+            //cubic curves (branch-free)
+            float u = 1.f - t;
+            float t3 = t * t * t;
+            float u3 = u * u * u;
+            float inOut = t < 0.5f ? 4.f * t3 : 1.f - 4.f * u3;
+            uint8_t tf = pTimeFunc[i];
+            float e = tf == AminoAnim::TF_CUBIC_IN ? t3 : t;
+
+            e = tf == AminoAnim::TF_CUBIC_OUT ? 1.f - u3 : e;
+            e = tf == AminoAnim::TF_CUBIC_IN_OUT ? inOut : e;
+
+            pValue[i] = pFrom[i] + (pTo[i] - pFrom[i]) * e;
+        }
+    }
+
+    // 3b) complex curves and keyframes
+    if (curveCount > 0) {
+        for (size_t i = 0; i < n; i++) {
+            AminoAnimCurve *curve = curves[i];
+
+            if (curve) {
+                float t = pos[i];
+
+                t += reverse[i] * (1.f - 2.f * t);
+                value[i] = curve->evaluate(timeFunc[i], t, from[i], to[i]);
+            }
+        }
+    }
+
+    // 4) apply
+    for (size_t i = 0; i < n; i++) {
+        if (started[i]) {
+            anims[i]->applyValue(value[i]);
+        }
+    }
+}
+
+//
+// AminoAnimCurve
+//
+
+/**
+ * Constructor.
+ */
+AminoAnimCurve::AminoAnimCurve() {
+    //empty
+}
+
+/**
+ * Destructor.
+ */
+AminoAnimCurve::~AminoAnimCurve() {
+    //empty
+}
+
+/**
+ * Set keyframes.
+ *
+ * @param values at least two values
+ * @param times normalized ascending times (empty: equidistant)
+ * @return false if invalid
+ */
+bool AminoAnimCurve::setKeyframes(std::vector<float> &values, std::vector<float> &times) {
+    size_t n = values.size();
+
+    if (n < 2) {
+        return false;
+    }
+
+    if (times.empty()) {
+        //equidistant
+        for (size_t i = 0; i < n; i++) {
+            times.push_back((float)i / (n - 1));
+        }
+    } else {
+        if (times.size() != n) {
+            return false;
+        }
+
+        for (size_t i = 1; i < n; i++) {
+            if (times[i] < times[i - 1]) {
+                return false;
+            }
+        }
+    }
+
+    keyValues = values;
+    keyTimes = times;
+
+    return true;
+}
+
+/**
+ * Use a CSS-style cubic-bezier time function.
+ */
+void AminoAnimCurve::setBezier(float x1, float y1, float x2, float y2) {
+    bezierTable = getBezierTable(x1, y1, x2, y2);
+}
+
+/**
+ * Get a shared cubic-bezier lookup table.
+ *
+ * Note: has to be called on main thread.
+ */
+std::shared_ptr<std::vector<float> > AminoAnimCurve::getBezierTable(float x1, float y1, float x2, float y2) {
+    typedef std::tuple<float, float, float, float> BezierKey;
+    static std::map<BezierKey, std::weak_ptr<std::vector<float> > > tables;
+
+    //x values have to be in [0, 1]
+    x1 = std::min(std::max(x1, 0.f), 1.f);
+    x2 = std::min(std::max(x2, 0.f), 1.f);
+
+    //check cache
+    BezierKey key(x1, y1, x2, y2);
+    std::map<BezierKey, std::weak_ptr<std::vector<float> > >::iterator it = tables.find(key);
+
+    if (it != tables.end()) {
+        std::shared_ptr<std::vector<float> > table = it->second.lock();
+
+        if (table) {
+            return table;
+        }
+    }
+
+    //remove unused tables
+    for (it = tables.begin(); it != tables.end();) {
+        if (it->second.expired()) {
+            it = tables.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    //create table
+    std::shared_ptr<std::vector<float> > table = std::make_shared<std::vector<float> >(BEZIER_TABLE_SIZE + 1);
+
+    //polynomial coefficients (P0 = (0, 0), P3 = (1, 1))
+    float cx = 3.f * x1;
+    float bx = 3.f * (x2 - x1) - cx;
+    float ax = 1.f - cx - bx;
+    float cy = 3.f * y1;
+    float by = 3.f * (y2 - y1) - cy;
+    float ay = 1.f - cy - by;
+
+    for (int i = 0; i <= BEZIER_TABLE_SIZE; i++) {
+        float x = (float)i / BEZIER_TABLE_SIZE;
+        float s = x;
+        bool solved = false;
+
+        //Newton-Raphson
+        for (int j = 0; j < 8; j++) {
+            float err = ((ax * s + bx) * s + cx) * s - x;
+
+            if (fabsf(err) < 1e-6f) {
+                solved = true;
+                break;
+            }
+
+            float d = (3.f * ax * s + 2.f * bx) * s + cx;
+
+            if (fabsf(d) < 1e-6f) {
+                break;
+            }
+
+            s -= err / d;
+        }
+
+        //bisection
+        if (!solved) {
+            float lo = 0.f;
+            float hi = 1.f;
+
+            s = x;
+
+            for (int j = 0; j < 32; j++) {
+                float err = ((ax * s + bx) * s + cx) * s - x;
+
+                if (fabsf(err) < 1e-6f) {
+                    break;
+                }
+
+                if (err > 0) {
+                    hi = s;
+                } else {
+                    lo = s;
+                }
+
+                s = (lo + hi) / 2.f;
+            }
+        }
+
+        (*table)[i] = ((ay * s + by) * s + cy) * s;
+    }
+
+    tables[key] = table;
+
+    return table;
+}
+
+/**
+ * Cubic-bezier time function (interpolated table lookup).
+ */
+float AminoAnimCurve::bezier(float t) {
+    if (!bezierTable) {
+        return t;
+    }
+
+    if (t <= 0.f) {
+        return (*bezierTable)[0];
+    }
+
+    if (t >= 1.f) {
+        return (*bezierTable)[BEZIER_TABLE_SIZE];
+    }
+
+    float x = t * BEZIER_TABLE_SIZE;
+    int i = (int)x;
+    float f = x - i;
+
+    return (*bezierTable)[i] + ((*bezierTable)[i + 1] - (*bezierTable)[i]) * f;
+}
+
+/**
+ * Elastic-out time function.
+ */
+static float elasticOut(float t) {
+    if (t <= 0.f || t >= 1.f) {
+        return t <= 0.f ? 0.f:1.f;
+    }
+
+    return powf(2.f, -10.f * t) * sinf((t * 10.f - 0.75f) * (2.f * M_PI / 3.f)) + 1.f;
+}
+
+/**
+ * Bounce-out time function.
+ */
+static float bounceOut(float t) {
+    const float n1 = 7.5625f;
+    const float d1 = 2.75f;
+
+    if (t < 1.f / d1) {
+        return n1 * t * t;
+    }
+
+    if (t < 2.f / d1) {
+        t -= 1.5f / d1;
+
+        return n1 * t * t + 0.75f;
+    }
+
+    if (t < 2.5f / d1) {
+        t -= 2.25f / d1;
+
+        return n1 * t * t + 0.9375f;
+    }
+
+    t -= 2.625f / d1;
+
+    return n1 * t * t + 0.984375f;
+}
+
+/**
+ * Apply a time function.
+ *
+ * @param t normalized time
+ */
+float AminoAnimCurve::ease(int timeFunc, float t) {
+    switch (timeFunc) {
+        case AminoAnim::TF_CUBIC_IN:
+            return t * t * t;
+
+        case AminoAnim::TF_CUBIC_OUT:
+            {
+                float u = 1.f - t;
+
+                return 1.f - u * u * u;
+            }
+
+        case AminoAnim::TF_CUBIC_IN_OUT:
+            {
+                float u = 1.f - t;
+
+                return t < 0.5f ? 4.f * t * t * t : 1.f - 4.f * u * u * u;
+            }
+
+        case AminoAnim::TF_BEZIER:
+            return bezier(t);
+
+        case AminoAnim::TF_ELASTIC_IN:
+            return 1.f - elasticOut(1.f - t);
+
+        case AminoAnim::TF_ELASTIC_OUT:
+            return elasticOut(t);
+
+        case AminoAnim::TF_ELASTIC_IN_OUT:
+            return t < 0.5f ? (1.f - elasticOut(1.f - 2.f * t)) / 2.f : (1.f + elasticOut(2.f * t - 1.f)) / 2.f;
+
+        case AminoAnim::TF_BOUNCE_IN:
+            return 1.f - bounceOut(1.f - t);
+
+        case AminoAnim::TF_BOUNCE_OUT:
+            return bounceOut(t);
+
+        case AminoAnim::TF_BOUNCE_IN_OUT:
+            return t < 0.5f ? (1.f - bounceOut(1.f - 2.f * t)) / 2.f : (1.f + bounceOut(2.f * t - 1.f)) / 2.f;
+
+        case AminoAnim::TF_SPRING:
+            {
+                //damped oscillation, residual at t = 1 removed linearly
+                float residual = expf(-springDamping) * cosf(springFrequency);
+
+                return 1.f - expf(-springDamping * t) * cosf(springFrequency * t) + residual * t;
+            }
+
+        case AminoAnim::TF_LINEAR:
+        default:
+            return t;
+    }
+}
+
+/**
+ * Calculate the value at a given time.
+ *
+ * Note: called on rendering thread.
+ *
+ * @param t normalized time
+ */
+float AminoAnimCurve::evaluate(int timeFunc, float t, float from, float to) {
+    size_t n = keyValues.size();
+
+    if (n == 0) {
+        return from + (to - from) * ease(timeFunc, t);
+    }
+
+    //keyframes (time function applies to each segment)
+    if (t <= keyTimes[0]) {
+        return keyValues[0];
+    }
+
+    if (t >= keyTimes[n - 1]) {
+        return keyValues[n - 1];
+    }
+
+    size_t k = std::upper_bound(keyTimes.begin(), keyTimes.end(), t) - keyTimes.begin() - 1;
+    float span = keyTimes[k + 1] - keyTimes[k];
+    float local = span > 0 ? (t - keyTimes[k]) / span : 1.f;
+
+    return keyValues[k] + (keyValues[k + 1] - keyValues[k]) * ease(timeFunc, local);
+}
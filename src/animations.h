@@ -0,0 +1,97 @@
+#ifndef _AMINOANIMATIONS_H
+#define _AMINOANIMATIONS_H
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include <stddef.h>
+
+class AminoAnim;
+
+//cubic-bezier lookup table size
+#define BEZIER_TABLE_SIZE 256
+
+/**
+ * Animation curve (complex time functions and keyframes).
+ *
+ * Note: created on main thread, immutable while the animation is running.
+ */
+class AminoAnimCurve {
+public:
+    //keyframes (normalized times)
+    std::vector<float> keyTimes;
+    std::vector<float> keyValues;
+
+    //spring
+    float springDamping = 8.f;
+    float springFrequency = 20.f;
+
+    AminoAnimCurve();
+    ~AminoAnimCurve();
+
+    bool setKeyframes(std::vector<float> &values, std::vector<float> &times);
+    void setBezier(float x1, float y1, float x2, float y2);
+
+    float ease(int timeFunc, float t);
+    float evaluate(int timeFunc, float t, float from, float to);
+
+private:
+    //shared cubic-bezier table (y values at equidistant x positions)
+    std::shared_ptr<std::vector<float> > bezierTable;
+
+    static std::shared_ptr<std::vector<float> > getBezierTable(float x1, float y1, float x2, float y2);
+    float bezier(float t);
+};
+
+/**
+ * Animation engine.
+ *
+ * Keeps all running float animations in structure-of-arrays layout. Each frame is processed in passes: time to position,
+ * cycle handling (only tracks leaving the [0, 1] range), time function and property update.
+ *
+ * Note: not thread-safe (see AminoGfx::animLock).
+ */
+class AminoAnimEngine {
+public:
+    AminoAnimEngine();
+    ~AminoAnimEngine();
+
+    void add(AminoAnim *anim);
+    void remove(AminoAnim *anim);
+    void clear();
+
+    size_t size();
+
+    void update(double currentTime);
+
+private:
+    //tracks
+    std::vector<float> from;
+    std::vector<float> to;
+    std::vector<float> duration;
+    std::vector<float> invDuration;
+    std::vector<double> startTime;
+    std::vector<int32_t> count;
+    std::vector<float> reverse; //0: forward, 1: backward
+    std::vector<uint8_t> autoreverse;
+    std::vector<uint8_t> timeFunc;
+    std::vector<uint8_t> started;
+    std::vector<AminoAnimCurve *> curves;
+    std::vector<AminoAnim *> anims;
+
+    size_t curveCount = 0;
+
+    //current frame
+    std::vector<float> pos;
+    std::vector<float> value;
+
+    double lastTime = 0;
+
+    bool startTrack(size_t i, double currentTime);
+    bool nextCycle(size_t i, double currentTime);
+    void toggle(size_t i);
+    void endTrack(size_t i);
+    void removeTrack(size_t i);
+};
+
+#endif
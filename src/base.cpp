@@ -1,6 +1,5 @@
 #include "base.h"
 
-#include <cwctype>
 #include <algorithm>
 
 #include "renderer.h"
@@ -31,6 +30,10 @@ AminoGfx::AminoGfx(std::string name): AminoJSEventObject(name) {
     // animLock
     res = pthread_mutex_init(&animLock, &attr);
     assert(res == 0);
+
+    // surfacesLock
+    res = pthread_mutex_init(&surfacesLock, &attr);
+    assert(res == 0);
 }
 
 AminoGfx::~AminoGfx() {
@@ -50,6 +53,9 @@ AminoGfx::~AminoGfx() {
 
     assert(res == 0);
 
+    res = pthread_mutex_destroy(&surfacesLock);
+    assert(res == 0);
+
     //Note: properties are deleted by base class destructor
 }
 
@@ -122,6 +128,9 @@ void AminoGfx::Init(Nan::ADDON_REGISTER_FUNCTION_ARGS_TYPE target, AminoJSObject
     Nan::SetPrototypeMethod(tpl, "getTime", GetTime);
     Nan::SetMethod(tpl, "getTime", GetTime);
 
+    //debug
+    Nan::SetMethod(tpl, "checkMatrixPerformance", CheckMatrixPerformance);
+
     //settings
     Nan::SetPrototypeMethod(tpl, "updatePerspective", UpdatePerspective);
 
@@ -264,6 +273,41 @@ void AminoGfx::initRenderer() {
                 swapInterval = swapIntervalValue->Int32Value();
             }
         }
+
+        //texture tile size (limited by the maximum texture size)
+        Nan::MaybeLocal<v8::Value> tileSizeMaybe = Nan::Get(obj, Nan::New<v8::String>("textureTileSize").ToLocalChecked());
+
+        if (!tileSizeMaybe.IsEmpty()) {
+            v8::Local<v8::Value> tileSizeValue = tileSizeMaybe.ToLocalChecked();
+
+            if (tileSizeValue->IsInt32()) {
+                textureTileSize = tileSizeValue->Int32Value();
+            }
+        }
+
+        //texture upload budget per frame (milliseconds and bytes)
+        double uploadTime = TEXTURE_UPLOAD_TIME;
+        double uploadBytes = TEXTURE_UPLOAD_BYTES;
+        Nan::MaybeLocal<v8::Value> uploadTimeMaybe = Nan::Get(obj, Nan::New<v8::String>("textureUploadTime").ToLocalChecked());
+        Nan::MaybeLocal<v8::Value> uploadBytesMaybe = Nan::Get(obj, Nan::New<v8::String>("textureUploadBytes").ToLocalChecked());
+
+        if (!uploadTimeMaybe.IsEmpty()) {
+            v8::Local<v8::Value> uploadTimeValue = uploadTimeMaybe.ToLocalChecked();
+
+            if (uploadTimeValue->IsNumber()) {
+                uploadTime = uploadTimeValue->NumberValue();
+            }
+        }
+
+        if (!uploadBytesMaybe.IsEmpty()) {
+            v8::Local<v8::Value> uploadBytesValue = uploadBytesMaybe.ToLocalChecked();
+
+            if (uploadBytesValue->IsNumber()) {
+                uploadBytes = uploadBytesValue->NumberValue();
+            }
+        }
+
+        textureUploader.setBudget(std::max(uploadTime, 0.), (size_t)std::max(uploadBytes, 0.));
     }
 }
 
@@ -280,6 +324,9 @@ void AminoGfx::setupRenderer() {
     renderer = new AminoRenderer(this);
     renderer->setup();
 
+    //texture limit
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
     if (!createParams.IsEmpty()) {
         v8::Local<v8::Object> obj = Nan::New(createParams);
 
@@ -325,6 +372,9 @@ void AminoGfx::addRuntimeProperty() {
     glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureImageUnits);
     Nan::Set(obj, Nan::New("maxTextureImageUnits").ToLocalChecked(), Nan::New(maxTextureImageUnits));
 
+    //matrix kernels
+    Nan::Set(obj, Nan::New("simd").ToLocalChecked(), Nan::New(get_matrix_simd_mode()).ToLocalChecked());
+
     // 4) platform specific
     populateRuntimeProperties(obj);
 }
@@ -493,6 +543,11 @@ void AminoGfx::startRenderingThread() {
         return;
     }
 
+    //text layout thread
+    if (!textLayouter) {
+        textLayouter = new AminoTextLayouter();
+    }
+
     int res = uv_thread_create(&thread, renderingThread, this);
 
     assert(res == 0);
@@ -609,6 +664,12 @@ void AminoGfx::render() {
     //update texts
     updateTextNodes();
 
+    //pending textures (within frame budget)
+    textureUploader.process();
+
+    //committed pixel surfaces (also if not visible)
+    updateSurfaces();
+
     //render scene (root node)
     if (DEBUG_RENDERER) {
         printf("-> renderer: renderScene()\n");
@@ -653,14 +714,11 @@ void AminoGfx::processAnimations() {
     assert(res == 0);
 
     double currentTime = getTime();
-    int count = animations.size();
 
     //debug timer
     //printf("timer timestamp: %f\n", currentTime);
 
-    for (int i = 0; i < count; i++) {
-        animations[i]->update(currentTime);
-    }
+    animEngine.update(currentTime);
 
     res = pthread_mutex_unlock(&animLock);
     assert(res == 0);
@@ -686,6 +744,15 @@ NAN_METHOD(AminoGfx::GetTime) {
     info.GetReturnValue().Set(getTime());
 }
 
+/**
+ * Verify the matrix kernels and measure their performance (output on console).
+ *
+ * Returns true if the kernels match the scalar reference.
+ */
+NAN_METHOD(AminoGfx::CheckMatrixPerformance) {
+    info.GetReturnValue().Set(Nan::New(check_matrix_performance()));
+}
+
 /**
  * Check if rendering scene right now.
  */
@@ -765,6 +832,25 @@ void AminoGfx::destroyAminoGfx() {
         }
     }
 
+    //text layout thread (Note: might delete vertex buffers)
+    if (textLayouter) {
+        delete textLayouter;
+        textLayouter = NULL;
+    }
+
+    //pending texture uploads
+    textureUploader.clear();
+
+    //pixel surfaces
+    int res = pthread_mutex_lock(&surfacesLock);
+
+    assert(res == 0);
+
+    surfaces.clear();
+
+    res = pthread_mutex_unlock(&surfacesLock);
+    assert(res == 0);
+
     //unbind root
     setRoot(NULL);
 
@@ -951,10 +1037,22 @@ void AminoGfx::getStats(v8::Local<v8::Object> &obj) {
 
     //animations
     Nan::Set(obj, Nan::New("animations").ToLocalChecked(), Nan::New((uint32_t)animations.size()));
+    Nan::Set(obj, Nan::New("animationTracks").ToLocalChecked(), Nan::New((uint32_t)animEngine.size()));
 
     //textures
     Nan::Set(obj, Nan::New("textures").ToLocalChecked(), Nan::New(textureCount));
 
+    //text layouts (not applied yet)
+    if (textLayouter) {
+        Nan::Set(obj, Nan::New("textLayouts").ToLocalChecked(), Nan::New((uint32_t)textLayouter->getPendingCount()));
+    }
+
+    //shared text meshes
+    textMeshes.getStats(obj);
+
+    //texture uploads (not uploaded yet)
+    textureUploader.getStats(obj);
+
     //rendering performance (FPS)
     if (MEASURE_FPS && lastFPS) {
         v8::Local<v8::Object> fpsObj = Nan::New<v8::Object>();
@@ -968,6 +1066,15 @@ void AminoGfx::getStats(v8::Local<v8::Object> &obj) {
     }
 
     //renderer
+    if (renderer) {
+        renderer->getStats(obj);
+    }
+
+    //font atlas pages
+    AminoFont::getStats(obj);
+
+    //image decoding
+    AminoImage::getStats(obj);
 
     if (SHOW_RENDERER_ERRORS) {
         Nan::Set(obj, Nan::New("errors").ToLocalChecked(), Nan::New(rendererErrors));
@@ -1008,6 +1115,26 @@ bool AminoGfx::addAnimation(AminoAnim *anim) {
     return true;
 }
 
+/**
+ * Start animation (add to animation engine).
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::startAnimation(AminoAnim *anim) {
+    if (destroyed) {
+        return;
+    }
+
+    int res = pthread_mutex_lock(&animLock);
+
+    assert(res == 0);
+
+    animEngine.add(anim);
+
+    res = pthread_mutex_unlock(&animLock);
+    assert(res == 0);
+}
+
 /**
  * Remove animation.
  *
@@ -1023,6 +1150,8 @@ void AminoGfx::removeAnimation(AminoAnim *anim) {
 
     assert(res == 0);
 
+    animEngine.remove(anim);
+
     std::vector<AminoAnim *>::iterator pos = std::find(animations.begin(), animations.end(), anim);
 
     if (pos != animations.end()) {
@@ -1051,6 +1180,8 @@ void AminoGfx::clearAnimations() {
 
     assert(res == 0);
 
+    animEngine.clear();
+
     std::size_t count = animations.size();
 
     for (std::size_t i = 0; i < count; i++) {
@@ -1193,139 +1324,267 @@ void AminoGfx::textUpdateNeeded(AminoText *text) {
 }
 
 /**
- * Update all modified text nodes.
+ * Stop the layout of a text (text is destroyed).
+ *
+ * Note: called on main thread.
  */
-void AminoGfx::updateTextNodes() {
-    std::size_t count = textUpdates.size();
+void AminoGfx::cancelTextLayout(AminoText *text) {
+    if (textLayouter) {
+        textLayouter->cancel(text);
+    }
+}
 
-    if (count == 0) {
-        return;
+/**
+ * Get the maximum size of a texture tile.
+ *
+ * Note: called on rendering thread.
+ */
+int AminoGfx::getTextureTileSize() {
+    if (textureTileSize > 0 && (maxTextureSize <= 0 || textureTileSize < maxTextureSize)) {
+        return textureTileSize;
     }
 
-#if (DEBUG_FONT_PERFORMANCE == 1)
-    //debug
-    double startTime = getTime(), diff;
-#endif
+    return maxTextureSize;
+}
 
-    //layout modified texts
-    std::vector<AminoText *> textureUpdates;
+/**
+ * Queue a texture upload.
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::addTextureUpload(amino_texture_upload_t *upload) {
+    textureUploader.add(upload);
+}
 
-    for (std::size_t i = 0; i < count; i++) {
-        AminoText *item = textUpdates[i];
+/**
+ * Count allocations of the reused texture row buffers (renderer stats).
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::addBufferAllocations(int count) {
+    if (count > 0 && renderer) {
+        renderer->addBufferAllocations(count);
+    }
+}
 
-        if (item->layoutText()) {
-            //find texture
-            std::size_t textureCount = textureUpdates.size();
-            GLuint textureId = item->getTextureId();
-            bool found = false;
+/**
+ * Upload the committed rectangles of a pixel surface once per frame.
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::addSurface(AminoTexture *texture) {
+    int res = pthread_mutex_lock(&surfacesLock);
 
-            for (std::size_t j = 0; j < textureCount; j++) {
-                AminoText *item2 = textureUpdates[j];
+    assert(res == 0);
 
-                if (item2->getTextureId() == textureId) {
-                    found = true;
-                    break;
-                }
-            }
+    if (std::find(surfaces.begin(), surfaces.end(), texture) == surfaces.end()) {
+        surfaces.push_back(texture);
+    }
 
-            if (!found) {
-                textureUpdates.push_back(item);
-            }
-        }
+    res = pthread_mutex_unlock(&surfacesLock);
+    assert(res == 0);
+}
+
+/**
+ * Remove a pixel surface.
+ *
+ * Note: called on main thread.
+ */
+void AminoGfx::removeSurface(AminoTexture *texture) {
+    int res = pthread_mutex_lock(&surfacesLock);
+
+    assert(res == 0);
+
+    std::vector<AminoTexture *>::iterator pos = std::find(surfaces.begin(), surfaces.end(), texture);
+
+    if (pos != surfaces.end()) {
+        surfaces.erase(pos);
     }
 
-    textUpdates.clear();
+    res = pthread_mutex_unlock(&surfacesLock);
+    assert(res == 0);
+}
 
-#if (DEBUG_FONT_PERFORMANCE == 1)
-    //debug
-    diff = getTime() - startTime;
-    if (diff > 5) {
-        printf("layoutText: %i ms\n", (int)diff);
+/**
+ * Upload all committed pixel surfaces.
+ *
+ * Note: called on rendering thread.
+ */
+void AminoGfx::updateSurfaces() {
+    int res = pthread_mutex_lock(&surfacesLock);
+
+    assert(res == 0);
+
+    for (auto const &texture : surfaces) {
+        texture->updateSurfaceTexture();
     }
-#endif
 
-    //update textures
-    std::size_t textureCount = textureUpdates.size();
+    res = pthread_mutex_unlock(&surfacesLock);
+    assert(res == 0);
+}
 
+/**
+ * Update all modified text nodes.
+ *
+ * Applies the layouts of the previous frames and passes the modified texts to the layout thread.
+ */
+void AminoGfx::updateTextNodes() {
+    assert(textLayouter);
+
+    //apply finished layouts
+    std::vector<amino_text_layout_t *> *layouts = textLayouter->beginApply();
+
+    if (layouts) {
 #if (DEBUG_FONT_PERFORMANCE == 1)
-    //debug
-    startTime = getTime();
+        //debug
+        double startTime = getTime(), diff;
 #endif
 
-    for (std::size_t i = 0; i < textureCount; i++) {
-        AminoText *item = textureUpdates[i];
+        std::vector<AminoFont *> fonts;
+        std::vector<amino_atlas_update_t> updates;
+
+        //Note: layout thread is idle
+        uv_mutex_lock(&AminoText::freeTypeMutex);
+
+        for (auto layout : *layouts) {
+            AminoText *text = layout->text;
+
+            if (!text) {
+                //cancelled
+                continue;
+            }
+
+            text->applyLayout(layout);
+
+            //fonts (atlas pages)
+            AminoFont *font = layout->fontSize->font;
+
+            if (std::find(fonts.begin(), fonts.end(), font) == fonts.end()) {
+                fonts.push_back(font);
+            }
+        }
+
+        //update textures
+        for (auto font : fonts) {
+            size_t bytes = AminoText::updateTexture(this, font, updates);
+
+            renderer->addAtlasUploadBytes(bytes);
+            textureUploader.addBytes(bytes);
+        }
 
-        item->updateTexture();
+        uv_mutex_unlock(&AminoText::freeTypeMutex);
+
+        textLayouter->endApply();
 
         //inform other amino instances to update shared texture
-        texture_atlas_t *atlas = item->fontSize->fontTexture->atlas;
+        for (auto &update : updates) {
+            atlasTextureHasChanged(&update);
+        }
 
-        atlasTextureHasChanged(atlas);
+#if (DEBUG_FONT_PERFORMANCE == 1)
+        //debug
+        diff = getTime() - startTime;
+        if (diff > 5) {
+            printf("applyLayout: %i ms\n", (int)diff);
+        }
+#endif
     }
 
-#if (DEBUG_FONT_PERFORMANCE == 1)
-    //debug
-    diff = getTime() - startTime;
-    if (diff > 5) {
-        printf("updateTexture: %i ms\n", (int)diff);
+    //layout modified texts
+    for (auto text : textUpdates) {
+        amino_text_layout_t *layout = text->createLayout();
+
+        if (layout) {
+            textLayouter->add(layout);
+        }
     }
-#endif
+
+    textUpdates.clear();
 }
 
 /**
  * Shared atlas texture has changed.
  *
- * Note: called on rendering thread.
+ * Note: called on rendering thread. The update data is only valid during the call.
  */
-void AminoGfx::atlasTextureHasChanged(texture_atlas_t *atlas) {
+void AminoGfx::atlasTextureHasChanged(amino_atlas_update_t *update) {
     //overwrite
 }
 
+/**
+ * Free the atlas update copy passed to the main thread.
+ */
+void AminoGfx::atlasTextureHasChangedDone(JSCallbackUpdate *update) {
+    delete (amino_atlas_update_t *)update->data;
+}
+
 /**
  * Shared atlas texture has to be updated.
  *
  * Note: called on main thread
  */
-void AminoGfx::updateAtlasTexture(texture_atlas_t *atlas) {
-    //check if texture exists
-    bool newTexture;
-    amino_atlas_t texture = getAtlasTexture(atlas, false, newTexture);
-
-    if (texture.textureId != INVALID_TEXTURE) {
-        if (DEBUG_BASE) {
-            printf("enqueue: atlas texture update\n");
-        }
-
-        //switch to rendering thread
-        AminoJSObject::enqueueValueUpdate(texture.textureId, atlas, static_cast<asyncValueCallback>(&AminoGfx::updateAtlasTextureHandler));
+void AminoGfx::updateAtlasTexture(amino_atlas_update_t *update) {
+    if (DEBUG_BASE) {
+        printf("enqueue: atlas texture update\n");
     }
+
+    //switch to rendering thread (dirty regions are copied, texture is looked up there)
+    AminoJSObject::enqueueValueUpdate((unsigned int)0, new amino_atlas_update_t(*update), static_cast<asyncValueCallback>(&AminoGfx::updateAtlasTextureHandler));
 }
 
 /**
  * Update atlas texture.
  */
 void AminoGfx::updateAtlasTextureHandler(AsyncValueUpdate *update, int state) {
+    amino_atlas_update_t *atlasUpdate = (amino_atlas_update_t *)update->data;
+
+    if (state == AsyncValueUpdate::STATE_DELETE) {
+        delete atlasUpdate;
+        return;
+    }
+
     if (state != AsyncValueUpdate::STATE_APPLY) {
         return;
     }
 
+    if (!renderer) {
+        return;
+    }
+
+    //Note: layout thread might add glyphs
+    uv_mutex_lock(&AminoText::freeTypeMutex);
+
+    //check if texture exists (a repacked page gets a new one with the whole page)
+    bool newTexture;
+    amino_atlas_t texture = getAtlasTexture(atlasUpdate->page, false, newTexture);
+    int allocations = 0;
+    size_t bytes = 0;
+
     //debug
-    //printf("%p: texture update %i\n", this, (int)update->valueUint32);
+    //printf("%p: texture update %i\n", this, (int)texture.textureId);
+
+    if (texture.textureId != INVALID_TEXTURE) {
+        bytes = AminoText::updateTextureFromAtlas(texture.textureId, atlasUpdate->atlas, atlasUpdate, &allocations);
+    }
 
-    texture_atlas_t *atlas = (texture_atlas_t *)update->data;
+    uv_mutex_unlock(&AminoText::freeTypeMutex);
 
-    AminoText::updateTextureFromAtlas(update->valueUint32, atlas);
+    if (renderer) {
+        renderer->addAtlasUploadBytes(bytes);
+    }
+
+    addBufferAllocations(allocations);
 }
 
 /**
- * Get texture for atlas.
+ * Get texture for atlas page.
  *
- * Note: has to be called on OpenGL thread (if createIfMissing is true).
+ * Note: has to be called on OpenGL thread, freeTypeMutex must be locked.
  */
-amino_atlas_t AminoGfx::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
+amino_atlas_t AminoGfx::getAtlasTexture(amino_font_page_t *page, bool createIfMissing, bool &newTexture) {
     assert(renderer);
 
-    return renderer->getAtlasTexture(atlas, createIfMissing, newTexture);
+    return renderer->getAtlasTexture(page, createIfMissing, newTexture);
 }
 
 /**
@@ -1340,9 +1599,13 @@ void AminoGfx::notifyTextureCreated(int count) {
  *
  * Note: called on main thread.
  */
-void AminoGfx::updateAtlasTextures(texture_atlas_t *atlas) {
+void AminoGfx::updateAtlasTextures(amino_atlas_update_t *update) {
+    if (update->count == 0) {
+        return;
+    }
+
     for (auto const &item : instances) {
-        item->updateAtlasTexture(atlas);
+        item->updateAtlasTexture(update);
     }
 }
 
@@ -1463,28 +1726,52 @@ AminoJSObject* AminoTextFactory::create() {
 //
 
 /**
- * Update texture.
+ * Update textures of all atlas pages (dirty regions).
+ *
+ * Note: freeTypeMutex must be locked.
+ *
+ * @param updates dirty regions (appended)
+ * @return uploaded bytes
  */
-void AminoText::updateTexture() {
+size_t AminoText::updateTexture(AminoGfx *gfx, AminoFont *font, std::vector<amino_atlas_update_t> &updates) {
     if (DEBUG_FONT_UPDATES) {
-        printf("-> update font texture: %s\n", fontSize->font->getFontInfo().c_str());
+        printf("-> update font texture: %s\n", font->getFontInfo().c_str());
     }
 
-    assert(texture.textureId != INVALID_TEXTURE);
-    assert(fontSize);
-    assert(fontSize->fontTexture);
+    assert(font);
 
-    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
+    size_t first = updates.size();
 
-    assert(atlas);
+    font->takeDirtyPages(updates);
 
-    updateTextureFromAtlas(texture.textureId, atlas);
+    size_t count = updates.size();
+    size_t bytes = 0;
+    int allocations = 0;
+
+    for (size_t i = first; i < count; i++) {
+        amino_atlas_update_t *update = &updates[i];
+        bool newTexture;
+        amino_atlas_t texture = gfx->getAtlasTexture(update->page, false, newTexture);
+
+        //Note: missing textures get the whole page on creation
+        if (texture.textureId != INVALID_TEXTURE) {
+            bytes += updateTextureFromAtlas(texture.textureId, update->atlas, update, &allocations);
+        }
+    }
+
+    gfx->addBufferAllocations(allocations);
+
+    return bytes;
 }
 
 /**
  * Update texture from atlas.
+ *
+ * @param update dirty regions (NULL: create texture from whole atlas)
+ * @param allocations incremented if a row buffer had to be allocated
+ * @return uploaded bytes
  */
-void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas) {
+size_t AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas, amino_atlas_update_t *update, int *allocations) {
     //update texture
     if (DEBUG_BASE) {
         printf("-> updateTexture()\n");
@@ -1523,337 +1810,424 @@ void AminoText::updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas)
         printf("\n");
     }
 
-    glBindTexture(GL_TEXTURE_2D, textureId);
-
-    //Note: glTexSubImage2D() would probably be faster
+    GLenum format;
 
     if (atlas->depth == 1) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas->width, atlas->height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlas->data);
+        format = GL_ALPHA;
     } else if (atlas->depth == 3) {
         //Note: not supported so far
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, atlas->width, atlas->height, 0, GL_RGB, GL_UNSIGNED_BYTE, atlas->data);
+        format = GL_RGB;
+    } else {
+        return 0;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    //whole texture
+    if (!update) {
+        glTexImage2D(GL_TEXTURE_2D, 0, format, atlas->width, atlas->height, 0, format, GL_UNSIGNED_BYTE, atlas->data);
+
+        return atlas->width * atlas->height * atlas->depth;
+    }
+
+    //dirty regions
+    size_t bytes = 0;
+
+    for (size_t i = 0; i < update->count; i++) {
+        ivec4 &rect = update->rects[i];
+        size_t rowSize = rect.width * atlas->depth;
+        unsigned char *src = atlas->data + (rect.y * atlas->width + rect.x) * atlas->depth;
+
+        if (rect.x == 0 && (size_t)rect.width == atlas->width) {
+            //complete rows
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, format, GL_UNSIGNED_BYTE, src);
+        } else {
+            //copy sub-rows (Note: GL_UNPACK_ROW_LENGTH is not available on OpenGL ES 2.0)
+            size_t length = rowSize * rect.height;
+            bool allocated;
+            unsigned char *pixels = AminoImage::bufferPool.get(length, &allocated);
+
+            assert(pixels);
+
+            if (allocated && allocations) {
+                (*allocations)++;
+            }
+
+            for (int j = 0; j < rect.height; j++) {
+                memcpy(pixels + j * rowSize, src + j * atlas->width * atlas->depth, rowSize);
+            }
+
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x, rect.y, rect.width, rect.height, format, GL_UNSIGNED_BYTE, pixels);
+
+            AminoImage::bufferPool.put(pixels, length);
+        }
+
+        bytes += rowSize * rect.height;
     }
 
     //printf("font texture updated\n");
     //printf("updateTexture() done\n");
+
+    return bytes;
 }
 
 /**
- * Get the font texture.
+ * Check if the atlas pages of all batches are still valid.
+ *
+ * Note: glyphs get moved if a page is repacked.
  */
-GLuint AminoText::getTextureId() {
-    return texture.textureId;
+bool AminoText::hasValidBatches() {
+    if (!mesh) {
+        return true;
+    }
+
+    for (auto const &batch : mesh->batches) {
+        if (batch.page->generation != batch.generation) {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /**
  * Render text to vertices.
+ *
+ * Note: freeTypeMutex must be locked.
  */
-void AminoText::addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, const char *text, vec2 *pen, int wrap, int width, int *lineNr, int maxLines, float *lineW) {
-    //see https://github.com/rougier/freetype-gl/blob/master/demos/glyph.c
-    size_t len = utf8_strlen(text);
+void AminoText::addTextGlyphs(vertex_buffer_t *buffer, AminoFontSize *fontSize, AminoLineBreaker *breaker, const std::string &str, int wrap, int width, int maxLines, int *lineNr, float *lineW) {
+    texture_font_t *font = fontSize->fontTexture;
+    AminoFont *aminoFont = fontSize->font;
 
-    *lineNr = 1;
-    *lineW = 0;
+    //SDF glyphs: scaled
+    float scale = fontSize->scale;
+    float lineHeight = font->height * scale;
 
-    size_t lineStart = 0; //start of current line
-    size_t linePos = 0; //character pos current line
-    float penXStart = pen->x;
+    //shaped characters & line breaks (cached per string, linear pass per width)
+    amino_text_shape_t *shape = breaker->getShape(fontSize, str);
+    std::vector<amino_text_line_t> lines;
 
-    //debug
-    //printf("addTextGlyphs: wrap=%i width=%i\n", wrap, width);
+    AminoLineBreaker::breakLines(shape, wrap, width, maxLines, lines);
 
-    //add glyphs (by iterating Unicode characters)
-    char *textPos = (char *)text;
-    char *lastTextPos = NULL;
-    uint32_t textUtf32[len];
-    bool done = false;
+    //debug
+    //printf("addTextGlyphs: wrap=%i width=%i lines=%i\n", wrap, width, (int)lines.size());
 
-    for (size_t i = 0; i < len; ++i) {
-        texture_glyph_t *glyph = texture_font_get_glyph(font, textPos);
+    //add glyphs
+    const char *text = str.c_str();
+    size_t pageCount = aminoFont->getPageCount();
+    size_t lineCount = lines.size();
 
-        if (glyph) {
-            //store
-            textUtf32[i] = glyph->codepoint;
+    *lineNr = lineCount;
+    *lineW = 0;
 
-            //kerning
-            int kerning = 0;
+    for (size_t n = 0; n < lineCount; n++) {
+        size_t start = lines[n].start;
+        size_t end = lines[n].end;
 
-            if (linePos > 0) {
-                kerning = texture_glyph_get_kerning(glyph, lastTextPos);
+        //trailing white space
+        if (wrap != AminoText::WRAP_NONE) {
+            while (end > start && (shape->chars[end - 1].flags & CHAR_SPACE)) {
+                end--;
             }
+        }
 
-            //wrap
-            bool skip = false;
-
-            if (wrap != AminoText::WRAP_NONE) {
-                bool newLine = false;
-                bool wordWrap = false;
-
-                //check new line
-                if (glyph->codepoint == '\n') {
-                    //next line
-                    newLine = true;
-                    skip = true;
-                } else if (pen->x + kerning + glyph->offset_x + glyph->width > width) {
-                    //have to wrap
-
-                    //next line
-                    newLine = true;
-                    wordWrap = wrap == AminoText::WRAP_WORD;
-
-                    //check space
-                    if (std::iswspace((wchar_t)glyph->codepoint)) {
-                        skip = true;
-                    }
-                }
+        float x = 0;
+        float y = -(float)n * lineHeight; //inverse coordinates
 
-                //check white space
-                if (!skip && (newLine || (lineStart == i && *lineNr > 1)) && std::iswspace(glyph->codepoint)) {
-                    skip = true;
-                }
+        for (size_t i = start; i < end; i++) {
+            amino_text_char_t &ch = shape->chars[i];
 
-                //process
-                if (newLine) {
-                    //line break needed (check which one)
-                    linePos = 0;
-
-                    //check word wrapping
-                    bool wrapped = false;
-                    bool isLastLine = maxLines > 0 && *lineNr == maxLines;
-
-                    if (wordWrap && !skip) {
-                        //find white space
-                        int wrapPos = -1;
-
-                        for (size_t j = i - 1; j > lineStart; j--) {
-                            if (std::iswspace((wchar_t)textUtf32[j])) {
-                                wrapPos = j;
-                                break;
-                            }
-                        }
-
-                        if (wrapPos != -1) {
-                            //calc vertex buffer offset
-                            size_t count = vertex_buffer_size(buffer);
-                            size_t start = count - (i - wrapPos);
-
-                            //printf("remove %i of %i\n", (int)start, (int)count);
-                            //printf("wrapping pos=%d char=%lc start=%d count=%d\n", i, ch, start, count);
-
-                            //remove white space
-                            vertex_buffer_erase(buffer, start);
-                            count--;
-
-                            //update existing glyphs
-                            float xOffset = pen->x; //case: space before
-
-                            for (size_t j = start; j < count; j++) {
-                                //glyph info
-                                ivec4 *item = (ivec4 *)vector_get(buffer->items, j);
-                                size_t vstart = item->x;
-                                size_t vcount = item->y;
-
-                                assert(vcount == 4);
-
-                                //values
-                                vertex_t *vertices = (vertex_t *)vector_get(buffer->vertices, vstart);
-
-                                if (j == start) {
-                                    xOffset = vertices->x - penXStart;
-
-                                    //Note: kerning ignored (after space)
-                                }
-
-                                for (size_t k = 0; k < vcount; k++) {
-                                    vertices->x -= xOffset;
-                                    vertices->y -= font->height; //inverse coordinates
-
-                                    vertices++;
-                                }
-
-                                linePos++;
-                            }
-
-                            pen->x -= xOffset;
-                            *lineW = std::max(*lineW, xOffset);
-                            lineStart = i - linePos;
-                            skip = false;
-
-                            wrapped = true;
-
-                            if (isLastLine) {
-                                //remove characters left
-                                for (size_t j = start; j < count; j++) {
-                                    vertex_buffer_erase(buffer, start);
-                                }
-                            }
-                        }
-                    }
-
-                    //wrap new character
-                    if (!wrapped) {
-                        //wrap at current position
-                        *lineW = std::max(*lineW, pen->x - penXStart);
-                        pen->x = penXStart;
-                        kerning = 0;
-                        lineStart = i;
-                    }
-
-                    //debug
-                    //printf("pen.x=%f lineStart=%lc\n", pen->x, text[lineStart]);
-
-                    if (isLastLine) {
-                        //skip any character
-                        skip = true;
-                        done = true;
-                    } else {
-                        (*lineNr)++;
-                    }
-
-                    pen->y -= font->height; //inverse coordinates
-                }
+            if (i > start) {
+                x += ch.kerning;
+            }
 
-                if (skip) {
-                    lineStart++;
-                }
+            //skip special characters
+            if (ch.codepoint == 0x9d || (ch.flags & CHAR_NEWLINE)) {
+                continue;
             }
 
-            //add glyph
-            if (!skip) {
-                pen->x += kerning;
-
-                //glyph position
-                float x0  = pen->x + glyph->offset_x;
-                float y0  = pen->y + glyph->offset_y;
-                float x1  = x0 + glyph->width;
-                float y1  = y0 - glyph->height;
-                float s0 = glyph->s0;
-                float t0 = glyph->t0;
-                float s1 = glyph->s1;
-                float t1 = glyph->t1;
-                float advance = glyph->advance_x;
-
-                //skip special characters
-                if (glyph->codepoint == 0x9d) {
-                    //hide
-                    x1 = x0;
-                    y1 = y0;
-                    advance = 0;
-                }
+            texture_glyph_t *glyph = (ch.flags & CHAR_MISSING) ? NULL : fontSize->getGlyph(text + ch.offset);
 
-                GLushort indices[6] = { 0,1,2, 0,2,3 };
-                vertex_t vertices[4] = { { x0, y0, 0,  s0, t0 },
-                                         { x0, y1, 0,  s0, t1 },
-                                         { x1, y1, 0,  s1, t1 },
-                                         { x1, y0, 0,  s1, t0 } };
+            if (!glyph) {
+                //not enough space for glyph
 
-                //append
-                vertex_buffer_push_back(buffer, vertices, 4, indices, 6);
-                linePos++;
+                //show error
+                printf("no space for glyph: %lc\n", (wchar_t)ch.codepoint);
 
-                //next
-                pen->x += advance;
+                //continue with glyphs in atlas
+                continue;
             }
-        } else {
-            //not enough space for glyph
-
-            //store
-            uint32_t ch32 = utf8_to_utf32(textPos);
 
-            textUtf32[i] = ch32;
+            //glyph position
+            float x0  = x + glyph->offset_x * scale;
+            float y0  = y + glyph->offset_y * scale;
+            float x1  = x0 + glyph->width * scale;
+            float y1  = y0 - glyph->height * scale;
+            float s0 = glyph->s0;
+            float t0 = glyph->t0;
+            float s1 = glyph->s1;
+            float t1 = glyph->t1;
+
+            //atlas page (stored in z until the batches are created)
+            float page = 0;
+
+            for (size_t j = 0; j < pageCount; j++) {
+                if (aminoFont->getPage(j)->atlas == glyph->atlas) {
+                    page = j;
+                    break;
+                }
+            }
 
-            //show error
-            printf("no space for glyph: %lc\n", (wchar_t)ch32);
+            GLushort indices[6] = { 0,1,2, 0,2,3 };
+            vertex_t vertices[4] = { { x0, y0, page,  s0, t0 },
+                                     { x0, y1, page,  s0, t1 },
+                                     { x1, y1, page,  s1, t1 },
+                                     { x1, y0, page,  s1, t0 } };
 
-            //continue with glyphs in atlas
-        }
+            //append
+            vertex_buffer_push_back(buffer, vertices, 4, indices, 6);
 
-        //check end condition
-        if (done) {
-            break;
+            //next
+            x += ch.advance;
         }
 
-        //next glyph pos
-        size_t charLen = utf8_surrogate_len(textPos);
-
-        lastTextPos = textPos;
-        textPos += charLen;
+        *lineW = std::max(*lineW, x);
     }
-
-    *lineW = std::max(*lineW, pen->x - penXStart);
 }
 
 /**
- * Update the rendered text.
+ * Create a layout of the current text values.
+ *
+ * Returns NULL if there is no font or an identical text was already laid out (mesh is shared).
  *
- * Returns true if texture has changed and must be updated.
+ * Note: called on rendering thread.
  */
-bool AminoText::layoutText() {
-    //printf("layoutText()\n");
-
+amino_text_layout_t *AminoText::createLayout() {
     if (!fontSize) {
         //printf("-> no font\n");
 
-        return false;
+        return NULL;
     }
 
-    if (DEBUG_FONT_UPDATES) {
-        printf("->layoutText() render text (%s)\n", fontSize->font->fontName.c_str());
+    //shared mesh
+    AminoGfx *gfx = getAminoGfx();
+    std::string key = AminoTextMeshCache::getKey(fontSize, propText->value, wrap, propW->value, propMaxLines->value);
+    amino_text_mesh_t *cached = gfx->textMeshes.get(key);
+
+    if (cached) {
+        //pending layouts are outdated
+        gfx->cancelTextLayout(this);
+        useMesh(cached);
+
+        return NULL;
     }
 
-    //Note: FreeType glyph code is not thread-safe, using lock to prevent crash on macOS if multiple AminoGfx instances are active
-    uv_mutex_lock(&freeTypeMutex);
+    amino_text_layout_t *layout = new amino_text_layout_t();
 
-    //create texture (needed in next calls)
-    assert(fontSize->fontTexture);
+    layout->text = this;
+    layout->fontSize = fontSize;
+    layout->str = propText->value;
+    layout->wrap = wrap;
+    layout->width = propW->value;
+    layout->maxLines = propMaxLines->value;
 
-    texture_atlas_t *atlas = fontSize->fontTexture->atlas;
-    bool newTexture;
+    //reuse back buffer
+    layout->buffer = backBuffer;
+    backBuffer = NULL;
 
-    assert(atlas);
-    assert(atlas->depth == 1);
+    layout->lineNr = 1;
+    layout->lineW = 0;
 
-    if (texture.textureId == INVALID_TEXTURE) {
-        //create or use existing texture (for atlas)
-        texture = getAminoGfx()->getAtlasTexture(atlas, true, newTexture);
+    return layout;
+}
+
+/**
+ * Render the glyphs and create the vertices.
+ *
+ * Note: called on layout thread.
+ */
+void AminoText::layoutText(amino_text_layout_t *layout, AminoLineBreaker *breaker) {
+    AminoFontSize *fontSize = layout->fontSize;
 
-        assert(texture.textureId != INVALID_TEXTURE);
+    if (DEBUG_FONT_UPDATES) {
+        printf("->layoutText() render text (%s)\n", fontSize->font->fontName.c_str());
     }
 
+    //Note: FreeType glyph code is not thread-safe, using lock to prevent crash on macOS if multiple AminoGfx instances are active
+    uv_mutex_lock(&freeTypeMutex);
+
+    assert(fontSize->fontTexture);
+
     //render text
-    if (buffer) {
-        vertex_buffer_clear(buffer);
+    if (layout->buffer) {
+        vertex_buffer_clear(layout->buffer);
     } else {
         //vertex & texture coordinates
-        buffer = vertex_buffer_new("pos:3f,texCoord:2f");
+        layout->buffer = vertex_buffer_new("pos:3f,texCoord:2f");
     }
 
-    texture_font_t *fontTexture = fontSize->fontTexture;
-    size_t lastGlyphCount = fontTexture->glyphs->size;
+    AminoFont *font = fontSize->font;
+    unsigned int evictions = font->getEvictions();
 
-    assert(fontTexture);
+    addTextGlyphs(layout->buffer, fontSize, breaker, layout->str, layout->wrap, layout->width, layout->maxLines, &layout->lineNr, &layout->lineW);
 
-    vec2 pen;
+    //check repacked atlas page (glyphs added before might have been moved)
+    if (font->getEvictions() != evictions) {
+        vertex_buffer_clear(layout->buffer);
+
+        addTextGlyphs(layout->buffer, fontSize, breaker, layout->str, layout->wrap, layout->width, layout->maxLines, &layout->lineNr, &layout->lineW);
+    }
 
-    pen.x = 0;
-    pen.y = 0;
+    //draw batches
+    createBatches(layout);
 
-    //Note: consider using async task to avoid performance issues
-    addTextGlyphs(buffer, fontTexture, propText->value.c_str(), &pen, wrap, propW->value, &lineNr, propMaxLines->value, &lineW);
+    uv_mutex_unlock(&freeTypeMutex);
 
     if (DEBUG_BASE) {
         printf("-> layoutText() done\n");
     }
+}
 
-    size_t newGlyphCount = fontTexture->glyphs->size;
-    bool glyphsChanged = lastGlyphCount != newGlyphCount || (newTexture && newGlyphCount > 0);
+/**
+ * Group the glyphs by atlas page.
+ *
+ * Note: freeTypeMutex must be locked.
+ */
+void AminoText::createBatches(amino_text_layout_t *layout) {
+    vertex_buffer_t *buffer = layout->buffer;
+    AminoFont *font = layout->fontSize->font;
+    size_t itemCount = vector_size(buffer->items);
+    size_t pageCount = font->getPageCount();
+    std::vector<GLushort> indices(vector_size(buffer->indices));
+    size_t pos = 0;
 
-    uv_mutex_unlock(&freeTypeMutex);
+    layout->batches.clear();
 
-    //debug
-    //printf("glyphs changed: %i\n", glyphsChanged);
+    for (size_t page = 0; page < pageCount; page++) {
+        size_t start = pos;
+
+        for (size_t i = 0; i < itemCount; i++) {
+            ivec4 *item = (ivec4 *)vector_get(buffer->items, i);
+            vertex_t *vertices = (vertex_t *)vector_get(buffer->vertices, item->vstart);
+
+            if ((size_t)vertices->z != page) {
+                continue;
+            }
+
+            memcpy(&indices[pos], vector_get(buffer->indices, item->istart), item->icount * sizeof(GLushort));
+            pos += item->icount;
+        }
+
+        if (pos == start) {
+            continue;
+        }
+
+        //Note: texture is assigned on rendering thread
+        amino_text_batch_t batch;
+
+        batch.page = font->getPage(page);
+        batch.generation = batch.page->generation;
+        batch.textureId = INVALID_TEXTURE;
+        batch.start = start;
+        batch.count = pos - start;
+
+        layout->batches.push_back(batch);
+    }
+
+    //indices ordered by page
+    if (pos > 0) {
+        memcpy(vector_get(buffer->indices, 0), indices.data(), pos * sizeof(GLushort));
+    }
+
+    //reset z
+    size_t vertexCount = vector_size(buffer->vertices);
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        ((vertex_t *)vector_get(buffer->vertices, i))->z = 0;
+    }
+
+    //Note: buffer is still dirty (uploaded before rendering)
+}
+
+/**
+ * Show the new layout.
+ *
+ * The result is shared with identical texts. The vertex buffer of the previous mesh is used by the next layout.
+ *
+ * Note: called on rendering thread, freeTypeMutex must be locked.
+ */
+void AminoText::applyLayout(amino_text_layout_t *layout) {
+    if (layout->fontSize != fontSize) {
+        //font changed (newer layout pending)
+        return;
+    }
+
+    //create or use existing textures (for atlas pages)
+    for (auto &batch : layout->batches) {
+        bool newTexture;
+
+        batch.textureId = getAminoGfx()->getAtlasTexture(batch.page, true, newTexture).textureId;
+
+        assert(batch.textureId != INVALID_TEXTURE);
+    }
+
+    //share the mesh (or use the one of an identical text laid out meanwhile)
+    std::string key = AminoTextMeshCache::getKey(layout->fontSize, layout->str, layout->wrap, layout->width, layout->maxLines);
+
+    useMesh(getAminoGfx()->textMeshes.add(key, layout));
+
+    //keep unused buffer
+    if (layout->buffer && !backBuffer) {
+        backBuffer = layout->buffer;
+        layout->buffer = NULL;
+    }
+}
+
+/**
+ * Show a mesh (releases the previous one).
+ *
+ * Note: called on rendering thread.
+ */
+void AminoText::useMesh(amino_text_mesh_t *newMesh) {
+    releaseMesh(true);
+
+    mesh = newMesh;
+}
+
+/**
+ * Release the current mesh.
+ *
+ * The buffer of an unused mesh is deleted (or kept as back buffer on the rendering thread).
+ */
+void AminoText::releaseMesh(bool renderThread) {
+    if (!mesh) {
+        return;
+    }
+
+    amino_text_mesh_t *oldMesh = mesh;
+
+    mesh = NULL;
+
+    assert(eventHandler);
+
+    if (!getAminoGfx()->textMeshes.release(oldMesh)) {
+        //still used by other texts
+        return;
+    }
+
+    if (renderThread) {
+        if (backBuffer) {
+            vertex_buffer_delete(oldMesh->buffer);
+        } else {
+            //reuse
+            backBuffer = oldMesh->buffer;
+        }
+    } else {
+        deleteBuffer(oldMesh->buffer);
+    }
 
-    return glyphsChanged;
+    delete oldMesh;
 }
 
 uv_mutex_t AminoText::freeTypeMutex;
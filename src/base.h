@@ -6,6 +6,7 @@
 #include "base_weak.h"
 #include "fonts.h"
 #include "images.h"
+#include "animations.h"
 
 #include <uv.h>
 #include "shaders.h"
@@ -13,6 +14,7 @@
 #include <stdio.h>
 #include <vector>
 #include <stack>
+#include <deque>
 #include <stdlib.h>
 #include <string>
 #include <map>
@@ -50,6 +52,7 @@ public:
     static NAN_MODULE_INIT(InitClasses);
 
     bool addAnimation(AminoAnim *anim);
+    void startAnimation(AminoAnim *anim);
     void removeAnimation(AminoAnim *anim);
 
     bool deleteTextureAsync(GLuint textureId);
@@ -58,9 +61,20 @@ public:
 
     //text
     void textUpdateNeeded(AminoText *text);
-    amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    void cancelTextLayout(AminoText *text);
+    AminoTextMeshCache textMeshes; //shared text vertex buffers
+    amino_atlas_t getAtlasTexture(amino_font_page_t *page, bool createIfMissing, bool &newTexture);
     void notifyTextureCreated(int count);
-    static void updateAtlasTextures(texture_atlas_t *atlas);
+    static void updateAtlasTextures(amino_atlas_update_t *update);
+
+    //texture uploads
+    int getTextureTileSize();
+    void addTextureUpload(amino_texture_upload_t *upload);
+    void addBufferAllocations(int count);
+
+    //pixel surfaces
+    void addSurface(AminoTexture *texture);
+    void removeSurface(AminoTexture *texture);
 
     //video
     virtual AminoVideoPlayer *createVideoPlayer(AminoTexture *texture, AminoVideo *video) = 0;
@@ -86,16 +100,29 @@ protected:
     int rendererErrors = 0;
     int textureCount = 0;
 
+    //texture uploads
+    GLint maxTextureSize = 0;
+    int textureTileSize = 0; //0: maximum texture size
+    AminoTextureUploader textureUploader;
+
+    //pixel surfaces
+    std::vector<AminoTexture *> surfaces;
+    pthread_mutex_t surfacesLock;
+
+    void updateSurfaces();
+
     //instance
     void addInstance();
     void removeInstance();
 
     //text
     std::vector<AminoText *> textUpdates;
+    AminoTextLayouter *textLayouter = NULL;
 
     void updateTextNodes();
-    virtual void atlasTextureHasChanged(texture_atlas_t *atlas);
-    void updateAtlasTexture(texture_atlas_t *atlas);
+    virtual void atlasTextureHasChanged(amino_atlas_update_t *update);
+    void atlasTextureHasChangedDone(JSCallbackUpdate *update);
+    void updateAtlasTexture(amino_atlas_update_t *update);
     void updateAtlasTextureHandler(AsyncValueUpdate *update, int state);
 
     //performance (FPS)
@@ -137,6 +164,7 @@ protected:
 
     //animations
     std::vector<AminoAnim *> animations;
+    AminoAnimEngine animEngine;
     pthread_mutex_t animLock; //Note: short cycles
 
     //creation
@@ -197,6 +225,7 @@ private:
     static NAN_METHOD(UpdatePerspective);
     static NAN_METHOD(GetStats);
     static NAN_METHOD(GetTime);
+    static NAN_METHOD(CheckMatrixPerformance);
 
     //animation
     void clearAnimations();
@@ -249,6 +278,12 @@ public:
     //visibility
     BooleanProperty *propVisible;
 
+    //cached matrices (rendering thread)
+    GLfloat localMatrix[16];
+    GLfloat worldMatrix[16];
+    bool localMatrixDirty = true;
+    bool worldMatrixDirty = true;
+
     AminoNode(std::string name, int type): AminoJSObject(name), type(type) {
         //empty
     }
@@ -306,6 +341,111 @@ public:
         //printf("Destroyed node: %i\n", type);
     }
 
+    /**
+     * Handle async property updates.
+     */
+    void handleAsyncUpdate(AsyncPropertyUpdate *update) override {
+        //default: set value
+        AminoJSObject::handleAsyncUpdate(update);
+
+        //check transformation
+        propertyUpdated(update->property);
+    }
+
+    /**
+     * Property value has changed (on rendering thread).
+     */
+    void propertyUpdated(AnyProperty *property) {
+        if (isTransformProperty(property)) {
+            invalidateLocalMatrix();
+        }
+    }
+
+    /**
+     * Check if the property is used by the local matrix.
+     */
+    bool isTransformProperty(AnyProperty *property) {
+        return property == propX || property == propY || property == propZ ||
+            property == propScaleX || property == propScaleY ||
+            property == propRotateX || property == propRotateY || property == propRotateZ ||
+            property == propOriginX || property == propOriginY ||
+            property == propW || property == propH;
+    }
+
+    /**
+     * Local matrix has to be recalculated.
+     */
+    void invalidateLocalMatrix() {
+        localMatrixDirty = true;
+        invalidateWorldMatrix();
+    }
+
+    /**
+     * World matrix has to be recalculated.
+     *
+     * Note: a dirty node has only dirty children.
+     */
+    virtual void invalidateWorldMatrix() {
+        worldMatrixDirty = true;
+    }
+
+    /**
+     * Calculate the local matrix.
+     *
+     * Order: 1) origin, 2) translate, 3) scale, 4) rotate (x, y, z), 5) inverse origin
+     */
+    void updateLocalMatrix() {
+        GLfloat m[16];
+        GLfloat temp[16];
+
+        //origin
+        GLfloat originX = 0;
+        GLfloat originY = 0;
+
+        if (propW) {
+            originX = propW->value * propOriginX->value;
+            originY = propH->value * propOriginY->value;
+        }
+
+        //translate
+        make_trans_matrix(originX + propX->value, originY + propY->value, propZ->value, localMatrix);
+
+        //scale
+        if (propScaleX->value != 1 || propScaleY->value != 1) {
+            make_scale_matrix(propScaleX->value, propScaleY->value, 1.0, m);
+            mul_matrix(temp, localMatrix, m);
+            copy_matrix(localMatrix, temp);
+        }
+
+        //rotate
+        if (propRotateX->value != 0) {
+            make_x_rot_matrix(propRotateX->value, m);
+            mul_matrix(temp, localMatrix, m);
+            copy_matrix(localMatrix, temp);
+        }
+
+        if (propRotateY->value != 0) {
+            make_y_rot_matrix(propRotateY->value, m);
+            mul_matrix(temp, localMatrix, m);
+            copy_matrix(localMatrix, temp);
+        }
+
+        if (propRotateZ->value != 0) {
+            make_z_rot_matrix(propRotateZ->value, m);
+            mul_matrix(temp, localMatrix, m);
+            copy_matrix(localMatrix, temp);
+        }
+
+        //inverse origin
+        if (originX != 0 || originY != 0) {
+            make_trans_matrix(-originX, -originY, 0, m);
+            mul_matrix(temp, localMatrix, m);
+            copy_matrix(localMatrix, temp);
+        }
+
+        localMatrixDirty = false;
+    }
+
     /**
      * Get AminoGfx instance.
      */
@@ -372,7 +512,8 @@ public:
     //font
     ObjectProperty *propFont;
     AminoFontSize *fontSize = NULL;
-    vertex_buffer_t *buffer = NULL;
+    amino_text_mesh_t *mesh = NULL; //front buffer (rendered, shared by identical texts)
+    vertex_buffer_t *backBuffer = NULL; //used by next layout
 
     //alignment
     Utf8Property *propAlign;
@@ -382,8 +523,6 @@ public:
 
     //lines
     Int32Property *propMaxLines;
-    int lineNr = 1;
-    float lineW = 0;
 
     //mutex
     static uv_mutex_t freeTypeMutex;
@@ -446,29 +585,18 @@ public:
      * Free buffers.
      */
     void destroyAminoText() {
-        if (buffer) {
-            if (eventHandler) {
-                if (getAminoGfx()->deleteVertexBufferAsync(buffer)) {
-                    buffer = NULL;
-                }
-            }
-
-            if (buffer) {
-                //prevent OpenGL calls(on wrong thread)
-                buffer->vertices_id = 0;
-                buffer->indices_id = 0;
-
-                vertex_buffer_delete(buffer);
-
-                buffer = NULL;
-            }
+        //running layout
+        if (eventHandler) {
+            getAminoGfx()->cancelTextLayout(this);
         }
 
+        releaseMesh(false);
+        deleteBuffer(backBuffer);
+
         //release object values
         propFont->destroy();
 
         fontSize = NULL;
-        texture.textureId = INVALID_TEXTURE;
     }
 
     /**
@@ -534,7 +662,7 @@ public:
         //printf("AminoText::handleAsyncUpdate()\n");
 
         //default: set value
-        AminoJSObject::handleAsyncUpdate(update);
+        AminoNode::handleAsyncUpdate(update);
 
         //check font updates
         AnyProperty *property = update->property;
@@ -614,7 +742,7 @@ public:
 
             //new font
             fontSize = fs;
-            texture.textureId = INVALID_TEXTURE; //reset texture
+            releaseMesh(true); //reset textures
 
             //debug
             //printf("-> use font: %s\n", fs->font->fontName.c_str());
@@ -630,21 +758,22 @@ public:
     /**
      * Update the rendered text.
      */
-    bool layoutText();
+    amino_text_layout_t *createLayout();
+    static void layoutText(amino_text_layout_t *layout, AminoLineBreaker *breaker);
+    void applyLayout(amino_text_layout_t *layout);
 
     /**
-     * Create or update a font texture.
+     * Update the font textures.
      */
-    void updateTexture();
-    static void updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas);
+    static size_t updateTexture(AminoGfx *gfx, AminoFont *font, std::vector<amino_atlas_update_t> &updates);
+    static size_t updateTextureFromAtlas(GLuint textureId, texture_atlas_t *atlas, amino_atlas_update_t *update, int *allocations = NULL);
 
     /**
-     * Get font texture.
+     * Check if atlas pages were repacked.
      */
-    GLuint getTextureId();
+    bool hasValidBatches();
 
 private:
-    amino_atlas_t texture = { INVALID_TEXTURE };
 
     /**
      * JS object construction.
@@ -653,7 +782,35 @@ private:
         AminoJSObject::createInstance(info, getFactory());
     }
 
-    static void addTextGlyphs(vertex_buffer_t *buffer, texture_font_t *font, const char *text, vec2 *pen, int wrap, int width, int *lineNr, int maxLines, float *lineW);
+    static void addTextGlyphs(vertex_buffer_t *buffer, AminoFontSize *fontSize, AminoLineBreaker *breaker, const std::string &str, int wrap, int width, int maxLines, int *lineNr, float *lineW);
+    static void createBatches(amino_text_layout_t *layout);
+
+    void useMesh(amino_text_mesh_t *newMesh);
+    void releaseMesh(bool renderThread);
+
+    /**
+     * Free a vertex buffer.
+     */
+    void deleteBuffer(vertex_buffer_t *&buf) {
+        if (!buf) {
+            return;
+        }
+
+        if (eventHandler) {
+            if (getAminoGfx()->deleteVertexBufferAsync(buf)) {
+                buf = NULL;
+                return;
+            }
+        }
+
+        //prevent OpenGL calls(on wrong thread)
+        buf->vertices_id = 0;
+        buf->indices_id = 0;
+
+        vertex_buffer_delete(buf);
+
+        buf = NULL;
+    }
 };
 
 /**
@@ -671,6 +828,7 @@ public:
  */
 class AminoAnim : public AminoJSObject {
 private:
+    AminoNode *node = NULL;
     AnyProperty *prop;
 
     bool started = false;
@@ -682,8 +840,8 @@ private:
     int count;
     float duration;
     bool autoreverse;
-    int direction = FORWARD;
     int timeFunc = TF_CUBIC_IN_OUT;
+    AminoAnimCurve *curve = NULL;
     Nan::Callback *then = NULL;
 
     //start pos
@@ -694,20 +852,26 @@ private:
     double refTime;
     bool hasRefTime = false;
 
-    double startTime = 0;
-    double lastTime  = 0;
-    double pauseTime = 0;
-
-    static const int FORWARD  = 1;
-    static const int BACKWARD = 2;
+    //engine
+    int trackIndex = -1;
 
     static const int FOREVER = -1;
 
+    friend class AminoAnimEngine;
+
 public:
-    static const int TF_LINEAR       = 0x0;
-    static const int TF_CUBIC_IN     = 0x1;
-    static const int TF_CUBIC_OUT    = 0x2;
-    static const int TF_CUBIC_IN_OUT = 0x3;
+    static const int TF_LINEAR         = 0x0;
+    static const int TF_CUBIC_IN       = 0x1;
+    static const int TF_CUBIC_OUT      = 0x2;
+    static const int TF_CUBIC_IN_OUT   = 0x3;
+    static const int TF_BEZIER         = 0x4;
+    static const int TF_ELASTIC_IN     = 0x5;
+    static const int TF_ELASTIC_OUT    = 0x6;
+    static const int TF_ELASTIC_IN_OUT = 0x7;
+    static const int TF_BOUNCE_IN      = 0x8;
+    static const int TF_BOUNCE_OUT     = 0x9;
+    static const int TF_BOUNCE_IN_OUT  = 0xA;
+    static const int TF_SPRING         = 0xB;
 
     AminoAnim(): AminoJSObject(getFactory()->name) {
         //empty
@@ -747,6 +911,7 @@ public:
 
         //bind to queue (retains AminoGfx reference)
         this->setEventHandler(obj);
+        this->node = node;
         this->prop = prop;
 
         //retain property
@@ -778,12 +943,18 @@ public:
         if (prop) {
             prop->release();
             prop = NULL;
+            node = NULL;
         }
 
         if (then) {
             delete then;
             then = NULL;
         }
+
+        if (curve) {
+            delete curve;
+            curve = NULL;
+        }
     }
 
     //creation
@@ -862,10 +1033,31 @@ public:
             timeFunc = TF_CUBIC_OUT;
         } else if (tf == "cubicInOut") {
             timeFunc = TF_CUBIC_IN_OUT;
+        } else if (tf == "bezier") {
+            timeFunc = TF_BEZIER;
+        } else if (tf == "elasticIn") {
+            timeFunc = TF_ELASTIC_IN;
+        } else if (tf == "elasticOut") {
+            timeFunc = TF_ELASTIC_OUT;
+        } else if (tf == "elasticInOut") {
+            timeFunc = TF_ELASTIC_IN_OUT;
+        } else if (tf == "bounceIn") {
+            timeFunc = TF_BOUNCE_IN;
+        } else if (tf == "bounceOut") {
+            timeFunc = TF_BOUNCE_OUT;
+        } else if (tf == "bounceInOut") {
+            timeFunc = TF_BOUNCE_IN_OUT;
+        } else if (tf == "spring") {
+            timeFunc = TF_SPRING;
         } else {
             timeFunc = TF_LINEAR;
         }
 
+        //curve
+        if (!parseCurve(data)) {
+            return;
+        }
+
         //then
         v8::MaybeLocal<v8::Value> maybeThen = Nan::Get(data, Nan::New<v8::String>("then").ToLocalChecked());
 
@@ -905,74 +1097,105 @@ public:
 
         //start
         started = true;
-    }
 
-    /**
-     * Cubic-in time function.
-     */
-    static float cubicIn(float t) {
-        return pow(t, 3);
+        if (eventHandler) {
+            (static_cast<AminoGfx *>(eventHandler))->startAnimation(this);
+        }
     }
 
     /**
-     * Cubic-out time function.
+     * Get a number array.
+     *
+     * @return false if not an array of numbers
      */
-    static float cubicOut(float t) {
-        return 1 - cubicIn(1 - t);
-    }
+    static bool toFloatArray(v8::Local<v8::Value> value, std::vector<float> &res) {
+        if (!value->IsArray()) {
+            return false;
+        }
 
-    /**
-     * Cubic-in-out time function.
-     */
-    static float cubicInOut(float t) {
-        if (t < 0.5) {
-            return cubicIn(t * 2.0) / 2.0;
+        v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(value);
+        uint32_t len = arr->Length();
+
+        for (uint32_t i = 0; i < len; i++) {
+            v8::Local<v8::Value> item = Nan::Get(arr, i).ToLocalChecked();
+
+            if (!item->IsNumber()) {
+                return false;
+            }
+
+            res.push_back(item->NumberValue());
         }
 
-        return 1 - cubicIn((1 - t) * 2) / 2;
+        return true;
     }
 
     /**
-     * Call time function.
-     */
-    float timeToPosition(float t) {
-        float t2 = 0;
+     * Parse cubic-bezier, spring and keyframe parameters.
+     *
+     * @return false on error (exception thrown)
+     */
+    bool parseCurve(v8::Local<v8::Object> &data) {
+        v8::Local<v8::Value> bezierValue = Nan::Get(data, Nan::New<v8::String>("bezier").ToLocalChecked()).ToLocalChecked();
+        v8::Local<v8::Value> springValue = Nan::Get(data, Nan::New<v8::String>("spring").ToLocalChecked()).ToLocalChecked();
+        v8::Local<v8::Value> keyframesValue = Nan::Get(data, Nan::New<v8::String>("keyframes").ToLocalChecked()).ToLocalChecked();
+        v8::Local<v8::Value> keyTimesValue = Nan::Get(data, Nan::New<v8::String>("keyTimes").ToLocalChecked()).ToLocalChecked();
+        bool hasKeyframes = keyframesValue->IsArray();
+
+        //simple curves are handled by the engine directly
+        if (timeFunc < TF_BEZIER && !hasKeyframes) {
+            return true;
+        }
 
-        switch (timeFunc) {
-            case TF_CUBIC_IN:
-                t2 = cubicIn(t);
-                break;
+        AminoAnimCurve *curve = new AminoAnimCurve();
 
-            case TF_CUBIC_OUT:
-                t2 = cubicOut(t);
-                break;
+        // 1) cubic-bezier
+        if (timeFunc == TF_BEZIER) {
+            std::vector<float> points;
 
-            case TF_CUBIC_IN_OUT:
-                t2 = cubicInOut(t);
-                break;
+            if (bezierValue->IsNull() || bezierValue->IsUndefined()) {
+                //CSS ease
+                points = { 0.25f, 0.1f, 0.25f, 1.f };
+            } else if (!toFloatArray(bezierValue, points) || points.size() != 4) {
+                delete curve;
+                Nan::ThrowTypeError("bezier needs four control point values");
+                return false;
+            }
 
-            case TF_LINEAR:
-            default:
-                t2 = t;
-                break;
+            curve->setBezier(points[0], points[1], points[2], points[3]);
         }
 
-        return start + (end - start) * t2;
-    }
+        // 2) spring
+        if (timeFunc == TF_SPRING && !springValue->IsNull() && !springValue->IsUndefined()) {
+            std::vector<float> params;
 
-    /**
-     * Toggle animation direction.
-     *
-     * Note: works only if autoreverse is enabled
-     */
-    void toggle() {
-        if (autoreverse) {
-            if (direction == FORWARD) {
-                direction = BACKWARD;
-            } else {
-                direction = FORWARD;
+            if (!toFloatArray(springValue, params) || params.size() != 2 || params[0] <= 0) {
+                delete curve;
+                Nan::ThrowTypeError("spring needs damping and frequency");
+                return false;
             }
+
+            curve->springDamping = params[0];
+            curve->springFrequency = params[1];
         }
+
+        // 3) keyframes
+        if (hasKeyframes) {
+            std::vector<float> values;
+            std::vector<float> times;
+
+            if (!toFloatArray(keyframesValue, values) || (!keyTimesValue->IsNull() && !keyTimesValue->IsUndefined() && !toFloatArray(keyTimesValue, times)) || !curve->setKeyframes(values, times)) {
+                delete curve;
+                Nan::ThrowTypeError("invalid keyframes");
+                return false;
+            }
+
+            start = values.front();
+            end = values.back();
+        }
+
+        this->curve = curve;
+
+        return true;
     }
 
     /**
@@ -988,6 +1211,9 @@ public:
         FloatProperty *floatProp = static_cast<FloatProperty *>(prop);
 
         floatProp->setValue(value);
+
+        //matrix cache
+        node->propertyUpdated(prop);
     }
 
     //TODO pause
@@ -1069,145 +1295,6 @@ public:
     void callStop(JSCallbackUpdate *update) {
         stop();
     }
-
-    /**
-     * Next animation step.
-     */
-    void update(double currentTime) {
-        //check active
-    	if (!started || ended) {
-            return;
-        }
-
-        //check remaining loops
-        if (count == 0) {
-            endAnimation();
-            return;
-        }
-
-        //handle first start
-        if (startTime == 0) {
-            startTime = currentTime;
-            lastTime = currentTime;
-            pauseTime = 0;
-
-            //sync with reference time
-            if (hasRefTime) {
-                double diff = currentTime - refTime;
-
-                if (diff < 0) {
-                    //in future: wait
-                    startTime = 0;
-                    lastTime = 0;
-                    return;
-                }
-
-                //check passed iterations
-                int cycles = diff / duration;
-
-                if (cycles > 0) {
-                    //check end of animation
-                    if (count != FOREVER) {
-                        if (cycles >= count) {
-                            //end reached
-                            endAnimation();
-                            return;
-                        }
-
-                        //reduce
-                        count -= cycles;
-                    }
-
-                    diff -= cycles * duration;
-
-                    //check direction
-                    if (cycles & 0x1) {
-                        toggle();
-                    }
-                }
-
-                //shift start time
-                startTime -= diff;
-            }
-
-            //adjust animation position
-            if (hasZeroPos && zeroPos > start && zeroPos <= end) {
-                float pos = (zeroPos - start) / (end - start);
-
-                //shift start time
-                startTime -= pos * duration;
-            }
-        }
-
-        //validate time (should never happen if time is monotonic)
-        if (currentTime < startTime) {
-            //smooth animation
-            startTime = currentTime - (lastTime - startTime);
-            lastTime = currentTime;
-        }
-
-        //process
-        double timePassed = currentTime - startTime;
-        float t = timePassed / duration;
-
-        lastTime = currentTime;
-
-        if (t > 1) {
-            //end reached
-            bool doToggle = false;
-
-            if (count == FOREVER) {
-                doToggle = true;
-            }
-
-            if (count > 0) {
-                count--;
-
-                if (count > 0) {
-                    doToggle = true;
-                } else {
-                    endAnimation();
-                    return;
-                }
-            }
-
-            if (doToggle) {
-                //next cycle
-
-                //calc exact time offset
-                double overTime = timePassed - duration;
-
-                if (overTime > duration) {
-                    int times = overTime / duration;
-
-                    overTime -= times * duration;
-
-                    if (times & 0x1) {
-                        doToggle = false;
-                    }
-                }
-
-                startTime = currentTime - overTime;
-                t = overTime / duration;
-
-                if (doToggle) {
-                    toggle();
-                }
-            } else {
-                //end position
-                t = 1;
-            }
-        }
-
-        if (direction == BACKWARD) {
-            t = 1 - t;
-        }
-
-        //apply time function
-        float value = timeToPosition(t);
-
-        applyValue(value);
-    }
 };
 
 /**
@@ -1388,7 +1475,7 @@ public:
      */
     void handleAsyncUpdate(AsyncPropertyUpdate *update) override {
         //default: set value
-        AminoJSObject::handleAsyncUpdate(update);
+        AminoNode::handleAsyncUpdate(update);
 
         //check property updates
         AnyProperty *property = update->property;
@@ -1655,7 +1742,7 @@ public:
      */
     void handleAsyncUpdate(AsyncPropertyUpdate *update) override {
         //default: set value
-        AminoJSObject::handleAsyncUpdate(update);
+        AminoNode::handleAsyncUpdate(update);
 
         //check array updates
         AnyProperty *property = update->property;
@@ -1738,6 +1825,22 @@ public:
         children.clear();
     }
 
+    /**
+     * World matrix has to be recalculated (including all children).
+     */
+    void invalidateWorldMatrix() override {
+        if (worldMatrixDirty) {
+            //children are already dirty
+            return;
+        }
+
+        AminoNode::invalidateWorldMatrix();
+
+        for (AminoNode *child : children) {
+            child->invalidateWorldMatrix();
+        }
+    }
+
     void setup() override {
         AminoNode::setup();
 
@@ -1828,6 +1931,9 @@ private:
 
         children.push_back(node);
 
+        //new parent matrix
+        node->invalidateWorldMatrix();
+
         //debug (provoke crash to get stack trace)
         if (DEBUG_CRASH) {
             int *foo = (int *)1;
@@ -1881,6 +1987,9 @@ private:
             }
 
             children.insert(children.begin() + data->pos, data->child);
+
+            //new parent matrix
+            data->child->invalidateWorldMatrix();
         } else if (state == AsyncValueUpdate::STATE_DELETE) {
             //on main thread
             group_insert_t *data = (group_insert_t *)update->data;
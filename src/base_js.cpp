@@ -1,6 +1,7 @@
 #include "base_js.h"
 
 #include <sstream>
+#include <algorithm>
 
 #define DEBUG_ASYNC false
 #define DEBUG_JS_INSTANCES false
@@ -814,10 +815,35 @@ std::string* AminoJSObject::toNewString(v8::Local<v8::Value> &value) {
     return new std::string(*str);
 }
 
+/**
+ * Get a scalar async data instance.
+ *
+ * Note: has to be called on main thread.
+ */
+AminoJSObject::AsyncScalar* AminoJSObject::newAsyncScalar() {
+    AsyncScalar *res = asyncScalarPool.get();
+
+    if (!res) {
+        res = new AsyncScalar;
+    }
+
+    return res;
+}
+
+/**
+ * Recycle a scalar async data instance.
+ *
+ * Note: has to be called on main thread.
+ */
+void AminoJSObject::deleteAsyncScalar(void *data) {
+    asyncScalarPool.put((AsyncScalar *)data);
+}
+
 //static initializers
 int AminoJSObject::activeInstances = 0;
 int AminoJSObject::totalInstances = 0;
 std::vector<AminoJSObject *> AminoJSObject::jsInstances;
+AminoPool<AminoJSObject::AsyncScalar> AminoJSObject::asyncScalarPool(ASYNC_POOL_SIZE);
 
 //
 // AminoJSObject::AnyProperty
@@ -908,9 +934,9 @@ void* AminoJSObject::FloatProperty::getAsyncData(v8::Local<v8::Value> &value, bo
     if (value->IsNumber()) {
         //double to float
         float f = value->NumberValue();
-        float *res = new float;
+        AsyncScalar *res = newAsyncScalar();
 
-        *res = f;
+        res->f = f;
         valid = true;
 
         return res;
@@ -930,7 +956,7 @@ void* AminoJSObject::FloatProperty::getAsyncData(v8::Local<v8::Value> &value, bo
  */
 void AminoJSObject::FloatProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
     if (data) {
-        value = *((float *)data);
+        value = ((AsyncScalar *)data)->f;
     }
 }
 
@@ -939,7 +965,7 @@ void AminoJSObject::FloatProperty::setAsyncData(AsyncPropertyUpdate *update, voi
  */
 void AminoJSObject::FloatProperty::freeAsyncData(void *data) {
     if (data) {
-        delete (float *)data;
+        deleteAsyncScalar(data);
     }
 }
 
@@ -1281,9 +1307,9 @@ void* AminoJSObject::Int32Property::getAsyncData(v8::Local<v8::Value> &value, bo
     if (value->IsNumber()) {
         //UInt32
         int i = value->Int32Value();
-        int *res = new int;
+        AsyncScalar *res = newAsyncScalar();
 
-        *res = i;
+        res->i = i;
         valid = true;
 
         return res;
@@ -1303,7 +1329,7 @@ void* AminoJSObject::Int32Property::getAsyncData(v8::Local<v8::Value> &value, bo
  */
 void AminoJSObject::Int32Property::setAsyncData(AsyncPropertyUpdate *update, void *data) {
     if (data) {
-        value = *((int *)data);
+        value = ((AsyncScalar *)data)->i;
     }
 }
 
@@ -1312,7 +1338,7 @@ void AminoJSObject::Int32Property::setAsyncData(AsyncPropertyUpdate *update, voi
  */
 void AminoJSObject::Int32Property::freeAsyncData(void *data) {
     if (data) {
-        delete (int *)data;
+        deleteAsyncScalar(data);
     }
 }
 
@@ -1370,9 +1396,9 @@ void* AminoJSObject::UInt32Property::getAsyncData(v8::Local<v8::Value> &value, b
     if (value->IsNumber()) {
         //UInt32
         unsigned int ui = value->Uint32Value();
-        unsigned int *res = new unsigned int;
+        AsyncScalar *res = newAsyncScalar();
 
-        *res = ui;
+        res->u = ui;
         valid = true;
 
         return res;
@@ -1392,7 +1418,7 @@ void* AminoJSObject::UInt32Property::getAsyncData(v8::Local<v8::Value> &value, b
  */
 void AminoJSObject::UInt32Property::setAsyncData(AsyncPropertyUpdate *update, void *data) {
     if (data) {
-        value = *((unsigned int *)data);
+        value = ((AsyncScalar *)data)->u;
     }
 }
 
@@ -1401,7 +1427,7 @@ void AminoJSObject::UInt32Property::setAsyncData(AsyncPropertyUpdate *update, vo
  */
 void AminoJSObject::UInt32Property::freeAsyncData(void *data) {
     if (data) {
-        delete (unsigned int *)data;
+        deleteAsyncScalar(data);
     }
 }
 
@@ -1458,9 +1484,9 @@ v8::Local<v8::Value> AminoJSObject::BooleanProperty::toValue() {
 void* AminoJSObject::BooleanProperty::getAsyncData(v8::Local<v8::Value> &value, bool &valid) {
     if (value->IsBoolean()) {
         bool b = value->BooleanValue();
-        bool *res = new bool;
+        AsyncScalar *res = newAsyncScalar();
 
-        *res = b;
+        res->b = b;
         valid = true;
 
         return res;
@@ -1480,7 +1506,7 @@ void* AminoJSObject::BooleanProperty::getAsyncData(v8::Local<v8::Value> &value,
  */
 void AminoJSObject::BooleanProperty::setAsyncData(AsyncPropertyUpdate *update, void *data) {
     if (data) {
-        value = *((bool *)data);
+        value = ((AsyncScalar *)data)->b;
     }
 }
 
@@ -1489,7 +1515,7 @@ void AminoJSObject::BooleanProperty::setAsyncData(AsyncPropertyUpdate *update, v
  */
 void AminoJSObject::BooleanProperty::freeAsyncData(void *data) {
     if (data) {
-        delete (bool *)data;
+        deleteAsyncScalar(data);
     }
 }
 
@@ -1818,10 +1844,20 @@ AminoJSObject::JSPropertyUpdate::~JSPropertyUpdate() {
     //empty
 }
 
+/**
+ * Set the property (recycled instance).
+ */
+void AminoJSObject::JSPropertyUpdate::init(AnyProperty *property) {
+    this->property = property;
+}
+
 /**
  * Update JS property on main thread.
  */
 void AminoJSObject::JSPropertyUpdate::apply() {
+    //later changes need a new update
+    property->jsUpdatePending.store(false);
+
     v8::Local<v8::Value> value = property->toValue();
 
     property->obj->updateProperty(property->name, value);
@@ -1851,27 +1887,9 @@ void AminoJSObject::JSCallbackUpdate::apply() {
 // AminoJSEventObject
 //
 
-AminoJSEventObject::AminoJSEventObject(std::string name): AminoJSObject(name) {
-    asyncUpdates = new std::vector<AnyAsyncUpdate *>();
-    asyncDeletes = new std::vector<AnyAsyncUpdate *>();
-    jsUpdates = new std::vector<AnyAsyncUpdate *>();
-
+AminoJSEventObject::AminoJSEventObject(std::string name): AminoJSObject(name), propertyUpdatePool(ASYNC_POOL_SIZE), jsPropertyUpdatePool(ASYNC_POOL_SIZE) {
     //main thread
     mainThread = uv_thread_self();
-
-    //recursive mutex needed
-    pthread_mutexattr_t attr;
-
-    int res = pthread_mutexattr_init(&attr);
-
-    assert(res == 0);
-
-    res = pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-    assert(res == 0);
-
-    // asyncLock
-    res = pthread_mutex_init(&asyncLock, &attr);
-    assert(res == 0);
 }
 
 AminoJSEventObject::~AminoJSEventObject() {
@@ -1879,20 +1897,20 @@ AminoJSEventObject::~AminoJSEventObject() {
 
     //JS updates
     handleJSUpdates();
-    delete jsUpdates;
 
     //asyncUpdates
     clearAsyncQueue();
-    delete asyncUpdates;
 
     //asyncDeletes
     handleAsyncDeletes();
-    delete asyncDeletes;
 
-    //mutex
-    int res = pthread_mutex_destroy(&asyncLock);
+    //recycled JS updates (not moved to pool yet)
+    std::vector<AnyAsyncUpdate *> items;
+    std::size_t count = jsPropertyUpdatesRecycled.drain(items);
 
-    assert(res == 0);
+    for (std::size_t i = 0; i < count; i++) {
+        delete items[i];
+    }
 }
 
 /**
@@ -1908,25 +1926,14 @@ AminoJSEventObject* AminoJSEventObject::getEventHandler() {
  * Note: items are never applied.
  */
 void AminoJSEventObject::clearAsyncQueue() {
-    assert(asyncUpdates);
-
-    int res = pthread_mutex_lock(&asyncLock);
-
-    assert(res == 0);
-
-    std::size_t count = asyncUpdates->size();
+    std::vector<AnyAsyncUpdate *> items;
+    std::size_t count = asyncUpdates.drain(items);
 
     for (std::size_t i = 0; i < count; i++) {
-        AnyAsyncUpdate *item = (*asyncUpdates)[i];
+        AnyAsyncUpdate *item = items[i];
 
-        delete item;
+        freeAsyncUpdate(item);
     }
-
-    //Note: not applied, can safely clear vector
-    asyncUpdates->clear();
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
 }
 
 /**
@@ -1935,36 +1942,25 @@ void AminoJSEventObject::clearAsyncQueue() {
  * Note: has to run on main thread!
  */
 void AminoJSEventObject::handleAsyncDeletes() {
-    assert(asyncDeletes);
-
     if (DEBUG_BASE) {
         assert(isMainThread());
     }
 
-    int res = pthread_mutex_lock(&asyncLock);
-
-    assert(res == 0);
-
-    std::size_t count = asyncDeletes->size();
+    std::size_t count = asyncDeletes.drain(deleteItems);
 
     if (count > 0) {
         //create scope
         Nan::HandleScope scope;
 
         for (std::size_t i = 0; i < count; i++) {
-            AnyAsyncUpdate *item = (*asyncDeletes)[i];
+            AnyAsyncUpdate *item = deleteItems[i];
 
             //free instance
-            delete item;
+            freeAsyncUpdate(item);
         }
 
-        assert(count == asyncDeletes->size());
-
-        asyncDeletes->clear();
+        deleteItems.clear();
     }
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
 }
 
 /**
@@ -1973,47 +1969,73 @@ void AminoJSEventObject::handleAsyncDeletes() {
  * Note: has to run on main thread!
  */
 void AminoJSEventObject::handleJSUpdates() {
-    assert(jsUpdates);
-
     if (DEBUG_BASE) {
         assert(isMainThread());
     }
 
-    int res = pthread_mutex_lock(&asyncLock);
-
-    assert(res == 0);
-
-    std::size_t count = jsUpdates->size();
+    std::size_t count = jsUpdates.drain(jsItems);
 
     if (count > 0) {
         //create scope
         Nan::HandleScope scope;
 
-        for (std::size_t i = 0; i < jsUpdates->size(); i++) {
-            AnyAsyncUpdate *item = (*jsUpdates)[i];
+        for (std::size_t i = 0; i < count; i++) {
+            AnyAsyncUpdate *item = jsItems[i];
 
             item->apply();
-            delete item;
+
+            //recycle property updates (on rendering thread)
+            if (item->type == ASYNC_JS_UPDATE_PROPERTY) {
+                jsPropertyUpdatesRecycled.push(item);
+            } else {
+                delete item;
+            }
         }
 
-        jsUpdates->clear();
+        jsItems.clear();
     }
+}
+
+/**
+ * Free or recycle an async update.
+ *
+ * Note: has to run on main thread!
+ */
+void AminoJSEventObject::freeAsyncUpdate(AnyAsyncUpdate *item) {
+    if (item->type == ASYNC_UPDATE_PROPERTY) {
+        AsyncPropertyUpdate *propItem = static_cast<AsyncPropertyUpdate *>(item);
 
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+        propItem->reset();
+        propertyUpdatePool.put(propItem);
+    } else {
+        delete item;
+    }
 }
 
 /**
  * Get runtime specific data.
  */
 void AminoJSEventObject::getStats(v8::Local<v8::Object> &obj) {
-    //internal
-
-    /*
-    Nan::Set(obj, Nan::New("jsUpdates").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)jsUpdates->size()));
-    Nan::Set(obj, Nan::New("asyncUpdates").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncUpdates->size()));
-    Nan::Set(obj, Nan::New("asyncDeletes").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncDeletes->size()));
-    */
+    //queues (current size and high-water mark)
+    v8::Local<v8::Object> queuesObj = Nan::New<v8::Object>();
+
+    Nan::Set(queuesObj, Nan::New("asyncUpdates").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncUpdates.size()));
+    Nan::Set(queuesObj, Nan::New("asyncUpdatesMax").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncUpdates.getHighWaterMark()));
+    Nan::Set(queuesObj, Nan::New("asyncDeletes").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncDeletes.size()));
+    Nan::Set(queuesObj, Nan::New("asyncDeletesMax").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)asyncDeletes.getHighWaterMark()));
+    Nan::Set(queuesObj, Nan::New("jsUpdates").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)jsUpdates.size()));
+    Nan::Set(queuesObj, Nan::New("jsUpdatesMax").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)jsUpdates.getHighWaterMark()));
+    Nan::Set(queuesObj, Nan::New("coalescedUpdates").ToLocalChecked(), Nan::New<v8::Uint32>(coalescedUpdates));
+    Nan::Set(queuesObj, Nan::New("coalescedJSUpdates").ToLocalChecked(), Nan::New<v8::Uint32>(coalescedJSUpdates));
+    Nan::Set(obj, Nan::New("queues").ToLocalChecked(), queuesObj);
+
+    //pools (hit rate)
+    v8::Local<v8::Object> poolsObj = Nan::New<v8::Object>();
+
+    propertyUpdatePool.getStats(poolsObj, "propertyUpdates");
+    jsPropertyUpdatePool.getStats(poolsObj, "jsPropertyUpdates");
+    asyncScalarPool.getStats(poolsObj, "asyncData");
+    Nan::Set(obj, Nan::New("pools").ToLocalChecked(), poolsObj);
 
     //output instance stats
     if (DEBUG_JS_INSTANCES) {
@@ -2076,20 +2098,43 @@ void AminoJSEventObject::processAsyncQueue() {
         printf("--- processAsyncQueue() --- \n");
     }
 
-    //iterate
-    assert(asyncUpdates);
+    //take all queued items (new items are handled in the next cycle)
+    std::size_t count = asyncUpdates.drain(asyncItems);
 
-    int res = pthread_mutex_lock(&asyncLock);
+    //coalesce property updates (last write wins)
+    nextCoalesceMark();
 
-    assert(res == 0);
+    for (std::size_t i = count; i-- > 0;) {
+        AnyAsyncUpdate *item = asyncItems[i];
 
-    for (std::size_t i = 0; i < asyncUpdates->size(); i++) {
-        AnyAsyncUpdate *item = (*asyncUpdates)[i];
+        if (item->type == ASYNC_UPDATE_PROPERTY) {
+            AnyProperty *prop = static_cast<AsyncPropertyUpdate *>(item)->property;
 
-        assert(item);
+            if (prop->asyncMark == coalesceMark) {
+                //overwritten by later update
+                asyncItems[i] = NULL;
+                asyncDeletes.push(item);
+                coalescedUpdates++;
+            } else {
+                prop->asyncMark = coalesceMark;
+            }
+        } else {
+            //keep order of value updates (e.g. addChild/removeChild)
+            nextCoalesceMark();
+        }
+    }
+
+    //iterate
+    for (std::size_t i = 0; i < count; i++) {
+        AnyAsyncUpdate *item = asyncItems[i];
+
+        if (!item) {
+            //coalesced
+            continue;
+        }
 
         //debug
-        //printf("%i of %i (type: %i)\n", (int)i, (int)asyncUpdates->size(), (int)item->type);
+        //printf("%i of %i (type: %i)\n", (int)i, (int)count, (int)item->type);
 
         switch (item->type) {
             case ASYNC_UPDATE_PROPERTY:
@@ -2102,7 +2147,7 @@ void AminoJSEventObject::processAsyncQueue() {
                     assert(propItem->property->obj);
 
                     if (DEBUG_ASYNC) {
-                        printf("%i of %i (property: %s of %s)\n", (int)i, (int)asyncUpdates->size(), propItem->property->name.c_str(), propItem->property->obj->getName().c_str());
+                        printf("%i of %i (property: %s of %s)\n", (int)i, (int)count, propItem->property->name.c_str(), propItem->property->obj->getName().c_str());
                     }
 
                     propItem->property->obj->handleAsyncUpdate(propItem);
@@ -2118,7 +2163,7 @@ void AminoJSEventObject::processAsyncQueue() {
                     assert(valueItem->obj);
 
                     if (DEBUG_ASYNC) {
-                        printf("%i of %i (type: value update)\n", (int)i, (int)asyncUpdates->size());
+                        printf("%i of %i (type: value update)\n", (int)i, (int)count);
                     }
 
                     if (!valueItem->obj->handleAsyncUpdate(valueItem)) {
@@ -2133,21 +2178,30 @@ void AminoJSEventObject::processAsyncQueue() {
                 break;
         }
 
-        //free item
-        asyncDeletes->push_back(item);
+        //free item (on main thread)
+        asyncDeletes.push(item);
     }
 
     //clear
-    asyncUpdates->clear();
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+    asyncItems.clear();
 
     if (DEBUG_BASE) {
         printf("--- processAsyncQueue() done --- \n");
     }
 }
 
+/**
+ * Start a new coalescing range.
+ */
+void AminoJSEventObject::nextCoalesceMark() {
+    coalesceMark++;
+
+    //0 is the initial property value
+    if (coalesceMark == 0) {
+        coalesceMark = 1;
+    }
+}
+
 /**
  * Enqueue a value update.
  */
@@ -2166,16 +2220,7 @@ bool AminoJSEventObject::enqueueValueUpdate(AsyncValueUpdate *update) {
         printf("enqueueValueUpdate\n");
     }
 
-    assert(asyncUpdates);
-
-    int res = pthread_mutex_lock(&asyncLock);
-
-    assert(res == 0);
-
-    asyncUpdates->push_back(update);
-
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+    asyncUpdates.push(update);
 
     return true;
 }
@@ -2214,23 +2259,53 @@ bool AminoJSEventObject::enqueuePropertyUpdate(AnyProperty *prop, v8::Local<v8::
     }
 
     //async handling
-    int res = pthread_mutex_lock(&asyncLock);
-
-    assert(res == 0);
+    AsyncPropertyUpdate *update = propertyUpdatePool.get();
 
-    asyncUpdates->push_back(new AsyncPropertyUpdate(prop, data));
+    if (update) {
+        update->init(prop, data);
+    } else {
+        update = new AsyncPropertyUpdate(prop, data);
+    }
 
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+    asyncUpdates.push(update);
 
     return true;
 }
 
 /**
  * Add JS property update.
+ *
+ * Note: called on rendering thread (recycled instances are owned by this thread).
  */
 bool AminoJSEventObject::enqueueJSPropertyUpdate(AnyProperty *prop) {
-    return enqueueJSUpdate(new JSPropertyUpdate(prop));
+    //coalesce (pending update reads the latest value)
+    if (prop->jsUpdatePending.exchange(true)) {
+        coalescedJSUpdates++;
+
+        return true;
+    }
+
+    //refill pool
+    if (jsPropertyUpdatePool.isEmpty()) {
+        std::size_t count = jsPropertyUpdatesRecycled.drain(recycledItems);
+
+        for (std::size_t i = 0; i < count; i++) {
+            jsPropertyUpdatePool.put(static_cast<JSPropertyUpdate *>(recycledItems[i]));
+        }
+
+        recycledItems.clear();
+    }
+
+    //recycle or create
+    JSPropertyUpdate *update = jsPropertyUpdatePool.get();
+
+    if (update) {
+        update->init(prop);
+    } else {
+        update = new JSPropertyUpdate(prop);
+    }
+
+    return enqueueJSUpdate(update);
 }
 
 /**
@@ -2245,16 +2320,93 @@ bool AminoJSEventObject::enqueueJSUpdate(AnyAsyncUpdate *update) {
         return false;
     }
 
-    int res = pthread_mutex_lock(&asyncLock);
+    jsUpdates.push(update);
 
-    assert(res == 0);
+    return true;
+}
 
-    jsUpdates->push_back(update);
+//
+// AminoJSEventObject::AsyncQueue
+//
 
-    res = pthread_mutex_unlock(&asyncLock);
-    assert(res == 0);
+/**
+ * Constructor.
+ */
+AminoJSEventObject::AsyncQueue::AsyncQueue(): head(NULL), count(0), highWaterMark(0) {
+    //empty
+}
 
-    return true;
+/**
+ * Add an item.
+ *
+ * Note: lock-free, can be called on any thread.
+ */
+void AminoJSEventObject::AsyncQueue::push(AnyAsyncUpdate *item) {
+    assert(item);
+
+    //count first (drain() subtracts after taking the items)
+    std::size_t depth = count.fetch_add(1, std::memory_order_relaxed) + 1;
+    std::size_t max = highWaterMark.load(std::memory_order_relaxed);
+
+    while (depth > max && !highWaterMark.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+        //retry
+    }
+
+    //link (LIFO)
+    AnyAsyncUpdate *top = head.load(std::memory_order_relaxed);
+
+    do {
+        item->next = top;
+    } while (!head.compare_exchange_weak(top, item, std::memory_order_release, std::memory_order_relaxed));
+}
+
+/**
+ * Take all queued items in FIFO order.
+ *
+ * Note: single consumer only.
+ *
+ * @return number of items appended to items
+ */
+std::size_t AminoJSEventObject::AsyncQueue::drain(std::vector<AnyAsyncUpdate *> &items) {
+    //swap
+    AnyAsyncUpdate *item = head.exchange(NULL, std::memory_order_acquire);
+
+    if (!item) {
+        return 0;
+    }
+
+    //collect
+    std::size_t start = items.size();
+
+    while (item) {
+        AnyAsyncUpdate *next = item->next;
+
+        item->next = NULL;
+        items.push_back(item);
+        item = next;
+    }
+
+    std::reverse(items.begin() + start, items.end());
+
+    std::size_t drained = items.size() - start;
+
+    count.fetch_sub(drained, std::memory_order_relaxed);
+
+    return drained;
+}
+
+/**
+ * Get the number of queued items.
+ */
+std::size_t AminoJSEventObject::AsyncQueue::size() {
+    return count.load(std::memory_order_relaxed);
+}
+
+/**
+ * Get the maximum number of queued items.
+ */
+std::size_t AminoJSEventObject::AsyncQueue::getHighWaterMark() {
+    return highWaterMark.load(std::memory_order_relaxed);
 }
 
 //
@@ -2264,26 +2416,52 @@ bool AminoJSEventObject::enqueueJSUpdate(AnyAsyncUpdate *update) {
 /**
  * Constructor.
  */
-AminoJSEventObject::AsyncPropertyUpdate::AsyncPropertyUpdate(AnyProperty *property, void *data): AnyAsyncUpdate(ASYNC_UPDATE_PROPERTY), property(property), data(data) {
+AminoJSEventObject::AsyncPropertyUpdate::AsyncPropertyUpdate(AnyProperty *property, void *data): AnyAsyncUpdate(ASYNC_UPDATE_PROPERTY), property(NULL), data(NULL) {
+    init(property, data);
+}
+
+/**
+ * Destructor.
+ *
+ * Note: called on main thread.
+ */
+AminoJSEventObject::AsyncPropertyUpdate::~AsyncPropertyUpdate() {
+    reset();
+}
+
+/**
+ * Set the property and value (new or recycled instance).
+ */
+void AminoJSEventObject::AsyncPropertyUpdate::init(AnyProperty *property, void *data) {
     assert(property);
+    assert(!this->property);
+
+    this->property = property;
+    this->data = data;
 
     //retain instance to target object
     property->retain();
 }
 
 /**
- * Destructor.
+ * Free the value and release the property.
  *
  * Note: called on main thread.
  */
-AminoJSEventObject::AsyncPropertyUpdate::~AsyncPropertyUpdate() {
+void AminoJSEventObject::AsyncPropertyUpdate::reset() {
+    if (!property) {
+        return;
+    }
+
     //retain/release
     if (retainLater) {
         retainLater->retain();
+        retainLater = NULL;
     }
 
     if (releaseLater) {
         releaseLater->release();
+        releaseLater = NULL;
     }
 
     //free data
@@ -2292,6 +2470,7 @@ AminoJSEventObject::AsyncPropertyUpdate::~AsyncPropertyUpdate() {
 
     //release instance to target object
     property->release();
+    property = NULL;
 }
 
 /**
@@ -7,6 +7,8 @@
 
 #include <map>
 #include <memory>
+#include <vector>
+#include <atomic>
 #include <pthread.h>
 
 #define ASYNC_UPDATE_PROPERTY      0
@@ -21,8 +23,85 @@
 #define DEBUG_RESOURCES false
 #define DEBUG_REFERENCES false
 
+//maximum number of recycled items per pool
+#define ASYNC_POOL_SIZE 4096
+
 class AminoJSObject;
 
+/**
+ * Pool of recycled heap objects.
+ *
+ * Note: not thread-safe.
+ */
+template<typename T> class AminoPool {
+public:
+    //stats
+    unsigned int requests = 0;
+    unsigned int hits = 0;
+
+    AminoPool(std::size_t maxItems): maxItems(maxItems) {
+        //empty
+    }
+
+    ~AminoPool() {
+        for (std::size_t i = 0; i < items.size(); i++) {
+            delete items[i];
+        }
+    }
+
+    /**
+     * Get a recycled item (or NULL if empty).
+     */
+    T* get() {
+        requests++;
+
+        if (items.empty()) {
+            return NULL;
+        }
+
+        hits++;
+
+        T *item = items.back();
+
+        items.pop_back();
+
+        return item;
+    }
+
+    /**
+     * Recycle an item.
+     */
+    void put(T *item) {
+        if (items.size() >= maxItems) {
+            delete item;
+            return;
+        }
+
+        items.push_back(item);
+    }
+
+    bool isEmpty() {
+        return items.empty();
+    }
+
+    /**
+     * Add request and hit counters.
+     */
+    void getStats(v8::Local<v8::Object> &obj, const char *name) {
+        v8::Local<v8::Object> poolObj = Nan::New<v8::Object>();
+
+        Nan::Set(poolObj, Nan::New("requests").ToLocalChecked(), Nan::New<v8::Uint32>(requests));
+        Nan::Set(poolObj, Nan::New("hits").ToLocalChecked(), Nan::New<v8::Uint32>(hits));
+        Nan::Set(poolObj, Nan::New("hitRate").ToLocalChecked(), Nan::New<v8::Number>(requests > 0 ? (double)hits / requests : 0));
+        Nan::Set(poolObj, Nan::New("size").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)items.size()));
+        Nan::Set(obj, Nan::New(name).ToLocalChecked(), poolObj);
+    }
+
+private:
+    std::vector<T *> items;
+    std::size_t maxItems;
+};
+
 /**
  * Factory object to create JS instance.
  */
@@ -68,6 +147,19 @@ protected:
     static std::string toString(v8::Local<v8::Value> &value);
     static std::string* toNewString(v8::Local<v8::Value> &value);
 
+    //scalar async data (recycled on main thread)
+    union AsyncScalar {
+        float f;
+        int i;
+        unsigned int u;
+        bool b;
+    };
+
+    static AminoPool<AsyncScalar> asyncScalarPool;
+
+    static AsyncScalar* newAsyncScalar();
+    static void deleteAsyncScalar(void *data);
+
     static const int PROPERTY_FLOAT        = 1;
     static const int PROPERTY_FLOAT_ARRAY  = 2;
     static const int PROPERTY_USHORT_ARRAY = 3;
@@ -87,6 +179,10 @@ protected:
         int id;
         bool connected = false;
 
+        //coalescing
+        unsigned int asyncMark = 0; //rendering thread
+        std::atomic<bool> jsUpdatePending { false };
+
         AnyProperty(int type, AminoJSObject *obj, std::string name, int id);
         virtual ~AnyProperty();
 
@@ -287,6 +383,7 @@ protected:
     class AnyAsyncUpdate {
     public:
         int type;
+        AnyAsyncUpdate *next = NULL; //queue link
 
         AnyAsyncUpdate(int type);
         virtual ~AnyAsyncUpdate();
@@ -306,6 +403,9 @@ protected:
         AsyncPropertyUpdate(AnyProperty *property, void *data);
         ~AsyncPropertyUpdate();
 
+        void init(AnyProperty *property, void *data);
+        void reset();
+
         void apply();
     };
 
@@ -350,6 +450,8 @@ protected:
         JSPropertyUpdate(AnyProperty *property);
         ~JSPropertyUpdate();
 
+        void init(AnyProperty *property);
+
         void apply() override;
     private:
         AnyProperty *property;
@@ -434,16 +536,55 @@ protected:
     void clearAsyncQueue();
     void handleAsyncDeletes();
     void handleJSUpdates();
+    void freeAsyncUpdate(AnyAsyncUpdate *item);
 
     virtual void getStats(v8::Local<v8::Object> &obj);
 
 private:
-    std::vector<AnyAsyncUpdate *> *asyncUpdates = NULL;
-    std::vector<AnyAsyncUpdate *> *asyncDeletes = NULL;
-    std::vector<AnyAsyncUpdate *> *jsUpdates = NULL;
+    /**
+     * Lock-free update queue.
+     *
+     * Producers push single items, the consumer takes all queued items at once (swap-and-drain).
+     */
+    class AsyncQueue {
+    public:
+        AsyncQueue();
+
+        void push(AnyAsyncUpdate *item);
+        std::size_t drain(std::vector<AnyAsyncUpdate *> &items);
+
+        std::size_t size();
+        std::size_t getHighWaterMark();
+
+    private:
+        std::atomic<AnyAsyncUpdate *> head;
+        std::atomic<std::size_t> count;
+        std::atomic<std::size_t> highWaterMark;
+    };
+
+    AsyncQueue asyncUpdates; //main -> rendering thread
+    AsyncQueue asyncDeletes; //rendering -> main thread
+    AsyncQueue jsUpdates;    //rendering -> main thread
+
+    //drained items (consumer only)
+    std::vector<AnyAsyncUpdate *> asyncItems;
+    std::vector<AnyAsyncUpdate *> deleteItems;
+    std::vector<AnyAsyncUpdate *> jsItems;
+
+    //recycled updates
+    AminoPool<AsyncPropertyUpdate> propertyUpdatePool;  //main thread
+    AminoPool<JSPropertyUpdate> jsPropertyUpdatePool;   //rendering thread
+    AsyncQueue jsPropertyUpdatesRecycled;               //main -> rendering thread
+    std::vector<AnyAsyncUpdate *> recycledItems;
+
+    //coalescing
+    unsigned int coalesceMark = 0;
+    unsigned int coalescedUpdates = 0;
+    unsigned int coalescedJSUpdates = 0;
+
+    void nextCoalesceMark();
 
     uv_thread_t mainThread;
-    pthread_mutex_t asyncLock; //Note: can block for a while
 };
 
 #endif
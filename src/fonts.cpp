@@ -5,6 +5,14 @@
 #include "base.h"
 
 #include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define DEBUG_FONTS false
 
@@ -115,10 +123,19 @@ void AminoFont::destroyAminoFont() {
 
     fontSizes.clear();
 
-    //atlas
-    if (atlas) {
-        texture_atlas_delete(atlas);
-        atlas = NULL;
+    //atlas pages
+    for (auto const &page : pages) {
+        texture_atlas_delete(page->atlas);
+        delete page;
+    }
+
+    pages.clear();
+
+    //instance
+    std::vector<AminoFont *>::iterator it = std::find(instances.begin(), instances.end(), this);
+
+    if (it != instances.end()) {
+        instances.erase(it);
     }
 
     //font data
@@ -144,7 +161,8 @@ AminoFontFactory* AminoFont::getFactory() {
 v8::Local<v8::FunctionTemplate> AminoFont::GetInitFunction() {
     v8::Local<v8::FunctionTemplate> tpl = AminoJSObject::createTemplate(getFactory());
 
-    //no methods
+    //methods
+    Nan::SetPrototypeMethod(tpl, "_saveCache", SaveCache);
 
     //template function
     return tpl;
@@ -175,14 +193,33 @@ void AminoFont::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
 
     this->fontData.Reset(bufferObj);
 
-    //create atlas
-    atlas = texture_atlas_new(512, 512, 1); //depth must be 1
+    //atlas page budget
+    v8::Local<v8::Value> maxPagesValue = Nan::Get(fontData, Nan::New<v8::String>("maxAtlasPages").ToLocalChecked()).ToLocalChecked();
 
-    if (!atlas) {
+    if (maxPagesValue->IsNumber()) {
+        maxPages = std::max(1, (int)maxPagesValue->Int32Value());
+    }
+
+    //signed distance field glyphs
+    v8::Local<v8::Value> sdfValue = Nan::Get(fontData, Nan::New<v8::String>("sdf").ToLocalChecked()).ToLocalChecked();
+
+    sdf = sdfValue->BooleanValue();
+
+    //atlas cache
+    v8::Local<v8::Value> cacheDirValue = Nan::Get(fontData, Nan::New<v8::String>("cacheDir").ToLocalChecked()).ToLocalChecked();
+
+    if (cacheDirValue->IsString()) {
+        cacheFile = getCacheFile(AminoJSObject::toString(cacheDirValue));
+    }
+
+    //restore or create first atlas page
+    if (!loadCache() && !addPage()) {
         Nan::ThrowTypeError("could not create atlas");
         return;
     }
 
+    instances.push_back(this);
+
     //metadata
     v8::Local<v8::Value> nameValue = Nan::Get(fontData, Nan::New<v8::String>("name").ToLocalChecked()).ToLocalChecked();
     v8::Local<v8::Value> styleValue = Nan::Get(fontData, Nan::New<v8::String>("style").ToLocalChecked()).ToLocalChecked();
@@ -199,9 +236,13 @@ void AminoFont::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
 /**
  * Load font size.
  *
- * Note: has to be called in v8 thread.
+ * Note: has to be called in v8 thread. SDF fonts share the glyphs of the base size.
  */
 texture_font_t *AminoFont::getFontWithSize(int size) {
+    if (sdf) {
+        size = FONT_SDF_BASE_SIZE;
+    }
+
     //check cache
     std::map<int, texture_font_t *>::iterator it = fontSizes.find(size);
     texture_font_t *fontSize;
@@ -212,16 +253,31 @@ texture_font_t *AminoFont::getFontWithSize(int size) {
         char *buffer = node::Buffer::Data(bufferObj);
         size_t bufferLen = node::Buffer::Length(bufferObj);
 
+        //Note: layout thread might use the atlas pages
+        AminoText::initFreeTypeMutex();
+        uv_mutex_lock(&AminoText::freeTypeMutex);
+
         //Note: has texture id but we use our own handling
-        fontSize = texture_font_new_from_memory(atlas, size, buffer, bufferLen, library);
+        fontSize = texture_font_new_from_memory(pages[currentPage]->atlas, size, buffer, bufferLen, library);
 
         if (fontSize) {
             fontSizes[size] = fontSize;
 
+            //distance field (hinting does not scale)
+            if (sdf) {
+                fontSize->rendermode = RENDER_SIGNED_DISTANCE_FIELD;
+                fontSize->hinting = 0;
+            }
+
             //use single FreeType instance
             library = fontSize->library;
+
+            //cached glyphs
+            restoreCachedSize(size, fontSize);
         }
 
+        uv_mutex_unlock(&AminoText::freeTypeMutex);
+
         if (DEBUG_FONTS) {
             printf("-> new font size: %i (%s)\n", size, getFontInfo().c_str());
         }
@@ -239,295 +295,2392 @@ std::string AminoFont::getFontInfo() {
     return fontName + "/" + fontStyle + "/" + std::to_string(fontWeight);
 }
 
-FT_Library AminoFont::library = NULL;
-
-//
-//  AminoFontFactory
-//
-
 /**
- * Create AminoFont factory.
+ * Get a glyph.
+ *
+ * Continues on the next atlas page if the current one is full.
+ *
+ * Note: freeTypeMutex must be locked.
  */
-AminoFontFactory::AminoFontFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFont", callback) {
-    //empty
-}
+texture_glyph_t *AminoFont::getGlyph(texture_font_t *fontTexture, const char *codepoint) {
+    //new glyphs are added to the current page
+    fontTexture->atlas = pages[currentPage]->atlas;
 
-/**
- * Create AminoFonts instance.
- */
-AminoJSObject* AminoFontFactory::create() {
-    return new AminoFont();
-}
+    texture_glyph_t *glyph = texture_font_get_glyph(fontTexture, codepoint);
 
-//
-// AminoFontSize
-//
+    if (!glyph && nextPage()) {
+        fontTexture->atlas = pages[currentPage]->atlas;
+        glyph = texture_font_get_glyph(fontTexture, codepoint);
+    }
 
-AminoFontSize::AminoFontSize(): AminoJSObject(getFactory()->name) {
-    //empty
-}
+    if (glyph) {
+        glyph->last_use = ++glyphUses;
+    }
 
-AminoFontSize::~AminoFontSize() {
-    //empty
+    return glyph;
 }
 
 /**
- * Get factory instance.
+ * Add an empty atlas page.
  */
-AminoFontSizeFactory* AminoFontSize::getFactory() {
-    static AminoFontSizeFactory *aminoFontSizeFactory = NULL;
+bool AminoFont::addPage() {
+    texture_atlas_t *atlas = texture_atlas_new(FONT_ATLAS_SIZE, FONT_ATLAS_SIZE, 1); //depth must be 1
 
-    if (!aminoFontSizeFactory) {
-        aminoFontSizeFactory = new AminoFontSizeFactory(New);
+    if (!atlas) {
+        return false;
     }
 
-    return aminoFontSizeFactory;
-}
+    amino_font_page_t *page = new amino_font_page_t();
 
-/**
- * Initialize AminoFontSize template.
- */
-v8::Local<v8::FunctionTemplate> AminoFontSize::GetInitFunction() {
-    v8::Local<v8::FunctionTemplate> tpl = AminoJSObject::createTemplate(getFactory());
+    page->atlas = atlas;
+    page->generation = 0;
 
-    //methods
-    Nan::SetPrototypeMethod(tpl, "_calcTextWidth", CalcTextWidth);
-    Nan::SetPrototypeMethod(tpl, "getFontMetrics", GetFontMetrics);
+    pages.push_back(page);
+    currentPage = pages.size() - 1;
 
-    //template function
-    return tpl;
-}
+    if (DEBUG_FONTS) {
+        printf("-> new atlas page: %i (%s)\n", (int)pages.size(), getFontInfo().c_str());
+    }
 
-/**
- * JS object construction.
- */
-NAN_METHOD(AminoFontSize::New) {
-    AminoJSObject::createInstance(info, getFactory());
+    return true;
 }
 
 /**
- * Initialize constructor values.
+ * Current page is full. Add a new page or repack the least-recently-used one.
+ *
+ * @return false if the glyph could not be loaded for other reasons
  */
-void AminoFontSize::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
-    assert(info.Length() == 2);
+bool AminoFont::nextPage() {
+    texture_atlas_t *atlas = pages[currentPage]->atlas;
 
-    AminoFont *font = Nan::ObjectWrap::Unwrap<AminoFont>(info[0]->ToObject());
-    int size = (int)round(info[1]->NumberValue());
+    //check free space (glyph could not be loaded for other reasons)
+    if (atlas->used < atlas->width * atlas->height / 2) {
+        return false;
+    }
 
-    assert(font);
+    //add page
+    if (pages.size() < maxPages) {
+        return addPage();
+    }
 
-    this->font = font;
-    fontTexture = font->getFontWithSize(size);
+    //find least-recently-used page
+    size_t pageCount = pages.size();
+    std::vector<size_t> lastUse(pageCount, 0);
 
-    if (!fontTexture) {
-        Nan::ThrowTypeError("could not create font size");
+    for (auto const &item : fontSizes) {
+        vector_t *glyphs = item.second->glyphs;
+
+        for (size_t i = 0; i < glyphs->size; i++) {
+            texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(glyphs, i);
+
+            for (size_t j = 0; j < pageCount; j++) {
+                if (pages[j]->atlas == glyph->atlas) {
+                    lastUse[j] = std::max(lastUse[j], glyph->last_use);
+                    break;
+                }
+            }
+        }
     }
 
-    //font properties
-    v8::Local<v8::Object> obj = handle();
+    size_t index = std::min_element(lastUse.begin(), lastUse.end()) - lastUse.begin();
 
-    Nan::Set(obj, Nan::New("name").ToLocalChecked(), Nan::New<v8::String>(font->fontName).ToLocalChecked());
-    Nan::Set(obj, Nan::New("size").ToLocalChecked(), Nan::New<v8::Number>(size));
-    Nan::Set(obj, Nan::New("weight").ToLocalChecked(), Nan::New<v8::Number>(font->fontWeight));
-    Nan::Set(obj, Nan::New("style").ToLocalChecked(), Nan::New<v8::String>(font->fontStyle).ToLocalChecked());
+    repackPage(index);
+    currentPage = index;
+
+    return true;
 }
 
 /**
- * Calculate text width.
+ * Glyph on an atlas page.
  */
-NAN_METHOD(AminoFontSize::CalcTextWidth) {
-    assert(info.Length() == 1);
-
-    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
-    v8::String::Utf8Value str(info[0]);
-
-    assert(obj);
-
-    info.GetReturnValue().Set(obj->getTextWidth(*str));
-}
+struct amino_glyph_ref_t {
+    texture_glyph_t *glyph;
+    size_t offset; //bitmap offset
+};
 
 /**
- * Calculate text width.
+ * Evict the least-recently-used glyphs of a page and repack the others.
+ *
+ * Keeps the most recently used glyphs up to half of the page. Texts using the page have to be layouted again (see page generation).
  */
-float AminoFontSize::getTextWidth(const char *text) {
-    size_t len = utf8_strlen(text);
-    char *textPos = (char *)text;
-    char *lastTextPos = NULL;
-    float w = 0;
+void AminoFont::repackPage(size_t index) {
+    texture_atlas_t *atlas = pages[index]->atlas;
+    size_t width = atlas->width;
+    size_t height = atlas->height;
 
-    AminoText::initFreeTypeMutex();
-    uv_mutex_lock(&AminoText::freeTypeMutex);
+    //collect glyphs
+    std::vector<amino_glyph_ref_t> refs;
 
-    size_t lastGlyphCount = fontTexture->glyphs->size;
+    for (auto const &item : fontSizes) {
+        vector_t *glyphs = item.second->glyphs;
 
-    for (std::size_t i = 0; i < len; i++) {
-        texture_glyph_t *glyph = texture_font_get_glyph(fontTexture, textPos);
+        for (size_t i = 0; i < glyphs->size; i++) {
+            texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(glyphs, i);
 
-        if (!glyph) {
-            printf("Error: got empty glyph from texture_font_get_glyph()\n");
+            if (glyph->atlas == atlas) {
+                amino_glyph_ref_t ref = { glyph, 0 };
+
+                refs.push_back(ref);
+            }
+        }
+    }
+
+    //most recently used first
+    std::sort(refs.begin(), refs.end(), [](const amino_glyph_ref_t &a, const amino_glyph_ref_t &b) {
+        return a.glyph->last_use > b.glyph->last_use;
+    });
+
+    //copy bitmaps of kept glyphs
+    std::vector<amino_glyph_ref_t> kept;
+    std::unordered_set<texture_glyph_t *> evicted;
+    std::vector<unsigned char> bitmaps;
+    size_t maxArea = width * height / 2;
+    size_t area = 0;
+
+    for (auto &ref : refs) {
+        texture_glyph_t *glyph = ref.glyph;
+        size_t size = glyph->width * glyph->height;
+
+        //Note: special glyph (codepoint -1) is re-created on demand
+        if (glyph->codepoint == (uint32_t)-1 || size == 0 || area + size > maxArea) {
+            evicted.insert(glyph);
             continue;
         }
 
-        //kerning
-        if (lastTextPos) {
-            w += texture_glyph_get_kerning(glyph, lastTextPos);
+        size_t x = (size_t)roundf(glyph->s0 * width);
+        size_t y = (size_t)roundf(glyph->t0 * height);
+
+        ref.offset = bitmaps.size();
+        bitmaps.resize(ref.offset + size);
+
+        for (size_t j = 0; j < glyph->height; j++) {
+            memcpy(&bitmaps[ref.offset + j * glyph->width], atlas->data + (y + j) * width + x, glyph->width);
         }
 
-        //char width
-        w += glyph->advance_x;
+        area += size;
+        kept.push_back(ref);
+    }
 
-        //next
-        size_t charLen = utf8_surrogate_len(textPos);
+    //repack
+    texture_atlas_clear(atlas);
 
-        lastTextPos = textPos;
-        textPos += charLen;
+    for (auto const &ref : kept) {
+        texture_glyph_t *glyph = ref.glyph;
+        ivec4 region = texture_atlas_get_region(atlas, glyph->width, glyph->height);
+
+        if (region.x < 0) {
+            evicted.insert(glyph);
+            continue;
+        }
+
+        texture_atlas_set_region(atlas, region.x, region.y, glyph->width, glyph->height, &bitmaps[ref.offset], glyph->width);
+
+        glyph->s0 = region.x / (float)width;
+        glyph->t0 = region.y / (float)height;
+        glyph->s1 = (region.x + glyph->width) / (float)width;
+        glyph->t1 = (region.y + glyph->height) / (float)height;
     }
 
-    bool glyphsChanged = lastGlyphCount != fontTexture->glyphs->size;
+    //remove evicted glyphs
+    for (auto const &item : fontSizes) {
+        vector_t *glyphs = item.second->glyphs;
 
-    uv_mutex_unlock(&AminoText::freeTypeMutex);
+        for (size_t i = glyphs->size; i-- > 0;) {
+            texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(glyphs, i);
+
+            if (evicted.find(glyph) != evicted.end()) {
+                texture_font_remove_glyph(item.second, i);
+            }
+        }
+    }
 
-    if (glyphsChanged) {
-        texture_atlas_t *atlas = fontTexture->atlas;
+    //cached glyphs of unused sizes
+    for (auto &item : cachedSizes) {
+        std::vector<amino_cache_glyph_t> &glyphs = item.second.glyphs;
 
-        //update all instances
-        AminoGfx::updateAtlasTextures(atlas);
+        glyphs.erase(std::remove_if(glyphs.begin(), glyphs.end(), [index](const amino_cache_glyph_t &glyph) {
+            return glyph.page == index;
+        }), glyphs.end());
     }
 
-    return w;
+    pages[index]->generation++;
+    evictions++;
+
+    if (DEBUG_FONTS) {
+        printf("-> repacked atlas page %i: glyphs=%i evicted=%i (%s)\n", (int)index, (int)refs.size(), (int)evicted.size(), getFontInfo().c_str());
+    }
 }
 
 /**
- * Get font metrics (height, ascender, descender).
+ * Number of atlas pages.
  */
-NAN_METHOD(AminoFontSize::GetFontMetrics) {
-    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
-
-    assert(obj);
-
-    //metrics
-    v8::Local<v8::Object> metricsObj = Nan::New<v8::Object>();
+size_t AminoFont::getPageCount() {
+    return pages.size();
+}
 
-    Nan::Set(metricsObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender - obj->fontTexture->descender));
-    Nan::Set(metricsObj, Nan::New("ascender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender));
-    Nan::Set(metricsObj, Nan::New("descender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->descender));
+/**
+ * Get atlas page.
+ */
+amino_font_page_t *AminoFont::getPage(size_t index) {
+    assert(index < pages.size());
 
-    info.GetReturnValue().Set(metricsObj);
+    return pages[index];
 }
 
-//
-//  AminoFontSizeFactory
-//
-
 /**
- * Create AminoFontSize factory.
+ * Number of page repacks.
  */
-AminoFontSizeFactory::AminoFontSizeFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFontSize", callback) {
-    //empty
+unsigned int AminoFont::getEvictions() {
+    return evictions;
 }
 
 /**
- * Create AminoFonts instance.
+ * Check if atlas pages have to be uploaded.
  */
-AminoJSObject* AminoFontSizeFactory::create() {
-    return new AminoFontSize();
+bool AminoFont::hasDirtyPages() {
+    for (auto const &page : pages) {
+        if (page->atlas->dirty_count > 0) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-//
-// AminoFontShader
-//
+/**
+ * Get and reset the dirty regions of all pages.
+ */
+void AminoFont::takeDirtyPages(std::vector<amino_atlas_update_t> &updates) {
+    for (auto const &page : pages) {
+        if (page->atlas->dirty_count == 0) {
+            continue;
+        }
 
-AminoFontShader::AminoFontShader() : TextureShader() {
-    //shader
+        amino_atlas_update_t update;
 
-    //Note: using unmodified vertex shader
-    fragmentShader = R"(
-        #ifdef GL_ES
-            precision mediump float;
-        #endif
+        update.atlas = page->atlas;
+        update.page = page;
+        update.count = texture_atlas_take_dirty(page->atlas, update.rects);
 
-        uniform float opacity;
-        uniform vec3 color;
-        uniform sampler2D tex;
+        updates.push_back(update);
+    }
+}
 
-        varying vec2 uv;
+/**
+ * Add atlas occupancy of all fonts.
+ *
+ * Note: called on main thread.
+ */
+void AminoFont::getStats(v8::Local<v8::Object> &obj) {
+    v8::Local<v8::Array> fontsArr = Nan::New<v8::Array>();
+    uint32_t index = 0;
 
-        void main() {
-            float a = texture2D(tex, uv).a;
+    AminoText::initFreeTypeMutex();
+    uv_mutex_lock(&AminoText::freeTypeMutex);
 
-            gl_FragColor = vec4(color, opacity * a);
+    for (auto const &font : instances) {
+        v8::Local<v8::Object> fontObj = Nan::New<v8::Object>();
+        size_t used = 0;
+        size_t total = 0;
+        size_t glyphs = 0;
+
+        for (auto const &page : font->pages) {
+            used += page->atlas->used;
+            total += page->atlas->width * page->atlas->height;
         }
-    )";
+
+        for (auto const &item : font->fontSizes) {
+            glyphs += item.second->glyphs->size;
+        }
+
+        Nan::Set(fontObj, Nan::New("font").ToLocalChecked(), Nan::New<v8::String>(font->getFontInfo()).ToLocalChecked());
+        Nan::Set(fontObj, Nan::New("sizes").ToLocalChecked(), Nan::New((uint32_t)font->fontSizes.size()));
+        Nan::Set(fontObj, Nan::New("glyphs").ToLocalChecked(), Nan::New((uint32_t)glyphs));
+        Nan::Set(fontObj, Nan::New("pages").ToLocalChecked(), Nan::New((uint32_t)font->pages.size()));
+        Nan::Set(fontObj, Nan::New("maxPages").ToLocalChecked(), Nan::New((uint32_t)font->maxPages));
+        Nan::Set(fontObj, Nan::New("occupancy").ToLocalChecked(), Nan::New<v8::Number>(total > 0 ? (double)used / total : 0));
+        Nan::Set(fontObj, Nan::New("evictions").ToLocalChecked(), Nan::New(font->evictions));
+
+        Nan::Set(fontsArr, index++, fontObj);
+    }
+
+    uv_mutex_unlock(&AminoText::freeTypeMutex);
+
+    Nan::Set(obj, Nan::New("fonts").ToLocalChecked(), fontsArr);
 }
 
 /**
- * Initialize the font shader.
+ * Atlas cache file header.
  */
-void AminoFontShader::initShader() {
-    TextureShader::initShader();
-
-    //uniforms
-    uColor = getUniformLocation("color");
-}
+struct amino_cache_header_t {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t pageSize;
+    uint32_t pageCount;
+    uint32_t currentPage;
+    uint32_t sizeCount;
+};
 
 /**
- * Set color.
+ * Atlas cache page (followed by the skyline nodes and the pixels).
  */
-void AminoFontShader::setColor(GLfloat color[3]) {
-    glUniform3f(uColor, color[0], color[1], color[2]);
-}
+struct amino_cache_page_t {
+    uint32_t used;
+    uint32_t nodeCount;
+};
 
 /**
- * Get texture for atlas.
+ * Get the cache file of the font.
  *
- * Note: has to be called on OpenGL thread.
+ * Key: font data, atlas size, cache version, FreeType version and SDF mode.
  */
-amino_atlas_t AminoFontShader::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
-    std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(atlas);
+std::string AminoFont::getCacheFile(std::string dir) {
+    v8::Local<v8::Object> bufferObj = Nan::New(fontData);
+    const unsigned char *data = (const unsigned char *)node::Buffer::Data(bufferObj);
+    size_t len = node::Buffer::Length(bufferObj);
+    uint32_t settings[] = { FONT_CACHE_VERSION, FONT_ATLAS_SIZE, FREETYPE_MAJOR, FREETYPE_MINOR, FREETYPE_PATCH, sdf };
+    const unsigned char *settingsData = (const unsigned char *)settings;
+
+    //FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
 
-    newTexture = false;
+    for (size_t i = 0; i < sizeof(settings); i++) {
+        hash = (hash ^ settingsData[i]) * 0x100000001b3ULL;
+    }
 
-    if (it == atlasTextures.end()) {
-        if (!createIfMissing) {
-            amino_atlas_t item = { INVALID_TEXTURE };
+    cacheKey = hash;
 
-            return item;
-        }
+    //file
+    char name[32];
 
-        //create new one
-        GLuint id = INVALID_TEXTURE;
+    snprintf(name, sizeof(name), "%016llx.atlas", (unsigned long long)hash);
+
+    return dir + "/" + name;
+}
+
+/**
+ * Check a cached region against the atlas page.
+ */
+static bool isValidCacheRegion(int64_t x, int64_t y, int64_t w, int64_t h) {
+    return x >= 0 && y >= 0 && w >= 0 && h >= 0 && x + w <= FONT_ATLAS_SIZE && y + h <= FONT_ATLAS_SIZE;
+}
+
+/**
+ * Check the texture coordinates of a cached glyph.
+ */
+static bool isValidCacheGlyph(const amino_cache_glyph_t &glyph) {
+    float coords[] = { glyph.s0, glyph.t0, glyph.s1, glyph.t1 };
 
-        //see https://webcache.googleusercontent.com/search?q=cache:EZ3HLutV3zwJ:https://github.com/rougier/freetype-gl/blob/master/texture-atlas.c+&cd=1&hl=de&ct=clnk&gl=ch
-        glGenTextures(1, &id);
-        newTexture = true;
+    for (float coord : coords) {
+        //Note: also rejects NaN
+        if (!(coord >= 0 && coord <= 1)) {
+            return false;
+        }
+    }
 
-        assert(id != INVALID_TEXTURE);
+    //bitmap (see repackPage())
+    int64_t x = (int64_t)roundf(glyph.s0 * FONT_ATLAS_SIZE);
+    int64_t y = (int64_t)roundf(glyph.t0 * FONT_ATLAS_SIZE);
 
-        glBindTexture(GL_TEXTURE_2D, id);
+    return isValidCacheRegion(x, y, glyph.width, glyph.height);
+}
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+/**
+ * Restore the atlas pages and glyphs from the cache file (memory-mapped).
+ *
+ * @return false if there is no valid cache file
+ */
+bool AminoFont::loadCache() {
+    if (cacheFile.empty()) {
+        return false;
+    }
 
-        //best quality
-        //Note: padding adjustment in freetype-gl needed to solve vertical thin line issue at boundaries (see https://github.com/rougier/freetype-gl/issues/123)
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    //map file
+    int fd = open(cacheFile.c_str(), O_RDONLY);
 
-        //much worse quality
-        //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    if (fd < 0) {
+        return false;
+    }
 
-        amino_atlas_t item;
+    struct stat st;
 
-        item.textureId = id;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(amino_cache_header_t)) {
+        close(fd);
+        return false;
+    }
 
-        atlasTextures[atlas] = item;
+    size_t len = st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
 
-        //debug
-        //printf("create new atlas texture: %i (total: %i)\n", id, (int)atlasTextures.size());
+    close(fd);
 
-        return item;
+    if (map == MAP_FAILED) {
+        return false;
     }
 
-    return it->second;
+    //parse
+    const char *pos = (const char *)map;
+    const char *end = pos + len;
+    auto read = [&pos, end](void *dest, size_t size) {
+        if ((size_t)(end - pos) < size) {
+            return false;
+        }
+
+        memcpy(dest, pos, size);
+        pos += size;
+
+        return true;
+    };
+
+    std::vector<amino_font_page_t *> newPages;
+    std::map<int, amino_cached_font_size_t> newSizes;
+    amino_cache_header_t header;
+    bool valid = read(&header, sizeof(header)) &&
+        memcmp(header.magic, "AMFC", 4) == 0 &&
+        header.version == FONT_CACHE_VERSION &&
+        header.key == cacheKey &&
+        header.pageSize == FONT_ATLAS_SIZE &&
+        header.pageCount > 0 &&
+        header.pageCount <= maxPages &&
+        header.currentPage < header.pageCount;
+
+    //pages
+    for (uint32_t i = 0; valid && i < header.pageCount; i++) {
+        amino_cache_page_t pageInfo;
+
+        if (!read(&pageInfo, sizeof(pageInfo)) ||
+            pageInfo.nodeCount == 0 ||
+            pageInfo.nodeCount > FONT_ATLAS_SIZE ||
+            pageInfo.used > FONT_ATLAS_SIZE * FONT_ATLAS_SIZE ||
+            (size_t)(end - pos) < pageInfo.nodeCount * sizeof(ivec3)) {
+            valid = false;
+            break;
+        }
+
+        texture_atlas_t *atlas = texture_atlas_new(FONT_ATLAS_SIZE, FONT_ATLAS_SIZE, 1);
+        amino_font_page_t *page = new amino_font_page_t();
+
+        page->atlas = atlas;
+        page->generation = 0;
+        newPages.push_back(page);
+
+        //skyline
+        vector_clear(atlas->nodes);
+
+        for (uint32_t j = 0; j < pageInfo.nodeCount; j++) {
+            ivec3 node;
+
+            read(&node, sizeof(node));
+
+            //skyline node: x, y, width
+            if (!isValidCacheRegion(node.x, node.y, node.z, 0)) {
+                valid = false;
+                break;
+            }
+
+            vector_push_back(atlas->nodes, &node);
+        }
+
+        if (!valid) {
+            break;
+        }
+
+        atlas->used = pageInfo.used;
+
+        //pixels
+        valid = read(atlas->data, FONT_ATLAS_SIZE * FONT_ATLAS_SIZE);
+    }
+
+    //sizes
+    for (uint32_t i = 0; valid && i < header.sizeCount; i++) {
+        amino_cached_font_size_t cachedSize;
+
+        if (!read(&cachedSize.info, sizeof(cachedSize.info)) ||
+            (size_t)(end - pos) < cachedSize.info.glyphCount * sizeof(amino_cache_glyph_t) + cachedSize.info.kerningCount * sizeof(kerning_t)) {
+            valid = false;
+            break;
+        }
+
+        cachedSize.glyphs.resize(cachedSize.info.glyphCount);
+        cachedSize.kerning.resize(cachedSize.info.kerningCount);
+
+        read(cachedSize.glyphs.data(), cachedSize.glyphs.size() * sizeof(amino_cache_glyph_t));
+        read(cachedSize.kerning.data(), cachedSize.kerning.size() * sizeof(kerning_t));
+
+        for (auto const &glyph : cachedSize.glyphs) {
+            if (glyph.page >= header.pageCount || !isValidCacheGlyph(glyph)) {
+                valid = false;
+                break;
+            }
+        }
+
+        newSizes[cachedSize.info.size] = cachedSize;
+    }
+
+    munmap(map, len);
+
+    if (!valid) {
+        printf("Warning: ignoring invalid font cache: %s\n", cacheFile.c_str());
+
+        for (auto const &page : newPages) {
+            texture_atlas_delete(page->atlas);
+            delete page;
+        }
+
+        return false;
+    }
+
+    pages = newPages;
+    currentPage = header.currentPage;
+    cachedSizes = newSizes;
+
+    if (DEBUG_FONTS) {
+        printf("-> restored font cache: pages=%i sizes=%i (%s)\n", (int)pages.size(), (int)cachedSizes.size(), cacheFile.c_str());
+    }
+
+    return true;
+}
+
+/**
+ * Add the cached glyphs of a new font size.
+ *
+ * Note: freeTypeMutex must be locked.
+ */
+void AminoFont::restoreCachedSize(int size, texture_font_t *fontSize) {
+    std::map<int, amino_cached_font_size_t>::iterator it = cachedSizes.find(size);
+
+    if (it == cachedSizes.end()) {
+        return;
+    }
+
+    amino_cached_font_size_t &cachedSize = it->second;
+    amino_cache_size_t &info = cachedSize.info;
+
+    //check settings
+    if (info.rendermode == fontSize->rendermode &&
+        info.outlineThickness == fontSize->outline_thickness &&
+        info.hinting == fontSize->hinting &&
+        info.filtering == fontSize->filtering) {
+        //glyphs
+        for (auto const &item : cachedSize.glyphs) {
+            texture_glyph_t *glyph = texture_glyph_new();
+
+            glyph->codepoint = item.codepoint;
+            glyph->width = item.width;
+            glyph->height = item.height;
+            glyph->rendermode = fontSize->rendermode;
+            glyph->outline_thickness = fontSize->outline_thickness;
+            glyph->offset_x = item.offsetX;
+            glyph->offset_y = item.offsetY;
+            glyph->advance_x = item.advanceX;
+            glyph->advance_y = item.advanceY;
+            glyph->s0 = item.s0;
+            glyph->t0 = item.t0;
+            glyph->s1 = item.s1;
+            glyph->t1 = item.t1;
+            glyph->atlas = pages[item.page]->atlas;
+
+            if (!texture_font_add_glyph(fontSize, glyph)) {
+                texture_glyph_delete(glyph);
+            }
+        }
+
+        //kerning
+        for (auto const &item : cachedSize.kerning) {
+            texture_font_set_kerning(fontSize, item.left, item.right, item.kerning);
+        }
+
+        if (DEBUG_FONTS) {
+            printf("-> restored cached glyphs: size=%i glyphs=%i (%s)\n", size, (int)cachedSize.glyphs.size(), getFontInfo().c_str());
+        }
+    }
+
+    cachedSizes.erase(it);
+}
+
+/**
+ * Write the atlas pages and glyphs to the cache file.
+ *
+ * Note: called on main thread.
+ */
+bool AminoFont::saveCache() {
+    if (cacheFile.empty()) {
+        return false;
+    }
+
+    std::vector<char> out;
+    auto write = [&out](const void *data, size_t size) {
+        const char *bytes = (const char *)data;
+
+        out.insert(out.end(), bytes, bytes + size);
+    };
+
+    AminoText::initFreeTypeMutex();
+    uv_mutex_lock(&AminoText::freeTypeMutex);
+
+    //header
+    amino_cache_header_t header;
+    uint32_t sizeCount = fontSizes.size();
+
+    for (auto const &item : cachedSizes) {
+        if (fontSizes.find(item.first) == fontSizes.end()) {
+            sizeCount++;
+        }
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "AMFC", 4);
+    header.version = FONT_CACHE_VERSION;
+    header.key = cacheKey;
+    header.pageSize = FONT_ATLAS_SIZE;
+    header.pageCount = pages.size();
+    header.currentPage = currentPage;
+    header.sizeCount = sizeCount;
+
+    write(&header, sizeof(header));
+
+    //pages
+    for (auto const &page : pages) {
+        texture_atlas_t *atlas = page->atlas;
+        amino_cache_page_t pageInfo;
+
+        pageInfo.used = atlas->used;
+        pageInfo.nodeCount = vector_size(atlas->nodes);
+
+        write(&pageInfo, sizeof(pageInfo));
+        write(atlas->nodes->items, pageInfo.nodeCount * sizeof(ivec3));
+        write(atlas->data, FONT_ATLAS_SIZE * FONT_ATLAS_SIZE);
+    }
+
+    //sizes
+    for (auto const &item : fontSizes) {
+        texture_font_t *fontSize = item.second;
+        std::vector<amino_cache_glyph_t> glyphs;
+        std::vector<kerning_t> kerning;
+
+        for (size_t i = 0; i < fontSize->glyphs->size; i++) {
+            texture_glyph_t *glyph = *(texture_glyph_t **)vector_get(fontSize->glyphs, i);
+            amino_cache_glyph_t cached;
+
+            //Note: special glyph is created by each font size
+            if (glyph->codepoint == (uint32_t)-1) {
+                continue;
+            }
+
+            cached.page = pages.size();
+
+            for (size_t j = 0; j < pages.size(); j++) {
+                if (pages[j]->atlas == glyph->atlas) {
+                    cached.page = j;
+                    break;
+                }
+            }
+
+            if (cached.page == pages.size()) {
+                continue;
+            }
+
+            cached.codepoint = glyph->codepoint;
+            cached.width = glyph->width;
+            cached.height = glyph->height;
+            cached.offsetX = glyph->offset_x;
+            cached.offsetY = glyph->offset_y;
+            cached.advanceX = glyph->advance_x;
+            cached.advanceY = glyph->advance_y;
+            cached.s0 = glyph->s0;
+            cached.t0 = glyph->t0;
+            cached.s1 = glyph->s1;
+            cached.t1 = glyph->t1;
+
+            glyphs.push_back(cached);
+        }
+
+        for (size_t i = 0; i < fontSize->kerning_map_capacity; i++) {
+            kerning_t *entry = &fontSize->kerning_map[i];
+
+            if (entry->left) {
+                kerning.push_back(*entry);
+            }
+        }
+
+        amino_cache_size_t info;
+
+        info.size = item.first;
+        info.rendermode = fontSize->rendermode;
+        info.outlineThickness = fontSize->outline_thickness;
+        info.hinting = fontSize->hinting;
+        info.filtering = fontSize->filtering;
+        info.glyphCount = glyphs.size();
+        info.kerningCount = kerning.size();
+
+        write(&info, sizeof(info));
+        write(glyphs.data(), glyphs.size() * sizeof(amino_cache_glyph_t));
+        write(kerning.data(), kerning.size() * sizeof(kerning_t));
+    }
+
+    //cached sizes not used yet
+    for (auto &item : cachedSizes) {
+        amino_cached_font_size_t &cachedSize = item.second;
+
+        if (fontSizes.find(item.first) != fontSizes.end()) {
+            continue;
+        }
+
+        cachedSize.info.glyphCount = cachedSize.glyphs.size();
+        cachedSize.info.kerningCount = cachedSize.kerning.size();
+
+        write(&cachedSize.info, sizeof(cachedSize.info));
+        write(cachedSize.glyphs.data(), cachedSize.glyphs.size() * sizeof(amino_cache_glyph_t));
+        write(cachedSize.kerning.data(), cachedSize.kerning.size() * sizeof(kerning_t));
+    }
+
+    uv_mutex_unlock(&AminoText::freeTypeMutex);
+
+    //write (replace existing file)
+    std::string tmpFile = cacheFile + ".tmp";
+    FILE *file = fopen(tmpFile.c_str(), "wb");
+
+    if (!file) {
+        return false;
+    }
+
+    bool res = fwrite(out.data(), 1, out.size(), file) == out.size();
+
+    res = fclose(file) == 0 && res;
+
+    if (!res || rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+        unlink(tmpFile.c_str());
+
+        return false;
+    }
+
+    if (DEBUG_FONTS) {
+        printf("-> saved font cache: %i bytes (%s)\n", (int)out.size(), cacheFile.c_str());
+    }
+
+    return true;
+}
+
+/**
+ * Save the atlas cache.
+ */
+NAN_METHOD(AminoFont::SaveCache) {
+    AminoFont *obj = Nan::ObjectWrap::Unwrap<AminoFont>(info.This());
+
+    assert(obj);
+
+    info.GetReturnValue().Set(obj->saveCache());
+}
+
+FT_Library AminoFont::library = NULL;
+std::vector<AminoFont *> AminoFont::instances;
+
+//
+//  AminoFontFactory
+//
+
+/**
+ * Create AminoFont factory.
+ */
+AminoFontFactory::AminoFontFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFont", callback) {
+    //empty
+}
+
+/**
+ * Create AminoFonts instance.
+ */
+AminoJSObject* AminoFontFactory::create() {
+    return new AminoFont();
+}
+
+//
+// AsyncPreloadWorker
+//
+
+/**
+ * Asynchronous glyph loader.
+ */
+class AsyncPreloadWorker : public Nan::AsyncWorker {
+private:
+    AminoFontSize *fontSize;
+    std::string chars;
+
+    //result
+    size_t count = 0;
+    std::vector<amino_atlas_update_t> updates;
+
+public:
+    AsyncPreloadWorker(Nan::Callback *callback, v8::Local<v8::Object> &obj, AminoFontSize *fontSize, std::string &chars) : AsyncWorker(callback), fontSize(fontSize), chars(chars) {
+        //keep font size
+        SaveToPersistent("object", obj);
+    }
+
+    /**
+     * Async running code.
+     */
+    void Execute() {
+        if (DEBUG_FONTS) {
+            printf("-> preloading glyphs: %i bytes (%s)\n", (int)chars.size(), fontSize->font->getFontInfo().c_str());
+        }
+
+        count = fontSize->preloadGlyphs(chars, updates);
+    }
+
+    /**
+     * Upload the atlas pages.
+     */
+    void HandleOKCallback() {
+        //update all instances
+        for (auto &update : updates) {
+            AminoGfx::updateAtlasTextures(&update);
+        }
+
+        //call callback
+        v8::Local<v8::Value> argv[] = { Nan::Null(), Nan::New<v8::Number>(count) };
+
+        callback->Call(2, argv);
+    }
+};
+
+//
+// AminoFontSize
+//
+
+AminoFontSize::AminoFontSize(): AminoJSObject(getFactory()->name) {
+    static uint32_t lastId = 0;
+
+    id = ++lastId;
+}
+
+AminoFontSize::~AminoFontSize() {
+    //empty
+}
+
+/**
+ * Get factory instance.
+ */
+AminoFontSizeFactory* AminoFontSize::getFactory() {
+    static AminoFontSizeFactory *aminoFontSizeFactory = NULL;
+
+    if (!aminoFontSizeFactory) {
+        aminoFontSizeFactory = new AminoFontSizeFactory(New);
+    }
+
+    return aminoFontSizeFactory;
+}
+
+/**
+ * Initialize AminoFontSize template.
+ */
+v8::Local<v8::FunctionTemplate> AminoFontSize::GetInitFunction() {
+    v8::Local<v8::FunctionTemplate> tpl = AminoJSObject::createTemplate(getFactory());
+
+    //methods
+    Nan::SetPrototypeMethod(tpl, "_calcTextWidth", CalcTextWidth);
+    Nan::SetPrototypeMethod(tpl, "_wrapText", WrapText);
+    Nan::SetPrototypeMethod(tpl, "getFontMetrics", GetFontMetrics);
+    Nan::SetPrototypeMethod(tpl, "_preload", Preload);
+    Nan::SetPrototypeMethod(tpl, "_preloadRange", PreloadRange);
+
+    //template function
+    return tpl;
+}
+
+/**
+ * JS object construction.
+ */
+NAN_METHOD(AminoFontSize::New) {
+    AminoJSObject::createInstance(info, getFactory());
+}
+
+/**
+ * Initialize constructor values.
+ */
+void AminoFontSize::preInit(Nan::NAN_METHOD_ARGS_TYPE info) {
+    assert(info.Length() == 2);
+
+    AminoFont *font = Nan::ObjectWrap::Unwrap<AminoFont>(info[0]->ToObject());
+    int size = (int)round(info[1]->NumberValue());
+
+    assert(font);
+
+    this->font = font;
+    fontTexture = font->getFontWithSize(size);
+
+    if (!fontTexture) {
+        Nan::ThrowTypeError("could not create font size");
+        return;
+    }
+
+    //SDF glyphs are scaled
+    scale = size / fontTexture->size;
+
+    //font properties
+    v8::Local<v8::Object> obj = handle();
+
+    Nan::Set(obj, Nan::New("name").ToLocalChecked(), Nan::New<v8::String>(font->fontName).ToLocalChecked());
+    Nan::Set(obj, Nan::New("size").ToLocalChecked(), Nan::New<v8::Number>(size));
+    Nan::Set(obj, Nan::New("weight").ToLocalChecked(), Nan::New<v8::Number>(font->fontWeight));
+    Nan::Set(obj, Nan::New("style").ToLocalChecked(), Nan::New<v8::String>(font->fontStyle).ToLocalChecked());
+}
+
+/**
+ * Calculate text width.
+ */
+NAN_METHOD(AminoFontSize::CalcTextWidth) {
+    assert(info.Length() == 1);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    v8::String::Utf8Value str(info[0]);
+
+    assert(obj);
+
+    info.GetReturnValue().Set(obj->getTextWidth(*str));
+}
+
+/**
+ * Calculate text width.
+ */
+float AminoFontSize::getTextWidth(const char *text) {
+    size_t len = utf8_strlen(text);
+    char *textPos = (char *)text;
+    char *lastTextPos = NULL;
+    float w = 0;
+
+    AminoText::initFreeTypeMutex();
+    uv_mutex_lock(&AminoText::freeTypeMutex);
+
+    for (std::size_t i = 0; i < len; i++) {
+        texture_glyph_t *glyph = font->getGlyph(fontTexture, textPos);
+
+        if (!glyph) {
+            printf("Error: got empty glyph from texture_font_get_glyph()\n");
+            continue;
+        }
+
+        //kerning
+        if (lastTextPos) {
+            w += texture_font_get_kerning(fontTexture, utf8_to_utf32(lastTextPos), glyph->codepoint);
+        }
+
+        //char width
+        w += glyph->advance_x;
+
+        //next
+        size_t charLen = utf8_surrogate_len(textPos);
+
+        lastTextPos = textPos;
+        textPos += charLen;
+    }
+
+    std::vector<amino_atlas_update_t> updates;
+
+    font->takeDirtyPages(updates);
+
+    uv_mutex_unlock(&AminoText::freeTypeMutex);
+
+    //update all instances
+    for (auto &update : updates) {
+        AminoGfx::updateAtlasTextures(&update);
+    }
+
+    return w * scale;
+}
+
+/**
+ * Break text into lines (word wrapping).
+ */
+NAN_METHOD(AminoFontSize::WrapText) {
+    assert(info.Length() == 2);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    v8::String::Utf8Value str(info[0]);
+    float width = info[1]->NumberValue();
+
+    assert(obj);
+
+    std::string text = *str;
+    std::vector<std::string> lines;
+
+    obj->wrapText(text, width, lines);
+
+    //create array
+    v8::Local<v8::Array> arr = Nan::New<v8::Array>();
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        Nan::Set(arr, i, Nan::New<v8::String>(lines[i]).ToLocalChecked());
+    }
+
+    info.GetReturnValue().Set(arr);
+}
+
+/**
+ * Break text into lines (word wrapping).
+ *
+ * Note: called on main thread.
+ */
+void AminoFontSize::wrapText(const std::string &text, float width, std::vector<std::string> &lines) {
+    //main thread instance (layout thread has its own one)
+    static AminoLineBreaker lineBreaker;
+
+    AminoText::initFreeTypeMutex();
+    uv_mutex_lock(&AminoText::freeTypeMutex);
+
+    amino_text_shape_t *shape = lineBreaker.getShape(this, text);
+    std::vector<amino_text_line_t> textLines;
+
+    AminoLineBreaker::breakLines(shape, AminoText::WRAP_WORD, width, 0, textLines);
+
+    //substrings (without trailing white space)
+    size_t count = shape->chars.size();
+
+    for (auto const &line : textLines) {
+        size_t end = line.end;
+
+        while (end > line.start && (shape->chars[end - 1].flags & CHAR_SPACE)) {
+            end--;
+        }
+
+        size_t startOffset = line.start < count ? shape->chars[line.start].offset : text.size();
+        size_t endOffset = end < count ? shape->chars[end].offset : text.size();
+
+        lines.push_back(text.substr(startOffset, endOffset - startOffset));
+    }
+
+    std::vector<amino_atlas_update_t> updates;
+
+    font->takeDirtyPages(updates);
+
+    uv_mutex_unlock(&AminoText::freeTypeMutex);
+
+    //update all instances
+    for (auto &update : updates) {
+        AminoGfx::updateAtlasTextures(&update);
+    }
+}
+
+/**
+ * Preload glyphs asynchronously.
+ */
+NAN_METHOD(AminoFontSize::Preload) {
+    assert(info.Length() == 2);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    v8::String::Utf8Value str(info[0]);
+    std::string chars = *str;
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    v8::Local<v8::Object> jsObj = info.This();
+
+    assert(obj);
+
+    AsyncQueueWorker(new AsyncPreloadWorker(callback, jsObj, obj, chars));
+}
+
+/**
+ * Append a codepoint in UTF-8 encoding.
+ */
+static void appendUtf8(std::string &str, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        str += (char)codepoint;
+    } else if (codepoint < 0x800) {
+        str += (char)(0xC0 | (codepoint >> 6));
+        str += (char)(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        str += (char)(0xE0 | (codepoint >> 12));
+        str += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        str += (char)(0x80 | (codepoint & 0x3F));
+    } else {
+        str += (char)(0xF0 | (codepoint >> 18));
+        str += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        str += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        str += (char)(0x80 | (codepoint & 0x3F));
+    }
+}
+
+/**
+ * Preload a range of codepoints asynchronously.
+ */
+NAN_METHOD(AminoFontSize::PreloadRange) {
+    assert(info.Length() == 3);
+
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+    uint32_t from = info[0]->Uint32Value();
+    uint32_t to = info[1]->Uint32Value();
+
+    assert(obj);
+
+    if (from == 0 || from > to || to > 0x10FFFF || to - from >= FONT_PRELOAD_MAX_RANGE) {
+        Nan::ThrowRangeError("invalid codepoint range");
+        return;
+    }
+
+    //UTF-8 string (without surrogates)
+    std::string chars;
+
+    for (uint32_t codepoint = from; codepoint <= to; codepoint++) {
+        if (codepoint >= 0xD800 && codepoint <= 0xDFFF) {
+            continue;
+        }
+
+        appendUtf8(chars, codepoint);
+    }
+
+    Nan::Callback *callback = new Nan::Callback(info[2].As<v8::Function>());
+    v8::Local<v8::Object> jsObj = info.This();
+
+    AsyncQueueWorker(new AsyncPreloadWorker(callback, jsObj, obj, chars));
+}
+
+/**
+ * Load glyphs (without drawing them).
+ *
+ * Note: called on worker thread. The lock is released between chunks to not block the layout of texts.
+ *
+ * @param updates dirty regions (filled in)
+ * @return number of loaded glyphs
+ */
+size_t AminoFontSize::preloadGlyphs(const std::string &chars, std::vector<amino_atlas_update_t> &updates) {
+    const char *textPos = chars.c_str();
+    const char *textEnd = textPos + chars.size();
+    size_t count = 0;
+
+    AminoText::initFreeTypeMutex();
+
+    while (textPos < textEnd) {
+        uv_mutex_lock(&AminoText::freeTypeMutex);
+
+        for (size_t i = 0; i < FONT_PRELOAD_CHUNK && textPos < textEnd; i++) {
+            if (font->getGlyph(fontTexture, textPos)) {
+                count++;
+            }
+
+            textPos += utf8_surrogate_len(textPos);
+        }
+
+        uv_mutex_unlock(&AminoText::freeTypeMutex);
+    }
+
+    //upload once
+    uv_mutex_lock(&AminoText::freeTypeMutex);
+    font->takeDirtyPages(updates);
+    uv_mutex_unlock(&AminoText::freeTypeMutex);
+
+    return count;
+}
+
+/**
+ * Get a glyph.
+ *
+ * Note: freeTypeMutex must be locked.
+ */
+texture_glyph_t *AminoFontSize::getGlyph(const char *codepoint) {
+    return font->getGlyph(fontTexture, codepoint);
+}
+
+/**
+ * Get font metrics (height, ascender, descender).
+ */
+NAN_METHOD(AminoFontSize::GetFontMetrics) {
+    AminoFontSize *obj = Nan::ObjectWrap::Unwrap<AminoFontSize>(info.This());
+
+    assert(obj);
+
+    //metrics
+    v8::Local<v8::Object> metricsObj = Nan::New<v8::Object>();
+
+    float scale = obj->scale;
+
+    Nan::Set(metricsObj, Nan::New("height").ToLocalChecked(), Nan::New<v8::Number>((obj->fontTexture->ascender - obj->fontTexture->descender) * scale));
+    Nan::Set(metricsObj, Nan::New("ascender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->ascender * scale));
+    Nan::Set(metricsObj, Nan::New("descender").ToLocalChecked(), Nan::New<v8::Number>(obj->fontTexture->descender * scale));
+
+    info.GetReturnValue().Set(metricsObj);
+}
+
+//
+//  AminoFontSizeFactory
+//
+
+/**
+ * Create AminoFontSize factory.
+ */
+AminoFontSizeFactory::AminoFontSizeFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoFontSize", callback) {
+    //empty
+}
+
+/**
+ * Create AminoFonts instance.
+ */
+AminoJSObject* AminoFontSizeFactory::create() {
+    return new AminoFontSize();
+}
+
+//
+// AminoLineBreaker
+//
+
+//UAX #14 line breaking classes (subset)
+#define BREAK_AL 0 //alphabetic (default)
+#define BREAK_SP 1 //space
+#define BREAK_BK 2 //mandatory break
+#define BREAK_GL 3 //non-breaking (glue)
+#define BREAK_ZW 4 //zero width space
+#define BREAK_OP 5 //opening punctuation
+#define BREAK_CL 6 //closing punctuation
+#define BREAK_EX 7 //exclamation, interrogation
+#define BREAK_IS 8 //infix separator
+#define BREAK_NS 9 //nonstarter
+#define BREAK_HY 10 //hyphen
+#define BREAK_BA 11 //break after
+#define BREAK_ID 12 //ideographic
+#define BREAK_SA 13 //complex context (Thai, Lao, Khmer, Myanmar)
+
+/**
+ * Create line breaker.
+ */
+AminoLineBreaker::AminoLineBreaker() {
+    //empty
+}
+
+/**
+ * Destroy line breaker.
+ */
+AminoLineBreaker::~AminoLineBreaker() {
+    for (auto shape : shapes) {
+        delete shape;
+    }
+
+    shapes.clear();
+    shapeMap.clear();
+
+    if (uncached) {
+        delete uncached;
+        uncached = NULL;
+    }
+}
+
+/**
+ * Get the shaped characters of a string.
+ *
+ * The result is valid until the next call.
+ *
+ * Note: freeTypeMutex must be locked.
+ */
+amino_text_shape_t *AminoLineBreaker::getShape(AminoFontSize *fontSize, const std::string &str) {
+    //Note: the font size instance can be freed and its address reused
+    char prefix[32];
+
+    snprintf(prefix, sizeof(prefix), "%u/", fontSize->id);
+
+    std::string key = prefix + str;
+
+    //check cache
+    std::unordered_map<std::string, std::list<amino_text_shape_t *>::iterator>::iterator it = shapeMap.find(key);
+
+    if (it != shapeMap.end()) {
+        //move to front
+        shapes.splice(shapes.begin(), shapes, it->second);
+
+        return shapes.front();
+    }
+
+    //shape
+    amino_text_shape_t *shape = new amino_text_shape_t();
+
+    shape->key = key;
+    shapeText(fontSize, str, shape);
+
+    //missing glyphs (atlas full): retry next time
+    for (auto const &ch : shape->chars) {
+        if (ch.flags & CHAR_MISSING) {
+            if (uncached) {
+                delete uncached;
+            }
+
+            uncached = shape;
+
+            return shape;
+        }
+    }
+
+    //add
+    shapes.push_front(shape);
+    shapeMap[key] = shapes.begin();
+    cachedChars += shape->chars.size();
+
+    //limit cache (keep the new shape)
+    while (shapes.size() > 1 && (shapes.size() > LINE_BREAK_CACHE_SIZE || cachedChars > LINE_BREAK_CACHE_CHARS)) {
+        amino_text_shape_t *last = shapes.back();
+
+        cachedChars -= last->chars.size();
+        shapeMap.erase(last->key);
+        shapes.pop_back();
+
+        delete last;
+    }
+
+    return shape;
+}
+
+/**
+ * Get the number of cached shapes.
+ */
+size_t AminoLineBreaker::getCacheSize() {
+    return shapes.size();
+}
+
+/**
+ * Load the glyphs of a string and find the break opportunities.
+ *
+ * Note: freeTypeMutex must be locked.
+ */
+void AminoLineBreaker::shapeText(AminoFontSize *fontSize, const std::string &str, amino_text_shape_t *shape) {
+    texture_font_t *font = fontSize->fontTexture;
+    float scale = fontSize->scale;
+    float padding = font->rendermode == RENDER_SIGNED_DISTANCE_FIELD ? ceilf(font->sdf_spread) : 0;
+    const char *text = str.c_str();
+    const char *textPos = text;
+    size_t len = utf8_strlen(text);
+    uint32_t lastCodepoint = 0;
+    int lastClass = BREAK_BK;
+
+    shape->chars.resize(len);
+
+    for (size_t i = 0; i < len; i++) {
+        amino_text_char_t &ch = shape->chars[i];
+        uint32_t codepoint = utf8_to_utf32(textPos);
+        int breakClass = getBreakClass(codepoint);
+
+        ch.codepoint = codepoint;
+        ch.offset = textPos - text;
+        ch.kerning = 0;
+        ch.advance = 0;
+        ch.right = 0;
+        ch.flags = 0;
+
+        //glyph metrics
+        texture_glyph_t *glyph = fontSize->getGlyph(textPos);
+
+        if (glyph) {
+            if (i > 0) {
+                ch.kerning = texture_font_get_kerning(font, lastCodepoint, codepoint) * scale;
+            }
+
+            //Note: special character 0x9d is hidden
+            if (codepoint != 0x9d) {
+                ch.advance = glyph->advance_x * scale;
+                ch.right = (glyph->offset_x + glyph->width - padding) * scale;
+            }
+        } else {
+            ch.flags |= CHAR_MISSING;
+        }
+
+        //break opportunities
+        if (breakClass == BREAK_SP) {
+            ch.flags |= CHAR_SPACE;
+        } else if (breakClass == BREAK_BK) {
+            ch.flags |= CHAR_NEWLINE;
+        }
+
+        if (i > 0 && canBreakBetween(lastClass, breakClass)) {
+            ch.flags |= CHAR_BREAK;
+        }
+
+        //next
+        lastCodepoint = codepoint;
+        lastClass = breakClass;
+        textPos += utf8_surrogate_len(textPos);
+    }
+}
+
+/**
+ * Get the line breaking class of a character.
+ *
+ * Note: subset of UAX #14 (Latin, CJK, fullwidth punctuation and complex context scripts).
+ */
+int AminoLineBreaker::getBreakClass(uint32_t c) {
+    //ASCII
+    if (c < 0x80) {
+        switch (c) {
+            case '\n':
+                return BREAK_BK;
+
+            case ' ':
+            case '\t':
+                return BREAK_SP;
+
+            case '(':
+            case '[':
+            case '{':
+                return BREAK_OP;
+
+            case ')':
+            case ']':
+            case '}':
+                return BREAK_CL;
+
+            case '!':
+            case '?':
+                return BREAK_EX;
+
+            case ',':
+            case '.':
+            case ':':
+            case ';':
+                return BREAK_IS;
+
+            case '-':
+                return BREAK_HY;
+
+            case '|':
+                return BREAK_BA;
+
+            default:
+                return BREAK_AL;
+        }
+    }
+
+    switch (c) {
+        case 0x00A0: //no-break space
+        case 0x2007: //figure space
+        case 0x202F: //narrow no-break space
+        case 0x2060: //word joiner
+        case 0xFEFF:
+            return BREAK_GL;
+
+        case 0x200B:
+            return BREAK_ZW;
+
+        case 0x1680:
+        case 0x205F:
+        case 0x3000: //ideographic space
+            return BREAK_SP;
+
+        case 0x00AD: //soft hyphen
+        case 0x2010:
+        case 0x2012:
+        case 0x2013:
+            return BREAK_BA;
+
+        case 0x2018:
+        case 0x201C:
+        case 0x3008:
+        case 0x300A:
+        case 0x300C:
+        case 0x300E:
+        case 0x3010:
+        case 0x3014:
+        case 0x3016:
+        case 0x3018:
+        case 0x301A:
+        case 0xFF08:
+        case 0xFF3B:
+        case 0xFF5B:
+        case 0xFF62:
+            return BREAK_OP;
+
+        case 0x2019:
+        case 0x201D:
+        case 0x3001:
+        case 0x3002:
+        case 0x3009:
+        case 0x300B:
+        case 0x300D:
+        case 0x300F:
+        case 0x3011:
+        case 0x3015:
+        case 0x3017:
+        case 0x3019:
+        case 0x301B:
+        case 0xFF09:
+        case 0xFF0C:
+        case 0xFF0E:
+        case 0xFF3D:
+        case 0xFF5D:
+        case 0xFF61:
+        case 0xFF63:
+        case 0xFF64:
+            return BREAK_CL;
+
+        case 0xFF01:
+        case 0xFF1F:
+            return BREAK_EX;
+
+        case 0xFF1A:
+        case 0xFF1B:
+            return BREAK_IS;
+
+        //small kana, prolonged sound mark, iteration marks
+        case 0x3005:
+        case 0x303B:
+        case 0x3041:
+        case 0x3043:
+        case 0x3045:
+        case 0x3047:
+        case 0x3049:
+        case 0x3063:
+        case 0x3083:
+        case 0x3085:
+        case 0x3087:
+        case 0x308E:
+        case 0x3095:
+        case 0x3096:
+        case 0x309D:
+        case 0x309E:
+        case 0x30A1:
+        case 0x30A3:
+        case 0x30A5:
+        case 0x30A7:
+        case 0x30A9:
+        case 0x30C3:
+        case 0x30E3:
+        case 0x30E5:
+        case 0x30E7:
+        case 0x30EE:
+        case 0x30F5:
+        case 0x30F6:
+        case 0x30FB:
+        case 0x30FC:
+        case 0x30FD:
+        case 0x30FE:
+            return BREAK_NS;
+    }
+
+    //white space
+    if (c >= 0x2000 && c <= 0x200A) {
+        return BREAK_SP;
+    }
+
+    //complex context (needs a dictionary, only emergency breaks)
+    if ((c >= 0x0E00 && c <= 0x0EFF) || (c >= 0x1000 && c <= 0x109F) || (c >= 0x1780 && c <= 0x17FF)) {
+        return BREAK_SA;
+    }
+
+    //ideographic (CJK, kana, Hangul, fullwidth forms, emoji)
+    if ((c >= 0x2E80 && c <= 0x2FFF) ||
+        (c >= 0x3040 && c <= 0x30FF) ||
+        (c >= 0x3100 && c <= 0x4DBF) ||
+        (c >= 0x4E00 && c <= 0x9FFF) ||
+        (c >= 0xA000 && c <= 0xA4CF) ||
+        (c >= 0xAC00 && c <= 0xD7AF) ||
+        (c >= 0xF900 && c <= 0xFAFF) ||
+        (c >= 0xFE30 && c <= 0xFE4F) ||
+        (c >= 0xFF00 && c <= 0xFF60) ||
+        (c >= 0xFFE0 && c <= 0xFFE6) ||
+        (c >= 0x1F000 && c <= 0x1FAFF) ||
+        (c >= 0x20000 && c <= 0x3FFFD)) {
+        return BREAK_ID;
+    }
+
+    return BREAK_AL;
+}
+
+/**
+ * Check the pair rules of two line breaking classes.
+ */
+bool AminoLineBreaker::canBreakBetween(int before, int after) {
+    //spaces hang at the line end
+    if (after == BREAK_SP || after == BREAK_ZW || after == BREAK_BK) {
+        return false;
+    }
+
+    if (before == BREAK_ZW) {
+        return true;
+    }
+
+    //non-breaking
+    if (before == BREAK_GL || after == BREAK_GL) {
+        return false;
+    }
+
+    //no break before closing punctuation and nonstarters
+    if (after == BREAK_CL || after == BREAK_EX || after == BREAK_IS || after == BREAK_NS) {
+        return false;
+    }
+
+    //no break after opening punctuation
+    if (before == BREAK_OP) {
+        return false;
+    }
+
+    if (before == BREAK_SP || before == BREAK_BK) {
+        return true;
+    }
+
+    //ideographs
+    if (before == BREAK_ID || after == BREAK_ID) {
+        return true;
+    }
+
+    //hyphens
+    if (before == BREAK_HY || before == BREAK_BA) {
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Break a shaped text into lines.
+ *
+ * Word wrap breaks at the last break opportunity of a line, otherwise at the overflowing character. White space at the
+ * start of a wrapped line is skipped. Each character is processed at most twice (linear time).
+ */
+void AminoLineBreaker::breakLines(amino_text_shape_t *shape, int wrap, float width, int maxLines, std::vector<amino_text_line_t> &lines) {
+    std::vector<amino_text_char_t> &chars = shape->chars;
+    size_t count = chars.size();
+
+    lines.clear();
+
+    //single line
+    if (wrap == AminoText::WRAP_NONE) {
+        amino_text_line_t line = { 0, count };
+
+        lines.push_back(line);
+        return;
+    }
+
+    size_t lineStart = 0;
+    size_t breakPos = 0; //last break opportunity in current line
+    float x = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        amino_text_char_t &ch = chars[i];
+
+        //mandatory break
+        if (ch.flags & CHAR_NEWLINE) {
+            amino_text_line_t line = { lineStart, i };
+
+            lines.push_back(line);
+
+            if (maxLines > 0 && (int)lines.size() == maxLines) {
+                return;
+            }
+
+            i++;
+            lineStart = i;
+            breakPos = 0;
+            x = 0;
+            continue;
+        }
+
+        //skip white space at the start of a line (except first one)
+        if (i == lineStart && !lines.empty() && (ch.flags & CHAR_SPACE)) {
+            i++;
+            lineStart = i;
+            continue;
+        }
+
+        float kerning = i > lineStart ? ch.kerning : 0;
+
+        if (i > lineStart && (ch.flags & CHAR_BREAK)) {
+            breakPos = i;
+        }
+
+        //overflow
+        if (i > lineStart && !(ch.flags & CHAR_SPACE) && x + kerning + ch.right > width) {
+            size_t end = (wrap == AminoText::WRAP_WORD && breakPos > lineStart) ? breakPos : i;
+            amino_text_line_t line = { lineStart, end };
+
+            lines.push_back(line);
+
+            if (maxLines > 0 && (int)lines.size() == maxLines) {
+                return;
+            }
+
+            //continue with the rest of the word
+            i = end;
+            lineStart = end;
+            breakPos = 0;
+            x = 0;
+            continue;
+        }
+
+        x += kerning + ch.advance;
+        i++;
+    }
+
+    //last line
+    amino_text_line_t line = { lineStart, count };
+
+    lines.push_back(line);
+}
+
+//
+// AminoTextLayouter
+//
+
+/**
+ * Start layout thread.
+ */
+AminoTextLayouter::AminoTextLayouter() {
+    int res = uv_mutex_init(&mutex);
+
+    assert(res == 0);
+
+    res = uv_cond_init(&cond);
+
+    assert(res == 0);
+
+    res = uv_thread_create(&thread, layoutThread, this);
+
+    assert(res == 0);
+}
+
+/**
+ * Stop layout thread.
+ *
+ * Note: OpenGL context has to be bound (vertex buffers of remaining layouts are deleted).
+ */
+AminoTextLayouter::~AminoTextLayouter() {
+    uv_mutex_lock(&mutex);
+    running = false;
+    uv_cond_signal(&cond);
+    uv_mutex_unlock(&mutex);
+
+    int res = uv_thread_join(&thread);
+
+    assert(res == 0);
+
+    //free layouts
+    for (auto layout : pending) {
+        deleteLayout(layout);
+    }
+
+    for (auto layout : done) {
+        deleteLayout(layout);
+    }
+
+    pending.clear();
+    done.clear();
+
+    uv_cond_destroy(&cond);
+    uv_mutex_destroy(&mutex);
+}
+
+/**
+ * Layout thread.
+ */
+void AminoTextLayouter::layoutThread(void *arg) {
+    AminoTextLayouter *layouter = static_cast<AminoTextLayouter *>(arg);
+
+    assert(layouter);
+
+    uv_mutex_lock(&layouter->mutex);
+
+    while (true) {
+        //wait for new texts (and until the previous results were applied)
+        while (layouter->running && (layouter->pending.empty() || !layouter->done.empty())) {
+            uv_cond_wait(&layouter->cond, &layouter->mutex);
+        }
+
+        if (!layouter->running) {
+            break;
+        }
+
+        layouter->current.swap(layouter->pending);
+
+        uv_mutex_unlock(&layouter->mutex);
+
+        //layout
+        for (auto layout : layouter->current) {
+            AminoText::layoutText(layout, &layouter->lineBreaker);
+        }
+
+        //publish
+        uv_mutex_lock(&layouter->mutex);
+
+        layouter->done.swap(layouter->current);
+    }
+
+    uv_mutex_unlock(&layouter->mutex);
+}
+
+/**
+ * Add a text layout.
+ *
+ * Note: called on rendering thread.
+ */
+void AminoTextLayouter::add(amino_text_layout_t *layout) {
+    uv_mutex_lock(&mutex);
+
+    //replace older layout of same text
+    for (auto &item : pending) {
+        if (item->text == layout->text) {
+            if (!layout->buffer) {
+                layout->buffer = item->buffer;
+                item->buffer = NULL;
+            }
+
+            deleteLayout(item);
+            item = layout;
+
+            uv_mutex_unlock(&mutex);
+            return;
+        }
+    }
+
+    pending.push_back(layout);
+    uv_cond_signal(&cond);
+
+    uv_mutex_unlock(&mutex);
+}
+
+/**
+ * Cancel all layouts of a text.
+ *
+ * Note: the layouts are deleted on the rendering thread.
+ */
+void AminoTextLayouter::cancel(AminoText *text) {
+    uv_mutex_lock(&mutex);
+
+    for (auto layout : pending) {
+        if (layout->text == text) {
+            layout->text = NULL;
+        }
+    }
+
+    for (auto layout : current) {
+        if (layout->text == text) {
+            layout->text = NULL;
+        }
+    }
+
+    for (auto layout : done) {
+        if (layout->text == text) {
+            layout->text = NULL;
+        }
+    }
+
+    uv_mutex_unlock(&mutex);
+}
+
+/**
+ * Get the finished layouts.
+ *
+ * Keeps the layouter locked until endApply() is called (texts cannot be cancelled meanwhile).
+ *
+ * Note: called on rendering thread.
+ *
+ * @return NULL if there are no results
+ */
+std::vector<amino_text_layout_t *> *AminoTextLayouter::beginApply() {
+    uv_mutex_lock(&mutex);
+
+    if (done.empty()) {
+        uv_mutex_unlock(&mutex);
+
+        return NULL;
+    }
+
+    return &done;
+}
+
+/**
+ * Free the applied layouts and continue with the next texts.
+ */
+void AminoTextLayouter::endApply() {
+    for (auto layout : done) {
+        deleteLayout(layout);
+    }
+
+    done.clear();
+
+    uv_cond_signal(&cond);
+    uv_mutex_unlock(&mutex);
+}
+
+/**
+ * Number of layouts not applied yet.
+ */
+size_t AminoTextLayouter::getPendingCount() {
+    uv_mutex_lock(&mutex);
+
+    size_t count = pending.size() + current.size() + done.size();
+
+    uv_mutex_unlock(&mutex);
+
+    return count;
+}
+
+/**
+ * Free a layout.
+ *
+ * Note: has to be called on OpenGL thread.
+ */
+void AminoTextLayouter::deleteLayout(amino_text_layout_t *layout) {
+    if (layout->buffer) {
+        vertex_buffer_delete(layout->buffer);
+    }
+
+    delete layout;
+}
+
+//
+// AminoTextMeshCache
+//
+
+/**
+ * Create text mesh cache.
+ */
+AminoTextMeshCache::AminoTextMeshCache() {
+    int res = uv_mutex_init(&mutex);
+
+    assert(res == 0);
+}
+
+/**
+ * Destroy text mesh cache.
+ *
+ * Note: the meshes are owned by the texts.
+ */
+AminoTextMeshCache::~AminoTextMeshCache() {
+    for (auto &item : meshes) {
+        item.second->cached = false;
+    }
+
+    meshes.clear();
+
+    uv_mutex_destroy(&mutex);
+}
+
+/**
+ * Get the cache key of a text.
+ *
+ * Note: width and max lines are only used if wrapping.
+ */
+std::string AminoTextMeshCache::getKey(AminoFontSize *fontSize, const std::string &str, int wrap, int width, int maxLines) {
+    if (wrap == AminoText::WRAP_NONE) {
+        width = 0;
+        maxLines = 0;
+    }
+
+    //Note: the font size instance can be freed and its address reused
+    char prefix[64];
+
+    snprintf(prefix, sizeof(prefix), "%u/%i/%i/%i/", fontSize->id, wrap, width, maxLines);
+
+    return prefix + str;
+}
+
+/**
+ * Get a shared mesh (adds a reference).
+ *
+ * Note: called on rendering thread.
+ */
+amino_text_mesh_t *AminoTextMeshCache::get(const std::string &key) {
+    uv_mutex_lock(&mutex);
+
+    std::map<std::string, amino_text_mesh_t *>::iterator it = meshes.find(key);
+    amino_text_mesh_t *mesh = NULL;
+
+    if (it != meshes.end()) {
+        if (isValid(it->second)) {
+            mesh = it->second;
+            mesh->refs++;
+        } else {
+            //atlas page was repacked (users will layout again)
+            it->second->cached = false;
+            meshes.erase(it);
+        }
+    }
+
+    if (mesh) {
+        hits++;
+    } else {
+        misses++;
+    }
+
+    uv_mutex_unlock(&mutex);
+
+    return mesh;
+}
+
+/**
+ * Add a new layout (adds a reference).
+ *
+ * Returns the existing mesh if the same text was laid out meanwhile. Otherwise, the layout buffer is moved to the new mesh.
+ *
+ * Note: called on rendering thread.
+ */
+amino_text_mesh_t *AminoTextMeshCache::add(const std::string &key, amino_text_layout_t *layout) {
+    uv_mutex_lock(&mutex);
+
+    std::map<std::string, amino_text_mesh_t *>::iterator it = meshes.find(key);
+    amino_text_mesh_t *mesh;
+
+    if (it != meshes.end() && isValid(it->second)) {
+        mesh = it->second;
+        mesh->refs++;
+    } else {
+        if (it != meshes.end()) {
+            it->second->cached = false;
+        }
+
+        mesh = new amino_text_mesh_t();
+
+        mesh->key = key;
+        mesh->cached = true;
+        mesh->refs = 1;
+
+        mesh->buffer = layout->buffer;
+        mesh->batches = layout->batches;
+        mesh->lineNr = layout->lineNr;
+        mesh->lineW = layout->lineW;
+
+        layout->buffer = NULL;
+
+        meshes[key] = mesh;
+    }
+
+    uv_mutex_unlock(&mutex);
+
+    return mesh;
+}
+
+/**
+ * Release a mesh.
+ *
+ * Returns true if the mesh is no longer used (caller has to free the buffer and the mesh).
+ */
+bool AminoTextMeshCache::release(amino_text_mesh_t *mesh) {
+    uv_mutex_lock(&mutex);
+
+    assert(mesh->refs > 0);
+
+    bool unused = --mesh->refs == 0;
+
+    if (unused && mesh->cached) {
+        meshes.erase(mesh->key);
+        mesh->cached = false;
+    }
+
+    uv_mutex_unlock(&mutex);
+
+    return unused;
+}
+
+/**
+ * Check if the atlas pages of the mesh were repacked.
+ */
+bool AminoTextMeshCache::isValid(amino_text_mesh_t *mesh) {
+    for (auto const &batch : mesh->batches) {
+        if (batch.page->generation != batch.generation) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Get runtime statistics.
+ */
+void AminoTextMeshCache::getStats(v8::Local<v8::Object> &obj) {
+    uv_mutex_lock(&mutex);
+
+    v8::Local<v8::Object> meshesObj = Nan::New<v8::Object>();
+    unsigned int total = hits + misses;
+
+    Nan::Set(meshesObj, Nan::New("meshes").ToLocalChecked(), Nan::New((uint32_t)meshes.size()));
+    Nan::Set(meshesObj, Nan::New("hits").ToLocalChecked(), Nan::New(hits));
+    Nan::Set(meshesObj, Nan::New("misses").ToLocalChecked(), Nan::New(misses));
+    Nan::Set(meshesObj, Nan::New("hitRate").ToLocalChecked(), Nan::New<v8::Number>(total > 0 ? (double)hits / total : 0));
+
+    uv_mutex_unlock(&mutex);
+
+    Nan::Set(obj, Nan::New("textMeshes").ToLocalChecked(), meshesObj);
+}
+
+//
+// AminoFontShader
+//
+
+AminoFontShader::AminoFontShader() : TextureShader() {
+    //shader
+
+    //Note: using unmodified vertex shader
+    fragmentShader = R"(
+        #ifdef GL_ES
+            precision mediump float;
+        #endif
+
+        uniform float opacity;
+        uniform vec3 color;
+        uniform sampler2D tex;
+
+        varying vec2 uv;
+
+        void main() {
+            float a = texture2D(tex, uv).a;
+
+            gl_FragColor = vec4(color, opacity * a);
+        }
+    )";
+}
+
+/**
+ * Initialize the font shader.
+ */
+void AminoFontShader::initShader() {
+    TextureShader::initShader();
+
+    //uniforms
+    uColor = getUniformLocation("color");
+}
+
+/**
+ * Set color.
+ */
+void AminoFontShader::setColor(GLfloat color[3]) {
+    glUniform3f(uColor, color[0], color[1], color[2]);
+}
+
+/**
+ * Create a texture with the current content of an atlas page.
+ */
+static GLuint createAtlasTexture(texture_atlas_t *atlas) {
+    GLuint id = INVALID_TEXTURE;
+
+    //see https://webcache.googleusercontent.com/search?q=cache:EZ3HLutV3zwJ:https://github.com/rougier/freetype-gl/blob/master/texture-atlas.c+&cd=1&hl=de&ct=clnk&gl=ch
+    glGenTextures(1, &id);
+
+    assert(id != INVALID_TEXTURE);
+
+    glBindTexture(GL_TEXTURE_2D, id);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    //best quality
+    //Note: padding adjustment in freetype-gl needed to solve vertical thin line issue at boundaries (see https://github.com/rougier/freetype-gl/issues/123)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+    //much worse quality
+    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    //glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    //initial content
+    AminoText::updateTextureFromAtlas(id, atlas, NULL);
+
+    return id;
+}
+
+/**
+ * Get texture for atlas page.
+ *
+ * A repacked page gets a new texture. The previous one keeps the glyphs of the previous generation for texts which
+ * were not laid out again yet (older textures are deleted).
+ *
+ * @param textureDelta change of the texture count
+ *
+ * Note: has to be called on OpenGL thread, freeTypeMutex must be locked.
+ */
+amino_atlas_t AminoFontShader::getAtlasTexture(amino_font_page_t *page, bool createIfMissing, int &textureDelta) {
+    texture_atlas_t *atlas = page->atlas;
+    std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(atlas);
+    unsigned int generation = page->generation;
+
+    textureDelta = 0;
+
+    if (it == atlasTextures.end()) {
+        if (!createIfMissing) {
+            amino_atlas_t item = { INVALID_TEXTURE, 0, INVALID_TEXTURE, 0 };
+
+            return item;
+        }
+
+        //create new one
+        amino_atlas_t item;
+
+        item.textureId = createAtlasTexture(atlas);
+        item.generation = generation;
+        item.prevTextureId = INVALID_TEXTURE;
+        item.prevGeneration = 0;
+        textureDelta++;
+
+        atlasTextures[atlas] = item;
+
+        //debug
+        //printf("create new atlas texture: %i (total: %i)\n", item.textureId, (int)atlasTextures.size());
+
+        return item;
+    }
+
+    amino_atlas_t &item = it->second;
+
+    if (item.generation != generation) {
+        //repacked (keep the previous generation)
+        if (item.prevTextureId != INVALID_TEXTURE) {
+            glDeleteTextures(1, &item.prevTextureId);
+            textureDelta--;
+        }
+
+        item.prevTextureId = item.textureId;
+        item.prevGeneration = item.generation;
+        item.textureId = createAtlasTexture(atlas);
+        item.generation = generation;
+        textureDelta++;
+    }
+
+    return item;
+}
+
+/**
+ * Check if the glyphs of a batch are available (current or previous page generation).
+ *
+ * Note: has to be called on OpenGL thread.
+ */
+bool AminoFontShader::hasBatchTexture(const amino_text_batch_t &batch) {
+    std::map<texture_atlas_t *, amino_atlas_t>::iterator it = atlasTextures.find(batch.page->atlas);
+
+    if (it == atlasTextures.end()) {
+        return false;
+    }
+
+    amino_atlas_t &item = it->second;
+
+    if (batch.textureId == item.textureId) {
+        return batch.generation == item.generation;
+    }
+
+    return batch.textureId == item.prevTextureId && batch.generation == item.prevGeneration;
+}
+
+//
+// AminoSdfFontShader
+//
+
+AminoSdfFontShader::AminoSdfFontShader() : AminoFontShader() {
+    //shader
+
+    //Note: outline at 0.5, smoothing depends on the scale (no derivatives in OpenGL ES 2.0)
+    fragmentShader = R"(
+        #ifdef GL_ES
+            precision mediump float;
+        #endif
+
+        uniform float opacity;
+        uniform vec3 color;
+        uniform float smoothing;
+        uniform sampler2D tex;
+
+        varying vec2 uv;
+
+        void main() {
+            float d = texture2D(tex, uv).a;
+            float a = smoothstep(0.5 - smoothing, 0.5 + smoothing, d);
+
+            gl_FragColor = vec4(color, opacity * a);
+        }
+    )";
+}
+
+/**
+ * Initialize the SDF font shader.
+ */
+void AminoSdfFontShader::initShader() {
+    AminoFontShader::initShader();
+
+    //uniforms
+    uSmoothing = getUniformLocation("smoothing");
+}
+
+/**
+ * Set edge smoothing (distance field range of one screen pixel).
+ */
+void AminoSdfFontShader::setSmoothing(GLfloat smoothing) {
+    glUniform1f(uSmoothing, smoothing);
+}
+
+//
+// AminoFontBatchShader
+//
+
+AminoFontBatchShader::AminoFontBatchShader() : AnyAminoShader() {
+    //shaders
+    vertexShader = R"(
+        uniform mat4 mvp;
+        uniform mat4 trans;
+
+        attribute vec4 pos;
+        attribute vec2 texCoord;
+        attribute vec4 color;
+
+        varying vec2 uv;
+        varying vec4 vColor;
+
+        void main() {
+            gl_Position = mvp * trans * pos;
+            uv = texCoord;
+            vColor = color;
+        }
+    )";
+
+    fragmentShader = R"(
+        #ifdef GL_ES
+            precision mediump float;
+        #endif
+
+        uniform sampler2D tex;
+
+        varying vec2 uv;
+        varying vec4 vColor;
+
+        void main() {
+            float a = texture2D(tex, uv).a;
+
+            gl_FragColor = vec4(vColor.rgb, vColor.a * a);
+        }
+    )";
+}
+
+/**
+ * Initialize the font batch shader.
+ */
+void AminoFontBatchShader::initShader() {
+    AnyAminoShader::initShader();
+
+    //attributes
+    aTexCoord = getAttributeLocation("texCoord");
+    aColor = getAttributeLocation("color");
+
+    //uniforms
+    uTex = getUniformLocation("tex");
+
+    //default values
+    glUniform1i(uTex, 0); //GL_TEXTURE0
+}
+
+/**
+ * Set interleaved vertex data of the bound VBO.
+ */
+void AminoFontBatchShader::setBatchData() {
+    GLsizei stride = 9 * sizeof(GLfloat);
+
+    glVertexAttribPointer(aPos, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glVertexAttribPointer(aTexCoord, 2, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(aColor, 4, GL_FLOAT, GL_FALSE, stride, (void *)(5 * sizeof(GLfloat)));
+}
+
+/**
+ * Draw triangles.
+ */
+void AminoFontBatchShader::drawTriangles(GLsizei vertices, GLenum mode) {
+    glEnableVertexAttribArray(aTexCoord);
+    glEnableVertexAttribArray(aColor);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    AnyAminoShader::drawTriangles(vertices, mode);
+
+    glDisableVertexAttribArray(aTexCoord);
+    glDisableVertexAttribArray(aColor);
 }
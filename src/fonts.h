@@ -5,6 +5,10 @@
 #include "vertex-buffer.h"
 
 #include <map>
+#include <list>
+#include <vector>
+#include <atomic>
+#include <unordered_map>
 
 #include "base_js.h"
 #include "gfx.h"
@@ -43,6 +47,83 @@ public:
 
 class AminoFontFactory;
 
+//glyph atlas pages
+#define FONT_ATLAS_SIZE      512
+#define FONT_ATLAS_MAX_PAGES 4
+
+//signed distance field fonts (glyphs rasterized once at base size)
+#define FONT_SDF_BASE_SIZE 48
+
+//glyph preloading (glyphs per lock, max range)
+#define FONT_PRELOAD_CHUNK     32
+#define FONT_PRELOAD_MAX_RANGE 0x10000
+
+/**
+ * Glyph atlas page.
+ *
+ * Note: never moved while the font exists.
+ */
+struct amino_font_page_t {
+    texture_atlas_t *atlas;
+    std::atomic<unsigned int> generation; //incremented after repacking (read by rendering thread)
+};
+
+//glyph atlas cache file format
+#define FONT_CACHE_VERSION 1
+
+/**
+ * Cached glyph (atlas cache file).
+ */
+struct amino_cache_glyph_t {
+    uint32_t codepoint;
+    uint32_t page;
+    uint32_t width;
+    uint32_t height;
+    int32_t offsetX;
+    int32_t offsetY;
+    float advanceX;
+    float advanceY;
+    float s0;
+    float t0;
+    float s1;
+    float t1;
+};
+
+/**
+ * Cached font size (atlas cache file).
+ */
+struct amino_cache_size_t {
+    int32_t size;
+
+    //freetype-gl settings
+    int32_t rendermode;
+    float outlineThickness;
+    int32_t hinting;
+    int32_t filtering;
+
+    uint32_t glyphCount;
+    uint32_t kerningCount;
+};
+
+/**
+ * Cached glyphs of a font size (not used yet).
+ */
+struct amino_cached_font_size_t {
+    amino_cache_size_t info;
+    std::vector<amino_cache_glyph_t> glyphs;
+    std::vector<kerning_t> kerning;
+};
+
+/**
+ * Atlas texture update (dirty regions).
+ */
+struct amino_atlas_update_t {
+    texture_atlas_t *atlas;
+    amino_font_page_t *page;
+    size_t count;
+    ivec4 rects[TEXTURE_ATLAS_DIRTY_MAX];
+};
+
 /**
  * AminoFont class.
  */
@@ -51,6 +132,7 @@ public:
     std::string fontName;
     int fontWeight;
     std::string fontStyle;
+    bool sdf = false; //signed distance field glyphs (all sizes)
 
     AminoFont();
     ~AminoFont();
@@ -58,6 +140,22 @@ public:
     texture_font_t *getFontWithSize(int size);
     std::string getFontInfo();
 
+    //glyphs (Note: freeTypeMutex must be locked)
+    texture_glyph_t *getGlyph(texture_font_t *fontTexture, const char *codepoint);
+
+    //atlas pages (Note: freeTypeMutex must be locked)
+    size_t getPageCount();
+    amino_font_page_t *getPage(size_t index);
+    unsigned int getEvictions();
+    bool hasDirtyPages();
+    void takeDirtyPages(std::vector<amino_atlas_update_t> &updates);
+
+    //stats
+    static void getStats(v8::Local<v8::Object> &obj);
+
+    //cache
+    bool saveCache();
+
     //creation
     static AminoFontFactory* getFactory();
 
@@ -67,18 +165,41 @@ public:
 private:
     //Note: instance kept
     static FT_Library library;
+    static std::vector<AminoFont *> instances;
 
     //JS constructor
     static NAN_METHOD(New);
 
+    //JS methods
+    static NAN_METHOD(SaveCache);
+
     void preInit(Nan::NAN_METHOD_ARGS_TYPE info) override;
 
 protected:
     AminoFonts *fonts = NULL;
-    texture_atlas_t *atlas = NULL;
     Nan::Persistent<v8::Object> fontData;
     std::map<int, texture_font_t *> fontSizes;
 
+    //atlas pages (shared by all sizes)
+    std::vector<amino_font_page_t *> pages;
+    size_t currentPage = 0;
+    size_t maxPages = FONT_ATLAS_MAX_PAGES;
+    size_t glyphUses = 0;
+    unsigned int evictions = 0;
+
+    //atlas cache (sizes not used yet)
+    std::string cacheFile;
+    uint64_t cacheKey = 0;
+    std::map<int, amino_cached_font_size_t> cachedSizes;
+
+    bool addPage();
+    bool nextPage();
+    void repackPage(size_t index);
+
+    std::string getCacheFile(std::string dir);
+    bool loadCache();
+    void restoreCachedSize(int size, texture_font_t *fontSize);
+
     void destroy() override;
     void destroyAminoFont();
 };
@@ -102,11 +223,16 @@ class AminoFontSize : public AminoJSObject {
 public:
     texture_font_t *fontTexture = NULL;
     AminoFont *font = NULL;
+    float scale = 1.f; //font size / glyph size (SDF fonts)
+    uint32_t id; //unique (never reused)
 
     AminoFontSize();
     ~AminoFontSize();
 
     float getTextWidth(const char *text);
+    void wrapText(const std::string &text, float width, std::vector<std::string> &lines);
+    texture_glyph_t *getGlyph(const char *codepoint);
+    size_t preloadGlyphs(const std::string &chars, std::vector<amino_atlas_update_t> &updates);
 
     //creation
     static AminoFontSizeFactory* getFactory();
@@ -120,7 +246,10 @@ private:
 
     //JS methods
     static NAN_METHOD(CalcTextWidth);
+    static NAN_METHOD(WrapText);
     static NAN_METHOD(GetFontMetrics);
+    static NAN_METHOD(Preload);
+    static NAN_METHOD(PreloadRange);
 
     void preInit(Nan::NAN_METHOD_ARGS_TYPE info) override;
 };
@@ -137,9 +266,197 @@ public:
 
 /**
  * Atlas texture (per AminoGfx instance).
+ *
+ * The texture of the previous page generation is kept after repacking (texts are drawn until their new layout is applied).
  */
 struct amino_atlas_t {
     GLuint textureId;
+    unsigned int generation;
+    GLuint prevTextureId;
+    unsigned int prevGeneration;
+};
+
+/**
+ * Text draw batch (glyphs on the same atlas page).
+ */
+struct amino_text_batch_t {
+    amino_font_page_t *page;
+    unsigned int generation;
+    GLuint textureId;
+    size_t start; //first index
+    size_t count; //index count
+};
+
+class AminoText;
+
+//line breaking (cached shapes, cached characters)
+#define LINE_BREAK_CACHE_SIZE  64
+#define LINE_BREAK_CACHE_CHARS 0x40000
+
+//character flags
+#define CHAR_SPACE   0x1 //white space (hangs at line end)
+#define CHAR_NEWLINE 0x2 //mandatory break
+#define CHAR_BREAK   0x4 //break opportunity before the character
+#define CHAR_MISSING 0x8 //glyph not available
+
+/**
+ * Shaped character (advances are scaled).
+ */
+struct amino_text_char_t {
+    uint32_t codepoint;
+    uint32_t offset; //UTF-8 byte offset
+    float kerning; //to previous character
+    float advance;
+    float right; //visible extent (overflow check)
+    uint32_t flags;
+};
+
+/**
+ * Shaped text (advances and break opportunities of a string).
+ */
+struct amino_text_shape_t {
+    std::string key;
+    std::vector<amino_text_char_t> chars;
+};
+
+/**
+ * Line of text (character range).
+ */
+struct amino_text_line_t {
+    size_t start;
+    size_t end;
+};
+
+/**
+ * Line breaker.
+ *
+ * Shapes a string once (glyph advances, kerning and break opportunities based on the UAX #14 pair rules) and keeps the
+ * result in an LRU cache. Breaking the lines for another width is a linear pass over the cached characters.
+ *
+ * Note: not thread-safe (one instance per thread), freeTypeMutex must be locked while shaping.
+ */
+class AminoLineBreaker {
+public:
+    AminoLineBreaker();
+    ~AminoLineBreaker();
+
+    amino_text_shape_t *getShape(AminoFontSize *fontSize, const std::string &str);
+    static void breakLines(amino_text_shape_t *shape, int wrap, float width, int maxLines, std::vector<amino_text_line_t> &lines);
+
+    size_t getCacheSize();
+
+private:
+    std::list<amino_text_shape_t *> shapes; //most recently used first
+    std::unordered_map<std::string, std::list<amino_text_shape_t *>::iterator> shapeMap;
+    size_t cachedChars = 0;
+
+    //shape with missing glyphs (not cached)
+    amino_text_shape_t *uncached = NULL;
+
+    static void shapeText(AminoFontSize *fontSize, const std::string &str, amino_text_shape_t *shape);
+    static int getBreakClass(uint32_t codepoint);
+    static bool canBreakBetween(int before, int after);
+};
+
+/**
+ * Text layout (input values and result).
+ */
+struct amino_text_layout_t {
+    AminoText *text; //NULL if cancelled
+
+    //input
+    AminoFontSize *fontSize;
+    std::string str;
+    int wrap;
+    int width;
+    int maxLines;
+
+    //result
+    vertex_buffer_t *buffer; //back buffer
+    std::vector<amino_text_batch_t> batches;
+    int lineNr;
+    float lineW;
+};
+
+/**
+ * Text layout thread.
+ *
+ * Renders glyphs and creates the vertices of modified texts. The rendering thread applies the results in the next frame.
+ *
+ * Note: waits until the previous results were applied. The rendering thread only locks freeTypeMutex while the layout thread is idle.
+ */
+class AminoTextLayouter {
+public:
+    AminoTextLayouter();
+    ~AminoTextLayouter();
+
+    void add(amino_text_layout_t *layout);
+    void cancel(AminoText *text);
+
+    std::vector<amino_text_layout_t *> *beginApply();
+    void endApply();
+
+    size_t getPendingCount();
+
+private:
+    uv_thread_t thread;
+    uv_mutex_t mutex;
+    uv_cond_t cond;
+    bool running = true;
+
+    std::vector<amino_text_layout_t *> pending;
+    std::vector<amino_text_layout_t *> current;
+    std::vector<amino_text_layout_t *> done;
+
+    //used by layout thread
+    AminoLineBreaker lineBreaker;
+
+    static void layoutThread(void *arg);
+    static void deleteLayout(amino_text_layout_t *layout);
+};
+
+/**
+ * Text mesh (layout result shared by texts with identical content).
+ */
+struct amino_text_mesh_t {
+    std::string key;
+    bool cached; //found by lookups
+    unsigned int refs;
+
+    vertex_buffer_t *buffer;
+    std::vector<amino_text_batch_t> batches;
+    int lineNr;
+    float lineW;
+};
+
+/**
+ * Text mesh cache.
+ *
+ * Texts with the same font size, text and wrapping values share their vertex buffer. The meshes are reference counted and
+ * freed as soon as the last text releases them.
+ *
+ * Note: one instance per AminoGfx (OpenGL buffers). Lookups are done on the rendering thread, texts might be released on the main thread.
+ */
+class AminoTextMeshCache {
+public:
+    AminoTextMeshCache();
+    ~AminoTextMeshCache();
+
+    static std::string getKey(AminoFontSize *fontSize, const std::string &str, int wrap, int width, int maxLines);
+
+    amino_text_mesh_t *get(const std::string &key);
+    amino_text_mesh_t *add(const std::string &key, amino_text_layout_t *layout);
+    bool release(amino_text_mesh_t *mesh);
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+private:
+    uv_mutex_t mutex;
+    std::map<std::string, amino_text_mesh_t *> meshes;
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+
+    static bool isValid(amino_text_mesh_t *mesh);
 };
 
 /**
@@ -151,15 +468,55 @@ public:
 
     void setColor(GLfloat color[3]);
 
-    amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    amino_atlas_t getAtlasTexture(amino_font_page_t *page, bool createIfMissing, int &textureDelta);
+    bool hasBatchTexture(const amino_text_batch_t &batch);
 
 protected:
     GLint uColor;
 
-    //textures (Note: never destroyed)
+    //textures (Note: never destroyed, previous generation replaced on next repack)
     std::map<texture_atlas_t *, amino_atlas_t> atlasTextures;
 
     void initShader() override;
 };
 
+/**
+ * Signed distance field font shader.
+ *
+ * Note: uses the atlas textures of AminoFontShader.
+ */
+class AminoSdfFontShader : public AminoFontShader {
+public:
+    AminoSdfFontShader();
+
+    void setSmoothing(GLfloat smoothing);
+
+protected:
+    GLint uSmoothing;
+
+    void initShader() override;
+};
+
+/**
+ * Font shader using per vertex color and opacity (batched text rendering).
+ *
+ * Interleaved vertex data: x, y, z, u, v, r, g, b, opacity.
+ */
+class AminoFontBatchShader : public AnyAminoShader {
+public:
+    AminoFontBatchShader();
+
+    //per vertex data (VBO)
+    void setBatchData();
+
+    //draw
+    void drawTriangles(GLsizei vertices, GLenum mode) override;
+
+protected:
+    GLint aTexCoord, aColor;
+    GLint uTex;
+
+    void initShader() override;
+};
+
 #endif
\ No newline at end of file
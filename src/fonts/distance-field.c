@@ -37,8 +37,13 @@
 #include "edtaa3func.h"
 
 
-double *
-make_distance_mapd( double *data, unsigned int width, unsigned int height )
+/*
+ * Bipolar distance field (outside - inside) in pixels.
+ *
+ * Note: inverts data.
+ */
+static double *
+make_bipolar_distance_map( double *data, unsigned int width, unsigned int height )
 {
     short * xdist = (short *)  malloc( width * height * sizeof(short) );
     short * ydist = (short *)  malloc( width * height * sizeof(short) );
@@ -46,7 +51,6 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
     double * gy      = (double *) calloc( width * height, sizeof(double) );
     double * outside = (double *) calloc( width * height, sizeof(double) );
     double * inside  = (double *) calloc( width * height, sizeof(double) );
-    double vmin = DBL_MAX;
     unsigned int i;
 
     // Compute outside = edtaa3(bitmap); % Transform background (0's)
@@ -69,8 +73,25 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
 
     // distmap = outside - inside; % Bipolar distance field
     for( i=0; i<width*height; ++i)
-    {
         outside[i] -= inside[i];
+
+    free( xdist );
+    free( ydist );
+    free( gx );
+    free( gy );
+    free( inside );
+    return outside;
+}
+
+double *
+make_distance_mapd( double *data, unsigned int width, unsigned int height )
+{
+    double * outside = make_bipolar_distance_map( data, width, height );
+    double vmin = DBL_MAX;
+    unsigned int i;
+
+    for( i=0; i<width*height; ++i)
+    {
         if( outside[i] < vmin )
             vmin = outside[i];
     }
@@ -85,12 +106,7 @@ make_distance_mapd( double *data, unsigned int width, unsigned int height )
         data[i] = (outside[i]+vmin)/(2*vmin);
     }
 
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
     free( outside );
-    free( inside );
     return data;
 }
 
@@ -130,3 +146,48 @@ make_distance_mapb( unsigned char *img,
 
     return out;
 }
+
+unsigned char *
+make_distance_map_spread( unsigned char *img,
+                          unsigned int width, unsigned int height,
+                          double spread )
+{
+    double * data = (double *) calloc( width * height, sizeof(double) );
+    unsigned char *out = (unsigned char *) malloc( width * height * sizeof(unsigned char) );
+    double * dist;
+    int empty = 1;
+    unsigned int i;
+
+    // Map values from 0 - 255 to 0.0 - 1.0
+    for( i=0; i<width*height; ++i)
+    {
+        data[i] = img[i] / 255.0;
+        if( img[i] )
+            empty = 0;
+    }
+
+    // no outline (e.g. space)
+    if( empty )
+    {
+        memset( out, 0, width * height );
+        free( data );
+        return out;
+    }
+
+    dist = make_bipolar_distance_map( data, width, height );
+
+    // map distances from +spread (outside) - -spread (inside) to 0 - 255
+    for( i=0; i<width*height; ++i)
+    {
+        double v = 0.5 - dist[i] / (2 * spread);
+
+        if     ( v < 0.0 ) v = 0.0;
+        else if( v > 1.0 ) v = 1.0;
+        out[i] = (unsigned char)(255 * v + 0.5);
+    }
+
+    free( dist );
+    free( data );
+
+    return out;
+}
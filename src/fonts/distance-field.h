@@ -85,6 +85,26 @@ unsigned char *
 make_distance_mapb( unsigned char *img,
                     unsigned int width, unsigned int height );
 
+/**
+ * Create a distance field with a fixed spread from the given image.
+ *
+ * Unlike make_distance_mapb, the distances are not normalized per image:
+ * the outline is at 128 and the value changes by 128/spread per pixel.
+ * All glyphs of a font therefore share the same scale.
+ *
+ * @param img     A greyscale image.
+ * @param width   The width of the given image.
+ * @param height  The height of the given image.
+ * @param spread  The maximum distance in pixels.
+ *
+ * @return        A newly allocated distance field.  This image must
+ *                be freed after usage.
+ */
+unsigned char *
+make_distance_map_spread( unsigned char *img,
+                          unsigned int width, unsigned int height,
+                          double spread );
+
 /** @} */
 
 #ifdef __cplusplus
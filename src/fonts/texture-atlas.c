@@ -64,6 +64,7 @@ texture_atlas_new( const size_t width,
     self->height = height;
     self->depth = depth;
     self->id = 0;
+    self->dirty_count = 0;
 
     vector_push_back( self->nodes, &node );
     self->data = (unsigned char *)
@@ -94,6 +95,84 @@ texture_atlas_delete( texture_atlas_t *self )
 }
 
 
+// ---------------------------------------------- texture_atlas_add_dirty ---
+static void
+texture_atlas_add_dirty( texture_atlas_t * self,
+                         const int x,
+                         const int y,
+                         const int width,
+                         const int height )
+{
+    size_t i, best = 0;
+    long best_waste = LONG_MAX;
+
+    if( width <= 0 || height <= 0 )
+    {
+        return;
+    }
+
+    // Find the region which grows least if merged
+    for( i=0; i<self->dirty_count; ++i )
+    {
+        ivec4 *r = &self->dirty[i];
+        int x0 = r->x < x ? r->x : x;
+        int y0 = r->y < y ? r->y : y;
+        int x1 = r->x + r->width > x + width ? r->x + r->width : x + width;
+        int y1 = r->y + r->height > y + height ? r->y + r->height : y + height;
+        long waste = (long)(x1 - x0) * (y1 - y0)
+                   - (long)r->width * r->height
+                   - (long)width * height;
+
+        if( waste < best_waste )
+        {
+            best_waste = waste;
+            best = i;
+        }
+    }
+
+    if( best_waste > 0 && self->dirty_count < TEXTURE_ATLAS_DIRTY_MAX )
+    {
+        ivec4 *r = &self->dirty[self->dirty_count++];
+
+        r->x = x;
+        r->y = y;
+        r->width = width;
+        r->height = height;
+    }
+    else
+    {
+        ivec4 *r = &self->dirty[best];
+        int x0 = r->x < x ? r->x : x;
+        int y0 = r->y < y ? r->y : y;
+        int x1 = r->x + r->width > x + width ? r->x + r->width : x + width;
+        int y1 = r->y + r->height > y + height ? r->y + r->height : y + height;
+
+        r->x = x0;
+        r->y = y0;
+        r->width = x1 - x0;
+        r->height = y1 - y0;
+    }
+}
+
+
+// ---------------------------------------------- texture_atlas_take_dirty ---
+size_t
+texture_atlas_take_dirty( texture_atlas_t * self,
+                          ivec4 * rects )
+{
+    size_t count;
+
+    assert( self );
+    assert( rects );
+
+    count = self->dirty_count;
+    memcpy( rects, self->dirty, count * sizeof(ivec4) );
+    self->dirty_count = 0;
+
+    return count;
+}
+
+
 // ----------------------------------------------- texture_atlas_set_region ---
 void
 texture_atlas_set_region( texture_atlas_t * self,
@@ -123,6 +202,8 @@ texture_atlas_set_region( texture_atlas_t * self,
         memcpy( self->data+((y+i)*self->width + x ) * charsize * depth,
                 data + (i*stride) * charsize, width * charsize * depth  );
     }
+
+    texture_atlas_add_dirty( self, x, y, width, height );
 }
 
 
@@ -296,4 +377,11 @@ texture_atlas_clear( texture_atlas_t * self )
 
     vector_push_back( self->nodes, &node );
     memset( self->data, 0, self->width*self->height*self->depth );
+
+    // Everything has to be uploaded again
+    self->dirty_count = 1;
+    self->dirty[0].x = 0;
+    self->dirty[0].y = 0;
+    self->dirty[0].width = self->width;
+    self->dirty[0].height = self->height;
 }
@@ -96,6 +96,11 @@ namespace ftgl {
  */
 
 
+/**
+ * Maximum number of dirty regions (merged if exceeded).
+ */
+#define TEXTURE_ATLAS_DIRTY_MAX 4
+
 /**
  * A texture atlas is used to pack several small regions into a single texture.
  */
@@ -136,6 +141,16 @@ typedef struct texture_atlas_t
      */
     unsigned char * data;
 
+    /**
+     * Regions changed since last texture_atlas_take_dirty call
+     */
+    ivec4 dirty[TEXTURE_ATLAS_DIRTY_MAX];
+
+    /**
+     * Number of dirty regions
+     */
+    size_t dirty_count;
+
 } texture_atlas_t;
 
 
@@ -201,6 +216,18 @@ typedef struct texture_atlas_t
                             const unsigned char *data,
                             const size_t stride );
 
+/**
+ *  Get and reset the regions changed since the last call.
+ *
+ *  @param self   a texture atlas structure
+ *  @param rects  array of TEXTURE_ATLAS_DIRTY_MAX items
+ *  @return       number of dirty regions
+ *
+ */
+  size_t
+  texture_atlas_take_dirty( texture_atlas_t * self,
+                            ivec4 * rects );
+
 /**
  *  Remove all allocated regions from the atlas.
  *
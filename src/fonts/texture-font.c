@@ -50,6 +50,9 @@
 #define HRESf 64.f
 #define DPI   72
 
+//kerning cache limit (pairs are reset if reached)
+#define KERNING_MAP_MAX_CAPACITY 65536
+
 #undef __FTERRORS_H__
 #define FT_ERRORDEF( e, v, s )  { e, s },
 #define FT_ERROR_START_LIST     {
@@ -207,7 +210,8 @@ texture_glyph_new(void)
     self->t0        = 0.0;
     self->s1        = 0.0;
     self->t1        = 0.0;
-    self->kerning   = vector_new( sizeof(kerning_t) );
+    self->atlas     = NULL;
+    self->last_use  = 0;
     return self;
 }
 
@@ -217,67 +221,307 @@ void
 texture_glyph_delete( texture_glyph_t *self )
 {
     assert( self );
-    vector_delete( self->kerning );
     free( self );
 }
 
-// ---------------------------------------------- texture_glyph_get_kerning ---
-float
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const char * codepoint )
+// ------------------------------------------------------- texture_hash_u32 ---
+static size_t
+texture_hash_u32( uint32_t value )
 {
-    size_t i;
-    uint32_t ucodepoint = utf8_to_utf32( codepoint );
+    value ^= value >> 16;
+    value *= 0x85EBCA6Bu;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35u;
+    value ^= value >> 16;
 
-    assert( self );
-    for( i=0; i<vector_size(self->kerning); ++i )
+    return value;
+}
+
+// -------------------------------------------------- texture_glyph_matches ---
+static int
+texture_glyph_matches( const texture_font_t * self,
+                       const texture_glyph_t * glyph,
+                       uint32_t ucodepoint )
+{
+    // If codepoint is -1, we don't care about outline type or thickness
+    return (glyph->codepoint == ucodepoint) &&
+           ((ucodepoint == UINT32_MAX) ||
+            ((glyph->rendermode == self->rendermode) &&
+             (glyph->outline_thickness == self->outline_thickness)));
+}
+
+// --------------------------------------------- texture_font_glyph_map_put ---
+static void
+texture_font_glyph_map_put( texture_glyph_t ** map, size_t capacity,
+                            texture_glyph_t * glyph )
+{
+    size_t mask = capacity - 1;
+    size_t i = texture_hash_u32( glyph->codepoint ) & mask;
+
+    while( map[i] )
     {
-        kerning_t * kerning = (kerning_t *) vector_get( self->kerning, i );
-        if( kerning->codepoint == ucodepoint )
+        i = (i + 1) & mask;
+    }
+
+    map[i] = glyph;
+}
+
+// -------------------------------------------- texture_font_index_glyph ---
+static int
+texture_font_index_glyph( texture_font_t * self, texture_glyph_t * glyph )
+{
+    size_t count = vector_size( self->glyphs );
+
+    /* Keep load factor below 1/2 (glyph already in glyphs vector) */
+    if( count * 2 > self->glyph_map_capacity )
+    {
+        size_t capacity = self->glyph_map_capacity ? self->glyph_map_capacity * 2 : 64;
+        texture_glyph_t ** map;
+        size_t i;
+
+        while( count * 2 > capacity )
+        {
+            capacity *= 2;
+        }
+
+        map = (texture_glyph_t **) calloc( capacity, sizeof(texture_glyph_t *) );
+        if( !map )
         {
-            return kerning->kerning;
+            fprintf( stderr,
+                    "line %d: No more memory for allocating data\n", __LINE__);
+            return 0;
         }
+
+        /* Rehash (includes new glyph) */
+        for( i = 0; i < count; ++i )
+        {
+            texture_font_glyph_map_put( map, capacity,
+                                        *(texture_glyph_t **) vector_get( self->glyphs, i ) );
+        }
+
+        free( self->glyph_map );
+        self->glyph_map = map;
+        self->glyph_map_capacity = capacity;
+
+        return 1;
     }
-    return 0;
+
+    texture_font_glyph_map_put( self->glyph_map, self->glyph_map_capacity, glyph );
+
+    return 1;
 }
 
+// ------------------------------------------------ texture_font_add_glyph ---
+int
+texture_font_add_glyph( texture_font_t * self, texture_glyph_t * glyph )
+{
+    vector_push_back( self->glyphs, &glyph );
 
-// ------------------------------------------ texture_font_generate_kerning ---
+    if( !texture_font_index_glyph( self, glyph ) )
+    {
+        vector_erase( self->glyphs, vector_size( self->glyphs ) - 1 );
+        return 0;
+    }
+
+    return 1;
+}
+
+// --------------------------------------------- texture_font_remove_glyph ---
 void
-texture_font_generate_kerning( texture_font_t *self)
+texture_font_remove_glyph( texture_font_t * self, size_t index )
 {
-    size_t i, j;
-    FT_UInt glyph_index, prev_index;
-    texture_glyph_t *glyph, *prev_glyph;
-    FT_Vector kerning;
+    texture_glyph_t *glyph;
+    size_t mask, i, j, k;
 
     assert( self );
-    assert(self->library);
-    assert(self->face);
+    assert( index < vector_size( self->glyphs ) );
+
+    glyph = *(texture_glyph_t **) vector_get( self->glyphs, index );
+    vector_erase( self->glyphs, index );
+
+    /* Remove from map (backward shift deletion) */
+    mask = self->glyph_map_capacity - 1;
+    i = texture_hash_u32( glyph->codepoint ) & mask;
 
-    /* For each glyph couple combination, check if kerning is necessary */
-    /* Starts at index 1 since 0 is for the special background glyph */
-    for( i=1; i<self->glyphs->size; ++i )
+    while( self->glyph_map[i] != glyph )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        glyph_index = FT_Get_Char_Index( self->face, glyph->codepoint );
-        vector_clear( glyph->kerning );
+        assert( self->glyph_map[i] );
+        i = (i + 1) & mask;
+    }
+
+    self->glyph_map[i] = NULL;
+    j = i;
+
+    for( ;; )
+    {
+        j = (j + 1) & mask;
+
+        if( !self->glyph_map[j] )
+        {
+            break;
+        }
 
-        for( j=1; j<self->glyphs->size; ++j )
+        /* Move entry if its home slot is not within (i, j] */
+        k = texture_hash_u32( self->glyph_map[j]->codepoint ) & mask;
+
+        if( (i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)) )
         {
-            prev_glyph = *(texture_glyph_t **) vector_get( self->glyphs, j );
-            prev_index = FT_Get_Char_Index( self->face, prev_glyph->codepoint );
-            FT_Get_Kerning( self->face, prev_index, glyph_index, FT_KERNING_UNFITTED, &kerning );
-            // printf("%c(%d)-%c(%d): %ld\n",
-            //       prev_glyph->codepoint, prev_glyph->codepoint,
-            //       glyph_index, glyph_index, kerning.x);
-            if( kerning.x )
+            continue;
+        }
+
+        self->glyph_map[i] = self->glyph_map[j];
+        self->glyph_map[j] = NULL;
+        i = j;
+    }
+
+    texture_glyph_delete( glyph );
+}
+
+// ------------------------------------------ texture_font_kerning_slot ---
+static kerning_t *
+texture_font_kerning_slot( texture_font_t * self,
+                           uint32_t left, uint32_t right )
+{
+    size_t mask, i;
+    kerning_t *entry;
+
+    /* Reset cache if full (new pairs are rare once the text is stable) */
+    if( (self->kerning_map_count + 1) * 2 > self->kerning_map_capacity )
+    {
+        size_t capacity = self->kerning_map_capacity ? self->kerning_map_capacity * 2 : 256;
+        kerning_t *map;
+
+        if( capacity > KERNING_MAP_MAX_CAPACITY )
+        {
+            capacity = KERNING_MAP_MAX_CAPACITY;
+        }
+
+        map = (kerning_t *) calloc( capacity, sizeof(kerning_t) );
+        if( !map )
+        {
+            fprintf( stderr,
+                    "line %d: No more memory for allocating data\n", __LINE__);
+            return NULL;
+        }
+
+        /* Rehash */
+        if( capacity > self->kerning_map_capacity )
+        {
+            for( i = 0; i < self->kerning_map_capacity; ++i )
             {
-                kerning_t k = {prev_glyph->codepoint, kerning.x / (float)(HRESf*HRESf)};
-                vector_push_back( glyph->kerning, &k );
+                kerning_t *item = &self->kerning_map[i];
+                size_t pos;
+
+                if( !item->left )
+                {
+                    continue;
+                }
+
+                pos = texture_hash_u32( item->left * 31 + item->right ) & (capacity - 1);
+
+                while( map[pos].left )
+                {
+                    pos = (pos + 1) & (capacity - 1);
+                }
+
+                map[pos] = *item;
             }
+        } else {
+            self->kerning_map_count = 0;
         }
+
+        free( self->kerning_map );
+        self->kerning_map = map;
+        self->kerning_map_capacity = capacity;
+    }
+
+    /* Existing or empty slot */
+    mask = self->kerning_map_capacity - 1;
+    i = texture_hash_u32( left * 31 + right ) & mask;
+
+    for( ;; )
+    {
+        entry = &self->kerning_map[i];
+
+        if( !entry->left || (entry->left == left && entry->right == right) )
+        {
+            return entry;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+// ------------------------------------------------ texture_font_get_kerning ---
+float
+texture_font_get_kerning( texture_font_t * self,
+                          uint32_t left, uint32_t right )
+{
+    FT_UInt left_index, right_index;
+    FT_Vector kerning;
+    kerning_t *entry;
+
+    assert( self );
+    assert( self->face );
+
+    if( !self->kerning || !FT_HAS_KERNING( self->face ) || !left || !right )
+    {
+        return 0;
+    }
+
+    entry = texture_font_kerning_slot( self, left, right );
+    if( !entry )
+    {
+        return 0;
+    }
+
+    /* Cached pair */
+    if( entry->left )
+    {
+        return entry->kerning;
+    }
+
+    /* Compute pair (cached even if zero) */
+    left_index = FT_Get_Char_Index( self->face, left );
+    right_index = FT_Get_Char_Index( self->face, right );
+    FT_Get_Kerning( self->face, left_index, right_index, FT_KERNING_UNFITTED, &kerning );
+
+    entry->left = left;
+    entry->right = right;
+    entry->kerning = kerning.x / (float)(HRESf*HRESf);
+    self->kerning_map_count++;
+
+    return entry->kerning;
+}
+
+// ------------------------------------------------ texture_font_set_kerning ---
+void
+texture_font_set_kerning( texture_font_t * self,
+                          uint32_t left, uint32_t right, float kerning )
+{
+    kerning_t *entry;
+
+    assert( self );
+
+    if( !left || !right )
+    {
+        return;
+    }
+
+    entry = texture_font_kerning_slot( self, left, right );
+    if( !entry )
+    {
+        return;
     }
+
+    if( !entry->left )
+    {
+        entry->left = left;
+        entry->right = right;
+        self->kerning_map_count++;
+    }
+
+    entry->kerning = kerning;
 }
 
 // ------------------------------------------------------ texture_font_init ---
@@ -298,6 +542,7 @@ texture_font_init(texture_font_t *self, FT_Library library)
     self->descender = 0;
     self->rendermode = RENDER_NORMAL;
     self->outline_thickness = 0.0;
+    self->sdf_spread = 4.0;
     self->hinting = 1;
     self->kerning = 1;
     self->filtering = 1;
@@ -445,6 +690,8 @@ texture_font_delete( texture_font_t *self )
     }
 
     vector_delete( self->glyphs );
+    free( self->glyph_map );
+    free( self->kerning_map );
     free( self );
 }
 
@@ -452,18 +699,20 @@ texture_glyph_t *
 texture_font_find_glyph( texture_font_t * self,
                          const char * codepoint )
 {
-    size_t i;
+    size_t mask, i;
     texture_glyph_t *glyph;
     uint32_t ucodepoint = utf8_to_utf32( codepoint );
 
-    for( i = 0; i < self->glyphs->size; ++i )
+    if( !self->glyph_map_capacity )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        // If codepoint is -1, we don't care about outline type or thickness
-        if( (glyph->codepoint == ucodepoint) &&
-            ((ucodepoint == UINT32_MAX) ||
-             ((glyph->rendermode == self->rendermode) &&
-              (glyph->outline_thickness == self->outline_thickness)) ))
+        return NULL;
+    }
+
+    mask = self->glyph_map_capacity - 1;
+
+    for( i = texture_hash_u32( ucodepoint ) & mask; (glyph = self->glyph_map[i]); i = (i + 1) & mask )
+    {
+        if( texture_glyph_matches( self, glyph, ucodepoint ) )
         {
             return glyph;
         }
@@ -523,7 +772,12 @@ texture_font_load_glyph( texture_font_t * self,
         glyph->t0 = (region.y+2)/(float)self->atlas->height;
         glyph->s1 = (region.x+3)/(float)self->atlas->width;
         glyph->t1 = (region.y+3)/(float)self->atlas->height;
-        vector_push_back( self->glyphs, &glyph );
+        glyph->atlas = self->atlas;
+        if( !texture_font_add_glyph( self, glyph ) )
+        {
+            texture_glyph_delete( glyph );
+            return 0;
+        }
         return 1;
     }
 
@@ -654,16 +908,23 @@ cleanup_stroker:
         int bottom;
     } padding = { 0, 0, 1, 1 };
 
-    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
-    {
-        padding.top = 1;
-        padding.left = 1;
-    }
-
     //@appamics.CB: fix for vertical lines from next glyph in atlas
     padding.left = 1;
     padding.top = 1;
 
+    if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
+    {
+        // room for the distance ramp outside of the outline
+        int spread = (int)ceilf( self->sdf_spread );
+
+        padding.left = spread;
+        padding.top = spread;
+        padding.right = spread;
+        padding.bottom = spread;
+        ft_glyph_left -= spread;
+        ft_glyph_top += spread;
+    }
+
     size_t src_w = ft_bitmap.width/self->atlas->depth;
     size_t src_h = ft_bitmap.rows;
 
@@ -674,7 +935,7 @@ cleanup_stroker:
 
     if ( region.x < 0 )
     {
-        fprintf( stderr, "Texture atlas is full (line %d)\n",  __LINE__ );
+        // Atlas is full (the caller might switch to another atlas page)
         return 0;
     }
 
@@ -690,7 +951,7 @@ cleanup_stroker:
 
     if( self->rendermode == RENDER_SIGNED_DISTANCE_FIELD )
     {
-        unsigned char *sdf = make_distance_mapb( buffer, tgt_w, tgt_h );
+        unsigned char *sdf = make_distance_map_spread( buffer, tgt_w, tgt_h, self->sdf_spread );
         free( buffer );
         buffer = sdf;
     }
@@ -711,6 +972,7 @@ cleanup_stroker:
     glyph->t0       = y/(float)self->atlas->height;
     glyph->s1       = (x + glyph->width)/(float)self->atlas->width;
     glyph->t1       = (y + glyph->height)/(float)self->atlas->height;
+    glyph->atlas    = self->atlas;
 
     // Discard hinting to get advance
     FT_Load_Glyph( self->face, glyph_index, FT_LOAD_RENDER | FT_LOAD_NO_HINTING);
@@ -718,12 +980,15 @@ cleanup_stroker:
     glyph->advance_x = slot->advance.x / HRESf;
     glyph->advance_y = slot->advance.y / HRESf;
 
-    vector_push_back( self->glyphs, &glyph );
-
     if( self->rendermode != RENDER_NORMAL && self->rendermode != RENDER_SIGNED_DISTANCE_FIELD )
         FT_Done_Glyph( ft_glyph );
 
-    texture_font_generate_kerning( self );
+    /* Note: kerning is computed on demand (see texture_font_get_kerning) */
+    if( !texture_font_add_glyph( self, glyph ) )
+    {
+        texture_glyph_delete( glyph );
+        return 0;
+    }
 
     return 1;
 }
@@ -91,18 +91,20 @@ typedef enum rendermode_t
 
 
 /**
- * A structure that hold a kerning value relatively to a Unicode
- * codepoint.
- *
- * This structure cannot be used alone since the (necessary) right
- * Unicode codepoint is implicitely held by the owner of this structure.
+ * A structure that hold the kerning value of a pair of Unicode
+ * codepoints (kerning cache entry).
  */
 typedef struct kerning_t
 {
     /**
      * Left Unicode codepoint in the kern pair in UTF-32 LE encoding.
      */
-    uint32_t codepoint;
+    uint32_t left;
+
+    /**
+     * Right Unicode codepoint in the kern pair in UTF-32 LE encoding.
+     */
+    uint32_t right;
 
     /**
      * Kerning value (in fractional pixels).
@@ -214,11 +216,6 @@ typedef struct texture_glyph_t
      */
     float t1;
 
-    /**
-     * A vector of kerning pairs relative to this glyph.
-     */
-    vector_t * kerning;
-
     /**
      * Mode this glyph was rendered
      */
@@ -229,6 +226,16 @@ typedef struct texture_glyph_t
      */
     float outline_thickness;
 
+    /**
+     * Atlas page containing the glyph
+     */
+    texture_atlas_t * atlas;
+
+    /**
+     * Last use (least-recently-used eviction)
+     */
+    size_t last_use;
+
 } texture_glyph_t;
 
 
@@ -243,6 +250,19 @@ typedef struct texture_font_t
      */
     vector_t * glyphs;
 
+    /**
+     * Hash map of the glyphs (open addressing, keyed by codepoint).
+     */
+    texture_glyph_t ** glyph_map;
+    size_t glyph_map_capacity;
+
+    /**
+     * Kerning cache (open addressing, keyed by codepoint pair).
+     */
+    kerning_t * kerning_map;
+    size_t kerning_map_capacity;
+    size_t kerning_map_count;
+
     /**
      * Atlas structure to store glyphs data.
      */
@@ -291,6 +311,11 @@ typedef struct texture_font_t
      */
     float outline_thickness;
 
+    /**
+     * Distance field spread in pixels (RENDER_SIGNED_DISTANCE_FIELD)
+     */
+    float sdf_spread;
+
     /**
      * Whether to use our own lcd filter.
      */
@@ -461,17 +486,54 @@ typedef struct texture_font_t
   texture_font_load_glyphs( texture_font_t * self,
                             const char * codepoints );
 
+/**
+ * Add a glyph (e.g. restored from a cache).
+ *
+ * @param self  A valid texture font
+ * @param glyph Glyph (owned by the font if added)
+ *
+ * @return One if the glyph could be added, zero if not.
+ */
+  int
+  texture_font_add_glyph( texture_font_t * self,
+                          texture_glyph_t * glyph );
+
+/**
+ * Remove a glyph from the font and delete it.
+ *
+ * @param self  A valid texture font
+ * @param index Index of the glyph in the glyphs vector
+ */
+  void
+  texture_font_remove_glyph( texture_font_t * self,
+                             size_t index );
+
 /**
  * Get the kerning between two horizontal glyphs.
  *
- * @param self      A valid texture glyph
- * @param codepoint Character codepoint of the peceding character in UTF-8 encoding.
+ * Note: computed on first use and cached per pair.
+ *
+ * @param self  A valid texture font
+ * @param left  Codepoint of the preceding character in UTF-32 encoding.
+ * @param right Codepoint of the character in UTF-32 encoding.
  *
  * @return x kerning value
  */
-float
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const char * codepoint );
+  float
+  texture_font_get_kerning( texture_font_t * self,
+                            uint32_t left, uint32_t right );
+
+/**
+ * Set a cached kerning value (e.g. restored from a cache).
+ *
+ * @param self    A valid texture font
+ * @param left    Codepoint of the preceding character in UTF-32 encoding.
+ * @param right   Codepoint of the character in UTF-32 encoding.
+ * @param kerning x kerning value
+ */
+  void
+  texture_font_set_kerning( texture_font_t * self,
+                            uint32_t left, uint32_t right, float kerning );
 
 
 /**
@@ -54,4 +54,28 @@ static double __attribute__((unused)) getTime(void) {
 
 #endif
 
+#ifdef HEADLESS
+
+//Linux offscreen (EGL & OpenGL ES 2)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include <time.h>
+
+/**
+ * Get monotonic time for timer (in milliseconds).
+ */
+static double __attribute__((unused)) getTime(void) {
+    struct timespec res;
+
+    clock_gettime(CLOCK_MONOTONIC, &res);
+
+    return 1000.0 * res.tv_sec + ((double) res.tv_nsec / 1e6);
+}
+
+#endif
+
 #endif
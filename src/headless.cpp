@@ -0,0 +1,489 @@
+#include "headless.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <execinfo.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+
+#define gettid() syscall(SYS_gettid)
+
+#define DEBUG_GLES false
+#define DEBUG_RENDER false
+
+//virtual screen
+#define AMINO_HEADLESS_SCREEN_W 1920
+#define AMINO_HEADLESS_SCREEN_H 1080
+
+//
+// AminoGfxHeadless
+//
+
+AminoGfxHeadless::AminoGfxHeadless(): AminoGfx(getFactory()->name) {
+    //empty
+}
+
+AminoGfxHeadless::~AminoGfxHeadless() {
+    if (!destroyed) {
+        destroyAminoGfxHeadless();
+    }
+}
+
+/**
+ * Get factory instance.
+ */
+AminoGfxHeadlessFactory* AminoGfxHeadless::getFactory() {
+    static AminoGfxHeadlessFactory *instance = NULL;
+
+    if (!instance) {
+        instance = new AminoGfxHeadlessFactory(New);
+    }
+
+    return instance;
+}
+
+/**
+ * Add class template to module exports.
+ */
+NAN_MODULE_INIT(AminoGfxHeadless::Init) {
+    AminoGfxHeadlessFactory *factory = getFactory();
+
+    AminoGfx::Init(target, factory);
+}
+
+/**
+ * JS object construction.
+ */
+NAN_METHOD(AminoGfxHeadless::New) {
+    AminoJSObject::createInstance(info, getFactory());
+}
+
+/**
+ * Setup JS instance.
+ */
+void AminoGfxHeadless::setup() {
+    if (DEBUG_GLES) {
+        printf("AminoGfxHeadless.setup()\n");
+    }
+
+    //target frame rate
+    if (!createParams.IsEmpty()) {
+        v8::Local<v8::Object> obj = Nan::New(createParams);
+        Nan::MaybeLocal<v8::Value> fpsMaybe = Nan::Get(obj, Nan::New<v8::String>("fps").ToLocalChecked());
+
+        if (!fpsMaybe.IsEmpty()) {
+            v8::Local<v8::Value> fpsValue = fpsMaybe.ToLocalChecked();
+
+            if (fpsValue->IsInt32()) {
+                //Note: 0 renders as fast as possible
+                targetFPS = fpsValue->Int32Value();
+
+                if (targetFPS < 0) {
+                    targetFPS = 0;
+                }
+            }
+        }
+    }
+
+    //instance
+    addInstance();
+
+    //EGL context
+    initEGL();
+
+    //base class
+    AminoGfx::setup();
+}
+
+/**
+ * Get an EGL display not bound to any window system.
+ */
+EGLDisplay AminoGfxHeadless::getHeadlessDisplay() {
+    //Mesa surfaceless platform
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+        if (getPlatformDisplay) {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+            if (display != EGL_NO_DISPLAY) {
+                if (DEBUG_GLES) {
+                    printf("-> using surfaceless EGL platform\n");
+                }
+
+                return display;
+            }
+        }
+    }
+
+    //fallback: default display (pbuffer support needed)
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+/**
+ * Initialize EGL.
+ */
+void AminoGfxHeadless::initEGL() {
+    //get an EGL display connection
+    display = getHeadlessDisplay();
+
+    assert(display != EGL_NO_DISPLAY);
+
+    //initialize the EGL display connection
+    EGLBoolean res = eglInitialize(display, NULL, NULL);
+
+    if (res == EGL_FALSE) {
+        printf("could not initialize EGL display\n");
+    }
+
+    assert(EGL_FALSE != res);
+
+    //get an appropriate EGL frame buffer configuration
+    static const EGLint attribute_list[] = {
+        //RGBA
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+
+        //OpenGL ES 2.0
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
+
+        //buffers
+        EGL_STENCIL_SIZE, 8,
+        EGL_DEPTH_SIZE, 16,
+
+        //offscreen
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+
+        EGL_NONE
+    };
+
+    EGLint num_config;
+
+    res = eglChooseConfig(display, attribute_list, &config, 1, &num_config);
+
+    assert(EGL_FALSE != res);
+    assert(num_config > 0);
+
+    //choose OpenGL ES 2
+    res = eglBindAPI(EGL_OPENGL_ES_API);
+
+    assert(EGL_FALSE != res);
+
+    //create an EGL rendering context
+    static const EGLint context_attributes[] = {
+        EGL_CONTEXT_CLIENT_VERSION, 2,
+        EGL_NONE
+    };
+
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+
+    assert(context != EGL_NO_CONTEXT);
+}
+
+/**
+ * Destroy EGL instance.
+ */
+void AminoGfxHeadless::destroy() {
+    if (destroyed) {
+        return;
+    }
+
+    //instance
+    destroyAminoGfxHeadless();
+
+    //destroy basic instance
+    AminoGfx::destroy();
+}
+
+/**
+ * Destroy EGL instance.
+ */
+void AminoGfxHeadless::destroyAminoGfxHeadless() {
+    //OpenGL ES
+    if (display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (context != EGL_NO_CONTEXT) {
+            eglDestroyContext(display, context);
+            context = EGL_NO_CONTEXT;
+        }
+
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(display, surface);
+            surface = EGL_NO_SURFACE;
+        }
+
+        //Note: display is shared by all instances
+        if (instanceCount == 1) {
+            eglTerminate(display);
+        }
+
+        display = EGL_NO_DISPLAY;
+    }
+
+    removeInstance();
+
+    if (DEBUG_GLES) {
+        printf("Destroyed headless EGL instance. Left=%i\n", instanceCount);
+    }
+}
+
+/**
+ * Get virtual screen resolution.
+ */
+bool AminoGfxHeadless::getScreenInfo(int &w, int &h, int &refreshRate, bool &fullscreen) {
+    if (DEBUG_GLES) {
+        printf("getScreenInfo\n");
+    }
+
+    //no real display
+    w = AMINO_HEADLESS_SCREEN_W;
+    h = AMINO_HEADLESS_SCREEN_H;
+    refreshRate = targetFPS;
+    fullscreen = false;
+
+    return true;
+}
+
+/**
+ * Add EGL properties.
+ */
+void AminoGfxHeadless::populateRuntimeProperties(v8::Local<v8::Object> &obj) {
+    if (DEBUG_GLES) {
+        printf("populateRuntimeProperties\n");
+    }
+
+    AminoGfx::populateRuntimeProperties(obj);
+
+    //GLES
+    Nan::Set(obj, Nan::New("eglVendor").ToLocalChecked(), Nan::New(std::string(eglQueryString(display, EGL_VENDOR))).ToLocalChecked());
+    Nan::Set(obj, Nan::New("eglVersion").ToLocalChecked(), Nan::New(std::string(eglQueryString(display, EGL_VERSION))).ToLocalChecked());
+
+    //headless
+    Nan::Set(obj, Nan::New("headless").ToLocalChecked(), Nan::True());
+    Nan::Set(obj, Nan::New("targetFPS").ToLocalChecked(), Nan::New(targetFPS));
+}
+
+/**
+ * Create offscreen surface.
+ */
+void AminoGfxHeadless::initRenderer() {
+    if (DEBUG_GLES) {
+        printf("initRenderer()\n");
+    }
+
+    //base
+    AminoGfx::initRenderer();
+
+    //surface has the window size
+    surfaceW = propW->value;
+    surfaceH = propH->value;
+
+    assert(surfaceW > 0);
+    assert(surfaceH > 0);
+
+    const EGLint surface_attributes[] = {
+        EGL_WIDTH, surfaceW,
+        EGL_HEIGHT, surfaceH,
+        EGL_NONE
+    };
+
+    surface = eglCreatePbufferSurface(display, config, surface_attributes);
+
+    assert(surface != EGL_NO_SURFACE);
+
+    viewportW = surfaceW;
+    viewportH = surfaceH;
+    viewportChanged = true;
+
+    //activate context (needed by JS code to create shaders)
+    EGLBoolean res = eglMakeCurrent(display, surface, surface, context);
+
+    assert(EGL_FALSE != res);
+}
+
+void AminoGfxHeadless::start() {
+    //ready to get control back to JS code
+    ready();
+
+    //detach context from main thread
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+bool AminoGfxHeadless::bindContext() {
+    //bind OpenGL context
+    if (surface == EGL_NO_SURFACE) {
+        return false;
+    }
+
+    EGLBoolean res = eglMakeCurrent(display, surface, surface, context);
+
+    assert(res == EGL_TRUE);
+
+    return true;
+}
+
+void AminoGfxHeadless::renderingDone() {
+    if (DEBUG_RENDER) {
+        printf("renderingDone()\n");
+    }
+
+    //finish frame (no vsync)
+    EGLBoolean res = eglSwapBuffers(display, surface);
+
+    assert(res == EGL_TRUE);
+
+    //limit frame rate
+    if (targetFPS > 0) {
+        double frameTime = 1000. / targetFPS;
+        double time = getTime();
+
+        if (nextFrameTime == 0 || time - nextFrameTime > frameTime) {
+            //first frame or too slow: restart timing
+            nextFrameTime = time;
+        }
+
+        nextFrameTime += frameTime;
+
+        double timeSleep = nextFrameTime - time;
+
+        if (timeSleep > 0) {
+            usleep(timeSleep * 1000);
+        }
+    }
+}
+
+void AminoGfxHeadless::handleSystemEvents() {
+    //no input devices
+}
+
+/**
+ * Update the window size.
+ *
+ * Note: has to be called on main thread
+ */
+void AminoGfxHeadless::updateWindowSize() {
+    //pbuffer size is fixed once created
+    if (surface == EGL_NO_SURFACE) {
+        return;
+    }
+
+    //reset to surface values
+    propW->setValue(surfaceW);
+    propH->setValue(surfaceH);
+}
+
+/**
+ * Update the window position.
+ *
+ * Note: has to be called on main thread
+ */
+void AminoGfxHeadless::updateWindowPosition() {
+    //not supported
+    propX->setValue(0);
+    propY->setValue(0);
+}
+
+/**
+ * Update the title.
+ *
+ * Note: has to be called on main thread
+ */
+void AminoGfxHeadless::updateWindowTitle() {
+    //not supported
+}
+
+/**
+ * Shared atlas texture has changed.
+ */
+void AminoGfxHeadless::atlasTextureHasChanged(amino_atlas_update_t *update) {
+    //check single instance case
+    if (instanceCount == 1) {
+        return;
+    }
+
+    //run on main thread
+    enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoGfxHeadless::atlasTextureHasChangedHandler), static_cast<jsUpdateCallback>(&AminoGfxHeadless::atlasTextureHasChangedDone), new amino_atlas_update_t(*update));
+}
+
+/**
+ * Handle on main thread.
+ */
+void AminoGfxHeadless::atlasTextureHasChangedHandler(JSCallbackUpdate *update) {
+    AminoGfx *gfx = static_cast<AminoGfx *>(update->obj);
+    amino_atlas_update_t *atlasUpdate = (amino_atlas_update_t *)update->data;
+
+    for (auto const &item : instances) {
+        if (gfx == item) {
+            continue;
+        }
+
+        static_cast<AminoGfxHeadless *>(item)->updateAtlasTexture(atlasUpdate);
+    }
+}
+
+/**
+ * Create video player.
+ */
+AminoVideoPlayer* AminoGfxHeadless::createVideoPlayer(AminoTexture *texture, AminoVideo *video) {
+    //software decoding
+    return new AminoMacVideoPlayer(texture, video);
+}
+
+//
+// AminoGfxHeadlessFactory
+//
+
+/**
+ * Create AminoGfx factory.
+ */
+AminoGfxHeadlessFactory::AminoGfxHeadlessFactory(Nan::FunctionCallback callback): AminoJSObjectFactory("AminoGfx", callback) {
+    //empty
+}
+
+/**
+ * Create AminoGfx instance.
+ */
+AminoJSObject* AminoGfxHeadlessFactory::create() {
+    return new AminoGfxHeadless();
+}
+
+void crashHandler(int sig) {
+    void *array[10];
+    size_t size;
+
+    //process & thread
+    pid_t pid = getpid();
+    pid_t tid = gettid();
+    uv_thread_t threadId = uv_thread_self();
+
+    //get void*'s for all entries on the stack
+    size = backtrace(array, 10);
+
+    //print out all the frames to stderr
+    fprintf(stderr, "Error: signal %d (process=%d, thread=%d, uvThread=%lu):\n", sig, pid, tid, (unsigned long)threadId);
+    backtrace_symbols_fd(array, size, STDERR_FILENO);
+    exit(1);
+}
+
+// ========== Event Callbacks ===========
+
+NAN_MODULE_INIT(InitAll) {
+    //crash handler
+    signal(SIGSEGV, crashHandler);
+
+    //main class
+    AminoGfxHeadless::Init(target);
+
+    //amino classes
+    AminoGfx::InitClasses(target);
+}
+
+//entry point
+NODE_MODULE(aminonative, InitAll)
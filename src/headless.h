@@ -0,0 +1,70 @@
+#ifndef _AMINO_HEADLESS_H
+#define _AMINO_HEADLESS_H
+
+#include "base.h"
+#include "renderer.h"
+#include "mac_video.h"
+
+class AminoGfxHeadlessFactory : public AminoJSObjectFactory {
+public:
+    AminoGfxHeadlessFactory(Nan::FunctionCallback callback);
+
+    AminoJSObject* create() override;
+};
+
+/**
+ * Headless (offscreen) AminoGfx implementation.
+ *
+ * Renders to an EGL pbuffer surface without any window system.
+ */
+class AminoGfxHeadless : public AminoGfx {
+public:
+    AminoGfxHeadless();
+    ~AminoGfxHeadless();
+
+    static AminoGfxHeadlessFactory* getFactory();
+    static NAN_MODULE_INIT(Init);
+
+private:
+    //OpenGL ES
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+    EGLConfig config;
+    int surfaceW = 0;
+    int surfaceH = 0;
+
+    //frame rate (0: as fast as possible)
+    int targetFPS = 60;
+    double nextFrameTime = 0;
+
+    static NAN_METHOD(New);
+
+    void setup() override;
+    void initEGL();
+    EGLDisplay getHeadlessDisplay();
+
+    void destroy() override;
+    void destroyAminoGfxHeadless();
+
+    bool getScreenInfo(int &w, int &h, int &refreshRate, bool &fullscreen) override;
+
+    void populateRuntimeProperties(v8::Local<v8::Object> &obj) override;
+    void initRenderer() override;
+
+    void start() override;
+    bool bindContext() override;
+    void renderingDone() override;
+    void handleSystemEvents() override;
+
+    void updateWindowSize() override;
+    void updateWindowPosition() override;
+    void updateWindowTitle() override;
+
+    void atlasTextureHasChanged(amino_atlas_update_t *update) override;
+    void atlasTextureHasChangedHandler(JSCallbackUpdate *update);
+
+    AminoVideoPlayer *createVideoPlayer(AminoTexture *texture, AminoVideo *video) override;
+};
+
+#endif
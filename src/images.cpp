@@ -2,6 +2,8 @@
 #include "base.h"
 
 #include <uv.h>
+#include <cmath>
+#include <algorithm>
 
 extern "C" {
     #include <jpeglib.h>
@@ -61,6 +63,158 @@ static void read_png_data_callback(png_structp png_ptr, png_byte *raw_data, png_
     handle->offset += read_length;
 }
 
+//
+// Downsampling
+//
+
+/**
+ * Get the integer downsampling factor.
+ *
+ * The result is at least the target size and less than twice the target size.
+ *
+ * @param maxW maximum width (0: no limit)
+ * @param maxH maximum height (0: no limit)
+ * @param scale scale factor (0: no scaling)
+ * @param cover fill the target size in both dimensions (otherwise fit into it)
+ */
+static int getDownsampleFactor(int w, int h, int maxW, int maxH, float scale, bool cover) {
+    double f = 1;
+
+    if (scale > 0) {
+        f = std::min(f, (double)scale);
+    }
+
+    if (cover && maxW > 0 && maxH > 0 && w > 0 && h > 0) {
+        f = std::min(f, std::max((double)maxW / w, (double)maxH / h));
+    } else {
+        if (maxW > 0 && w > 0) {
+            f = std::min(f, (double)maxW / w);
+        }
+
+        if (maxH > 0 && h > 0) {
+            f = std::min(f, (double)maxH / h);
+        }
+    }
+
+    if (f >= 1) {
+        return 1;
+    }
+
+    return std::max(1, (int)floor(1. / f + 0.0001));
+}
+
+/**
+ * Reduce a group of rows to a single row (box filter).
+ *
+ * @param rows number of rows (factor or less at the bottom edge)
+ */
+static void downsampleRows(const unsigned char *src, int srcW, int rows, int bpp, int factor, unsigned char *dst) {
+    int dstW = (srcW + factor - 1) / factor;
+    int stride = srcW * bpp;
+
+    for (int x = 0; x < dstW; x++) {
+        int x0 = x * factor;
+        int x1 = std::min(x0 + factor, srcW);
+        uint32_t count = (x1 - x0) * rows;
+
+        for (int c = 0; c < bpp; c++) {
+            uint32_t sum = 0;
+
+            for (int r = 0; r < rows; r++) {
+                const unsigned char *pos = src + r * stride + x0 * bpp + c;
+
+                for (int i = x0; i < x1; i++) {
+                    sum += *pos;
+                    pos += bpp;
+                }
+            }
+
+            dst[x * bpp + c] = (sum + count / 2) / count;
+        }
+    }
+}
+
+/**
+ * Get the JPEG DCT scaling denominator (1, 2, 4 or 8).
+ */
+static int getJpegScaleDenom(int factor) {
+    return factor >= 8 ? 8 : (factor >= 4 ? 4 : (factor >= 2 ? 2 : 1));
+}
+
+/**
+ * Estimate the decoding memory (output image, row buffers and decoder state) from the image header.
+ *
+ * Returns 0 if the header is unknown.
+ */
+static size_t estimateDecodeMemory(const unsigned char *data, size_t len, int maxW, int maxH, float scale, bool cover) {
+    // 1) PNG (IHDR is the first chunk)
+    if (len > 29 && data[0] == 137 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') {
+        size_t w = (data[16] << 24) | (data[17] << 16) | (data[18] << 8) | data[19];
+        size_t h = (data[20] << 24) | (data[21] << 16) | (data[22] << 8) | data[23];
+        size_t bpp = data[24] == 16 ? 8 : 4;
+        bool interlaced = data[28] != 0;
+        int factor = getDownsampleFactor(w, h, maxW, maxH, scale, cover);
+        size_t outW = (w + factor - 1) / factor;
+        size_t outH = (h + factor - 1) / factor;
+        size_t scratch = factor == 1 ? 0 : (interlaced ? h : factor) * w * bpp;
+
+        //output, rows and libpng row buffers
+        return outW * outH * bpp + scratch + 2 * w * bpp;
+    }
+
+    // 2) JPEG (find start of frame)
+    size_t pos = 2;
+
+    while (pos + 10 < len) {
+        if (data[pos] != 0xFF) {
+            return 0;
+        }
+
+        unsigned char marker = data[pos + 1];
+
+        //fill bytes
+        if (marker == 0xFF) {
+            pos++;
+            continue;
+        }
+
+        //markers without length
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            pos += 2;
+            continue;
+        }
+
+        //SOF0 to SOF15 (except DHT, JPG and DAC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            size_t h = (data[pos + 5] << 8) | data[pos + 6];
+            size_t w = (data[pos + 7] << 8) | data[pos + 8];
+            size_t components = data[pos + 9];
+            int factor = getDownsampleFactor(w, h, maxW, maxH, scale, cover);
+            int denom = getJpegScaleDenom(factor);
+            size_t srcW = (w + denom - 1) / denom;
+            size_t srcH = (h + denom - 1) / denom;
+
+            factor /= denom;
+
+            size_t outW = (srcW + factor - 1) / factor;
+            size_t outH = (srcH + factor - 1) / factor;
+            size_t scratch = factor == 1 ? 0 : factor * srcW * components;
+
+            //progressive: full coefficient buffer (16-bit, not scaled)
+            bool progressive = marker == 0xC2 || marker == 0xC6 || marker == 0xCA || marker == 0xCE;
+            size_t coefficients = progressive ? w * h * components * 2 : 0;
+
+            //output, rows, coefficients and MCU rows
+            return outW * outH * components + scratch + coefficients + 16 * w * components;
+        }
+
+        //next segment
+        pos += 2 + ((data[pos + 2] << 8) | data[pos + 3]);
+    }
+
+    return 0;
+}
+
 //
 // AsyncImageWorker
 //
@@ -74,6 +228,12 @@ private:
     char *buffer;
     size_t bufferLen;
 
+    //target size
+    int maxW;
+    int maxH;
+    float scale;
+    bool cover;
+
     //image
     char *imgData = NULL;
     int imgDataLen = 0;
@@ -82,8 +242,15 @@ private:
     bool imgAlpha;
     int imgBPP;
 
+    //decoded rows (downsampling)
+    unsigned char *rowData = NULL;
+    size_t rowDataSize = 0;
+
+    //estimated memory
+    size_t memoryCost;
+
 public:
-    AsyncImageWorker(Nan::Callback *callback, v8::Local<v8::Object> &obj, v8::Local<v8::Value> &bufferObj) : AsyncWorker(callback) {
+    AsyncImageWorker(Nan::Callback *callback, v8::Local<v8::Object> &obj, v8::Local<v8::Value> &bufferObj, int maxW, int maxH, float scale, bool cover) : AsyncWorker(callback), maxW(maxW), maxH(maxH), scale(scale), cover(cover) {
         SaveToPersistent("object", obj);
 
         //process buffer
@@ -91,6 +258,20 @@ public:
 
         buffer = node::Buffer::Data(bufferObj);
         bufferLen = node::Buffer::Length(bufferObj);
+
+        memoryCost = estimateDecodeMemory((unsigned char *)buffer, bufferLen, maxW, maxH, scale, cover);
+    }
+
+    ~AsyncImageWorker() {
+        //next decoding jobs
+        AminoImage::decodeQueue.release(memoryCost);
+    }
+
+    /**
+     * Get the estimated decoding memory.
+     */
+    size_t getMemoryCost() {
+        return memoryCost;
     }
 
     /**
@@ -175,6 +356,8 @@ public:
                 imgData = NULL;
             }
 
+            freeRowData();
+
             return;
         }
 
@@ -223,6 +406,9 @@ public:
 #endif
         }
 
+        //interlaced images (all passes combined)
+        const int passes = png_set_interlace_handling(png_ptr);
+
         //get final info
         png_read_update_info(png_ptr, info_ptr);
 
@@ -232,8 +418,11 @@ public:
 
         assert(rowSize > 0);
 
-        imgW = width;
-        imgH = height;
+        const bool interlaced = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
+        const int factor = getDownsampleFactor(width, height, maxW, maxH, scale, cover);
+
+        imgW = (width + factor - 1) / factor;
+        imgH = (height + factor - 1) / factor;
         imgAlpha = (colorType == PNG_COLOR_TYPE_RGB_ALPHA) || (colorType == PNG_COLOR_TYPE_GRAY_ALPHA);
 
         switch (colorType) {
@@ -266,26 +455,74 @@ public:
         }
 
         if (DEBUG_IMAGES) {
-            printf("-> output image %dx%d (bpp=%i, alpha=%i, type=%i)\n", (int)width, (int)height, (int)imgBPP, (int)imgAlpha, (int)colorType);
+            printf("-> output image %dx%d (bpp=%i, alpha=%i, type=%i, factor=%i)\n", (int)width, (int)height, (int)imgBPP, (int)imgAlpha, (int)colorType, factor);
         }
 
-        //decode
+        //output image
+        imgDataLen = factor == 1 ? rowSize * height : imgW * imgH * imgBPP;
+        imgData = (char *)malloc(imgDataLen); //gets transferred to buffer
 
-        //printf("-> row=%i calc=%i\n", (int)rowSize, width * imgBPP);
-        //printf("-> size=%ix%i, alpha=%i, bpp=%i\n", imgW, imgH, imgAlpha ? 1:0, imgBPP);
+        assert(imgData != NULL);
 
-        imgDataLen = rowSize * height;
-        imgData = (char *)malloc(imgDataLen);
+        //decode (in batches of rows)
+        png_byte *rowPtrs[IMAGE_DECODE_ROWS];
 
-        assert(imgData != NULL);
+        if (factor == 1) {
+            //decode into image (once per interlace pass)
+            for (int pass = 0; pass < passes; pass++) {
+                for (png_uint_32 y = 0; y < height; y += IMAGE_DECODE_ROWS) {
+                    png_uint_32 rows = std::min((png_uint_32)IMAGE_DECODE_ROWS, height - y);
 
-        png_byte *row_ptrs[height];
+                    for (png_uint_32 i = 0; i < rows; i++) {
+                        rowPtrs[i] = (png_byte *)imgData + (y + i) * rowSize;
+                    }
 
-        for (png_uint_32 i = 0; i < height; i++) {
-            row_ptrs[i] = (unsigned char *)imgData + i * rowSize;
+                    png_read_rows(png_ptr, rowPtrs, NULL, rows);
+                }
+            }
+        } else if (interlaced) {
+            //all passes needed before a row is complete
+            allocRowData(rowSize * height);
+
+            for (int pass = 0; pass < passes; pass++) {
+                for (png_uint_32 y = 0; y < height; y += IMAGE_DECODE_ROWS) {
+                    png_uint_32 rows = std::min((png_uint_32)IMAGE_DECODE_ROWS, height - y);
+
+                    for (png_uint_32 i = 0; i < rows; i++) {
+                        rowPtrs[i] = rowData + (y + i) * rowSize;
+                    }
+
+                    png_read_rows(png_ptr, rowPtrs, NULL, rows);
+                }
+            }
+
+            for (int y = 0; y < imgH; y++) {
+                int rows = std::min(factor, (int)height - y * factor);
+
+                downsampleRows(rowData + y * factor * rowSize, width, rows, imgBPP, factor, (unsigned char *)imgData + y * imgW * imgBPP);
+            }
+        } else {
+            //stream rows (only factor rows in memory)
+            allocRowData(rowSize * factor);
+
+            for (int y = 0; y < imgH; y++) {
+                int rows = std::min(factor, (int)height - y * factor);
+
+                for (int i = 0; i < rows; i += IMAGE_DECODE_ROWS) {
+                    int count = std::min(IMAGE_DECODE_ROWS, rows - i);
+
+                    for (int j = 0; j < count; j++) {
+                        rowPtrs[j] = rowData + (i + j) * rowSize;
+                    }
+
+                    png_read_rows(png_ptr, rowPtrs, NULL, count);
+                }
+
+                downsampleRows(rowData, width, rows, imgBPP, factor, (unsigned char *)imgData + y * imgW * imgBPP);
+            }
         }
 
-        png_read_image(png_ptr, &row_ptrs[0]);
+        freeRowData();
 
         //done
         png_read_end(png_ptr, info_ptr);
@@ -331,6 +568,8 @@ public:
                 imgData = NULL;
             }
 
+            freeRowData();
+
             return;
         }
 
@@ -350,11 +589,27 @@ public:
             return;
         }
 
+        //DCT scaling (1/2, 1/4 or 1/8)
+        int factor = getDownsampleFactor(cinfo.image_width, cinfo.image_height, maxW, maxH, scale, cover);
+
+        if (factor > 1) {
+            int denom = getJpegScaleDenom(factor);
+
+            cinfo.scale_num = 1;
+            cinfo.scale_denom = denom;
+
+            //remaining factor
+            factor /= denom;
+        }
+
         jpeg_start_decompress(&cinfo);
 
         //get JPEG data
-        imgW = cinfo.output_width;
-	    imgH = cinfo.output_height;
+        int srcW = cinfo.output_width;
+        int srcH = cinfo.output_height;
+
+        imgW = (srcW + factor - 1) / factor;
+	    imgH = (srcH + factor - 1) / factor;
         imgAlpha = false;
         imgBPP = cinfo.output_components;
 
@@ -371,12 +626,40 @@ public:
 
         int rowStride = cinfo.output_width * imgBPP;
 
-        while (cinfo.output_scanline < cinfo.output_height) {
-            unsigned char *bufferArray[1];
+        //decode (multiple scanlines per call)
+        JSAMPROW rowPtrs[IMAGE_DECODE_ROWS];
+
+        if (factor > 1) {
+            //box filter (only factor scanlines in memory)
+            allocRowData(rowStride * factor);
 
-		    bufferArray[0] = (unsigned char *)imgData + cinfo.output_scanline * rowStride;
+            for (int y = 0; y < imgH; y++) {
+                int rows = 0;
+
+                while (rows < factor && cinfo.output_scanline < cinfo.output_height) {
+                    int count = std::min(IMAGE_DECODE_ROWS, factor - rows);
+
+                    for (int i = 0; i < count; i++) {
+                        rowPtrs[i] = rowData + (rows + i) * rowStride;
+                    }
+
+                    rows += jpeg_read_scanlines(&cinfo, rowPtrs, count);
+                }
+
+                downsampleRows(rowData, srcW, rows, imgBPP, factor, (unsigned char *)imgData + y * imgW * imgBPP);
+            }
+
+            freeRowData();
+        } else {
+            while (cinfo.output_scanline < cinfo.output_height) {
+                int count = std::min(IMAGE_DECODE_ROWS, (int)(cinfo.output_height - cinfo.output_scanline));
 
-    		jpeg_read_scanlines(&cinfo, bufferArray, 1);
+                for (int i = 0; i < count; i++) {
+                    rowPtrs[i] = (unsigned char *)imgData + (cinfo.output_scanline + i) * rowStride;
+                }
+
+                jpeg_read_scanlines(&cinfo, rowPtrs, count);
+            }
         }
 
         //done
@@ -388,6 +671,29 @@ public:
         }
     }
 
+    /**
+     * Get a row buffer from the pool.
+     */
+    void allocRowData(size_t size) {
+        assert(!rowData);
+
+        rowData = AminoImage::bufferPool.get(size);
+        rowDataSize = size;
+
+        assert(rowData != NULL);
+    }
+
+    /**
+     * Return the row buffer to the pool.
+     */
+    void freeRowData() {
+        if (rowData) {
+            AminoImage::bufferPool.put(rowData, rowDataSize);
+            rowData = NULL;
+            rowDataSize = 0;
+        }
+    }
+
     /**
      * Back in main thread with JS access.
      */
@@ -426,10 +732,334 @@ public:
     }
 };
 
+//
+// AminoImageBufferPool
+//
+
+/**
+ * Constructor.
+ */
+AminoImageBufferPool::AminoImageBufferPool() {
+    uv_mutex_init(&lock);
+}
+
+/**
+ * Destructor.
+ */
+AminoImageBufferPool::~AminoImageBufferPool() {
+    for (auto &sizeClass : buffers) {
+        for (auto buffer : sizeClass) {
+            free(buffer);
+        }
+    }
+
+    uv_mutex_destroy(&lock);
+}
+
+/**
+ * Get the size class (-1 if not pooled).
+ */
+int AminoImageBufferPool::getSizeClass(size_t size) {
+    int sizeClass = IMAGE_POOL_MIN_CLASS;
+
+    while (((size_t)1 << sizeClass) < size) {
+        sizeClass++;
+
+        if (sizeClass > IMAGE_POOL_MAX_CLASS) {
+            return -1;
+        }
+    }
+
+    return sizeClass - IMAGE_POOL_MIN_CLASS;
+}
+
+/**
+ * Get a buffer of at least the given size.
+ *
+ * @param allocated set to true if no pooled buffer was available
+ */
+unsigned char *AminoImageBufferPool::get(size_t size, bool *allocated) {
+    int sizeClass = getSizeClass(size);
+
+    if (allocated) {
+        *allocated = false;
+    }
+
+    if (sizeClass == -1) {
+        if (allocated) {
+            *allocated = true;
+        }
+
+        return (unsigned char *)malloc(size);
+    }
+
+    uv_mutex_lock(&lock);
+
+    requests++;
+
+    std::vector<unsigned char *> &items = buffers[sizeClass];
+
+    if (!items.empty()) {
+        unsigned char *buffer = items.back();
+
+        items.pop_back();
+        pooledBytes -= (size_t)1 << (sizeClass + IMAGE_POOL_MIN_CLASS);
+        hits++;
+
+        uv_mutex_unlock(&lock);
+
+        return buffer;
+    }
+
+    uv_mutex_unlock(&lock);
+
+    if (allocated) {
+        *allocated = true;
+    }
+
+    return (unsigned char *)malloc((size_t)1 << (sizeClass + IMAGE_POOL_MIN_CLASS));
+}
+
+/**
+ * Return a buffer (size as requested).
+ */
+void AminoImageBufferPool::put(unsigned char *buffer, size_t size) {
+    int sizeClass = getSizeClass(size);
+
+    if (sizeClass == -1) {
+        free(buffer);
+        return;
+    }
+
+    size_t bytes = (size_t)1 << (sizeClass + IMAGE_POOL_MIN_CLASS);
+
+    uv_mutex_lock(&lock);
+
+    if (pooledBytes + bytes > IMAGE_POOL_MAX_BYTES) {
+        uv_mutex_unlock(&lock);
+
+        free(buffer);
+        return;
+    }
+
+    buffers[sizeClass].push_back(buffer);
+    pooledBytes += bytes;
+
+    uv_mutex_unlock(&lock);
+}
+
+/**
+ * Add pool stats.
+ */
+void AminoImageBufferPool::getStats(v8::Local<v8::Object> &obj) {
+    uv_mutex_lock(&lock);
+
+    Nan::Set(obj, Nan::New("poolRequests").ToLocalChecked(), Nan::New<v8::Uint32>(requests));
+    Nan::Set(obj, Nan::New("poolHits").ToLocalChecked(), Nan::New<v8::Uint32>(hits));
+    Nan::Set(obj, Nan::New("pooledBytes").ToLocalChecked(), Nan::New<v8::Number>(pooledBytes));
+
+    uv_mutex_unlock(&lock);
+}
+
+//
+// AminoImageDecodeQueue
+//
+
+/**
+ * Set the memory budget.
+ */
+void AminoImageDecodeQueue::setBudget(size_t budget) {
+    this->budget = budget;
+
+    startNext();
+}
+
+/**
+ * Add a decoding job.
+ */
+void AminoImageDecodeQueue::submit(Nan::AsyncWorker *worker, size_t cost) {
+    queue.push_back(std::make_pair(worker, cost));
+
+    startNext();
+}
+
+/**
+ * Decoding job done.
+ */
+void AminoImageDecodeQueue::release(size_t cost) {
+    assert(running > 0);
+    assert(used >= cost);
+
+    used -= cost;
+    running--;
+
+    startNext();
+}
+
+/**
+ * Start queued jobs (in order) as long as they fit into the budget.
+ */
+void AminoImageDecodeQueue::startNext() {
+    while (!queue.empty()) {
+        Nan::AsyncWorker *worker = queue.front().first;
+        size_t cost = queue.front().second;
+
+        if (running > 0 && used + cost > budget) {
+            if (DEBUG_IMAGES) {
+                printf("-> image decoding queued (used=%i cost=%i)\n", (int)used, (int)cost);
+            }
+
+            break;
+        }
+
+        queue.pop_front();
+        used += cost;
+        running++;
+
+        AsyncQueueWorker(worker);
+    }
+}
+
+/**
+ * Add queue stats.
+ */
+void AminoImageDecodeQueue::getStats(v8::Local<v8::Object> &obj) {
+    Nan::Set(obj, Nan::New("budget").ToLocalChecked(), Nan::New<v8::Number>(budget));
+    Nan::Set(obj, Nan::New("used").ToLocalChecked(), Nan::New<v8::Number>(used));
+    Nan::Set(obj, Nan::New("running").ToLocalChecked(), Nan::New<v8::Uint32>(running));
+    Nan::Set(obj, Nan::New("queued").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)queue.size()));
+}
+
+//
+// AminoTextureUploader
+//
+
+/**
+ * Set the per-frame budget (0: no limit).
+ */
+void AminoTextureUploader::setBudget(double time, size_t bytes) {
+    budgetTime = time;
+    budgetBytes = bytes;
+}
+
+/**
+ * Queue an upload.
+ */
+void AminoTextureUploader::add(amino_texture_upload_t *upload) {
+    upload->bytesLeft = upload->w * upload->h * upload->bpp;
+
+    deferredBytes += upload->bytesLeft;
+    queue.push_back(upload);
+}
+
+/**
+ * Count texture data uploaded outside of the scheduler in the current frame (e.g. font atlas pages).
+ */
+void AminoTextureUploader::addBytes(size_t bytes) {
+    frameBytes += bytes;
+}
+
+/**
+ * Upload the queued textures within the frame budget.
+ */
+void AminoTextureUploader::process() {
+    size_t bytes = frameBytes;
+    bool first = true;
+
+    frameBytes = 0;
+    lastFrameBytes = 0;
+
+    if (queue.empty()) {
+        return;
+    }
+
+    double start = getTime();
+
+    while (!queue.empty()) {
+        //check budget (at least one slice per frame)
+        if (!first) {
+            if (budgetBytes > 0 && bytes >= budgetBytes) {
+                break;
+            }
+
+            if (budgetTime > 0 && getTime() - start >= budgetTime) {
+                break;
+            }
+        }
+
+        first = false;
+
+        size_t maxBytes = TEXTURE_UPLOAD_SLICE;
+
+        if (budgetBytes > 0 && bytes < budgetBytes) {
+            maxBytes = std::min(maxBytes, budgetBytes - bytes);
+        }
+
+        //next slice
+        amino_texture_upload_t *upload = queue.front();
+        size_t sliceBytes = 0;
+        bool done = upload->texture->uploadSlice(upload, maxBytes, sliceBytes);
+
+        size_t uploaded = std::min(upload->bytesLeft, sliceBytes);
+
+        bytes += sliceBytes;
+        lastFrameBytes += sliceBytes;
+        upload->bytesLeft -= uploaded;
+        deferredBytes -= uploaded;
+
+        if (done) {
+            //skipped data (failed uploads)
+            deferredBytes -= upload->bytesLeft;
+            upload->bytesLeft = 0;
+
+            queue.pop_front();
+
+            //Note: upload is freed on main thread
+            upload->texture->notifyUploadDone(upload);
+        }
+    }
+
+    if (DEBUG_IMAGES) {
+        printf("-> texture uploads: %i bytes (%i queued, %i deferred bytes)\n", (int)lastFrameBytes, (int)queue.size(), (int)deferredBytes);
+    }
+}
+
+/**
+ * Free all queued uploads (without callbacks).
+ *
+ * Note: called on main thread after the rendering thread has stopped.
+ */
+void AminoTextureUploader::clear() {
+    for (auto upload : queue) {
+        upload->texture->finishUpload(upload, false);
+    }
+
+    queue.clear();
+    deferredBytes = 0;
+}
+
+/**
+ * Get upload statistics.
+ */
+void AminoTextureUploader::getStats(v8::Local<v8::Object> &obj) {
+    v8::Local<v8::Object> uploadObj = Nan::New<v8::Object>();
+
+    Nan::Set(uploadObj, Nan::New("queued").ToLocalChecked(), Nan::New<v8::Uint32>((uint32_t)queue.size()));
+    Nan::Set(uploadObj, Nan::New("deferredBytes").ToLocalChecked(), Nan::New<v8::Number>(deferredBytes));
+    Nan::Set(uploadObj, Nan::New("lastFrameBytes").ToLocalChecked(), Nan::New<v8::Number>(lastFrameBytes));
+    Nan::Set(uploadObj, Nan::New("budgetTime").ToLocalChecked(), Nan::New<v8::Number>(budgetTime));
+    Nan::Set(uploadObj, Nan::New("budgetBytes").ToLocalChecked(), Nan::New<v8::Number>(budgetBytes));
+
+    Nan::Set(obj, Nan::New("textureUploads").ToLocalChecked(), uploadObj);
+}
+
 //
 // AminoImage
 //
 
+AminoImageBufferPool AminoImage::bufferPool;
+AminoImageDecodeQueue AminoImage::decodeQueue;
+
 /**
  * Constructor.
  */
@@ -478,21 +1108,17 @@ void AminoImage::destroyAminoImage() {
 }
 
 /**
- * Create texture.
- *
- * Note: only call from async handler!
+ * Get the pixel data.
  */
-GLuint AminoImage::createTexture(GLuint textureId) {
-    if (!hasImage()) {
-        return INVALID_TEXTURE;
-    }
-
-    //debug
-    if (DEBUG_IMAGES) {
-        printf("createTexture(): buffer=%d, size=%ix%i, bpp=%i\n", (int)bufferLength, w, h, bpp);
-    }
+char *AminoImage::getPixels() {
+    return bufferData;
+}
 
-    return createTexture(textureId, bufferData, bufferLength, w, h, bpp);
+/**
+ * Get the pixel buffer (on main thread).
+ */
+v8::Local<v8::Object> AminoImage::getBuffer() {
+    return Nan::New(buffer);
 }
 
 /**
@@ -501,7 +1127,8 @@ GLuint AminoImage::createTexture(GLuint textureId) {
  * Note: only call from async handler (rendering thread)!
  */
 GLuint AminoImage::createTexture(GLuint textureId, char *bufferData, size_t bufferLength, int w, int h, int bpp) {
-    assert(w * h * bpp == (int)bufferLength);
+    //Note: no data allocates the texture storage only
+    assert(!bufferData || w * h * bpp == (int)bufferLength);
 
     GLuint texture;
 
@@ -519,8 +1146,6 @@ GLuint AminoImage::createTexture(GLuint textureId, char *bufferData, size_t buff
     glBindTexture(GL_TEXTURE_2D, texture);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    //Note: glTexSubImage2D() would probably be faster for updates
-
     if (bpp == 3) {
         //RGB (24-bit)
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, bufferData);
@@ -569,6 +1194,63 @@ GLuint AminoImage::createTexture(GLuint textureId, char *bufferData, size_t buff
     return texture;
 }
 
+/**
+ * Update a texture region.
+ *
+ * Copies w pixels of h source rows (stride: bytes per source row) to the region at x/y.
+ *
+ * @param allocations incremented if a row buffer had to be allocated
+ *
+ * Note: only call from async handler (rendering thread)!
+ */
+void AminoImage::updateTexture(GLuint textureId, char *bufferData, size_t stride, int x, int y, int w, int h, int bpp, int *allocations) {
+    GLenum format;
+
+    if (bpp == 3) {
+        format = GL_RGB;
+    } else if (bpp == 4) {
+        format = GL_RGBA;
+    } else if (bpp == 1) {
+        format = GL_LUMINANCE;
+    } else if (bpp == 2) {
+        format = GL_LUMINANCE_ALPHA;
+    } else {
+        //unsupported
+        printf("unsupported texture format: bpp=%d\n", bpp);
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    size_t rowLength = w * bpp;
+
+    //full rows
+    if (stride == rowLength) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format, GL_UNSIGNED_BYTE, bufferData);
+        return;
+    }
+
+    //copy rows (GL_UNPACK_ROW_LENGTH not supported by OpenGL ES 2.0)
+    size_t length = rowLength * h;
+    bool allocated;
+    unsigned char *rowData = bufferPool.get(length, &allocated);
+
+    assert(rowData);
+
+    if (allocated && allocations) {
+        (*allocations)++;
+    }
+
+    for (int i = 0; i < h; i++) {
+        memcpy(rowData + i * rowLength, bufferData + i * stride, rowLength);
+    }
+
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format, GL_UNSIGNED_BYTE, rowData);
+
+    bufferPool.put(rowData, length);
+}
+
 /**
  * Get factory instance.
  */
@@ -597,7 +1279,12 @@ NAN_MODULE_INIT(AminoImage::Init) {
     Nan::SetPrototypeMethod(tpl, "loadImage", loadImage);
 
     //global template instance
-    Nan::Set(target, Nan::New(factory->name).ToLocalChecked(), Nan::GetFunction(tpl).ToLocalChecked());
+    v8::Local<v8::Function> func = Nan::GetFunction(tpl).ToLocalChecked();
+
+    //static methods
+    Nan::SetMethod(func, "setDecodeBudget", SetDecodeBudget);
+
+    Nan::Set(target, Nan::New(factory->name).ToLocalChecked(), func);
 }
 
 /**
@@ -611,14 +1298,76 @@ NAN_METHOD(AminoImage::New) {
  * Load image asynchronously.
  */
 NAN_METHOD(AminoImage::loadImage) {
-    assert(info.Length() == 2);
+    assert(info.Length() == 2 || info.Length() == 3);
 
     v8::Local<v8::Value> bufferObj = info[0];
-    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    Nan::Callback *callback = new Nan::Callback(info[info.Length() - 1].As<v8::Function>());
     v8::Local<v8::Object> obj = info.This();
 
-    //async loading
-    AsyncQueueWorker(new AsyncImageWorker(callback, obj, bufferObj));
+    //target size (optional)
+    int maxW = 0;
+    int maxH = 0;
+    float scale = 0;
+    bool cover = false;
+
+    if (info.Length() == 3 && info[1]->IsObject()) {
+        v8::Local<v8::Object> opts = info[1]->ToObject();
+        v8::Local<v8::Value> maxWValue = Nan::Get(opts, Nan::New<v8::String>("maxWidth").ToLocalChecked()).ToLocalChecked();
+        v8::Local<v8::Value> maxHValue = Nan::Get(opts, Nan::New<v8::String>("maxHeight").ToLocalChecked()).ToLocalChecked();
+        v8::Local<v8::Value> scaleValue = Nan::Get(opts, Nan::New<v8::String>("scale").ToLocalChecked()).ToLocalChecked();
+        v8::Local<v8::Value> fitValue = Nan::Get(opts, Nan::New<v8::String>("fit").ToLocalChecked()).ToLocalChecked();
+
+        if (maxWValue->IsNumber()) {
+            maxW = std::max(0, (int)ceil(maxWValue->NumberValue()));
+        }
+
+        if (maxHValue->IsNumber()) {
+            maxH = std::max(0, (int)ceil(maxHValue->NumberValue()));
+        }
+
+        if (scaleValue->IsNumber()) {
+            scale = std::max(0., scaleValue->NumberValue());
+        }
+
+        if (fitValue->IsString()) {
+            v8::String::Utf8Value fit(fitValue);
+
+            cover = std::string(*fit) == "cover";
+        }
+    }
+
+    //async loading (limited decoding memory)
+    AsyncImageWorker *worker = new AsyncImageWorker(callback, obj, bufferObj, maxW, maxH, scale, cover);
+
+    decodeQueue.submit(worker, worker->getMemoryCost());
+}
+
+/**
+ * Set the decoding memory budget (bytes) of all image workers.
+ */
+NAN_METHOD(AminoImage::SetDecodeBudget) {
+    assert(info.Length() == 1);
+
+    double budget = info[0]->NumberValue();
+
+    if (!(budget > 0)) {
+        Nan::ThrowRangeError("invalid budget");
+        return;
+    }
+
+    decodeQueue.setBudget((size_t)budget);
+}
+
+/**
+ * Add image decoding stats.
+ */
+void AminoImage::getStats(v8::Local<v8::Object> &obj) {
+    v8::Local<v8::Object> decodingObj = Nan::New<v8::Object>();
+
+    decodeQueue.getStats(decodingObj);
+    bufferPool.getStats(decodingObj);
+
+    Nan::Set(obj, Nan::New("imageDecoding").ToLocalChecked(), decodingObj);
 }
 
 /**
@@ -677,6 +1426,10 @@ AminoTexture::~AminoTexture()  {
     if (videoLockUsed) {
         uv_mutex_destroy(&videoLock);
     }
+
+    if (surfaceLockUsed) {
+        uv_mutex_destroy(&surfaceLock);
+    }
 }
 
 /**
@@ -710,6 +1463,23 @@ void AminoTexture::destroyAminoTexture(bool destructorCall) {
         uv_mutex_unlock(&videoLock);
     }
 
+    if (surface) {
+        if (eventHandler) {
+            (static_cast<AminoGfx *>(eventHandler))->removeSurface(this);
+        }
+
+        //acquire lock (rendering thread could upload the surface right now)
+        uv_mutex_lock(&surfaceLock);
+
+        for (int i = 0; i < PIXEL_SURFACE_BUFFERS; i++) {
+            surface->buffers[i].Reset();
+        }
+
+        delete surface;
+        surface = NULL;
+        uv_mutex_unlock(&surfaceLock);
+    }
+
     //free texture
     if (textureCount > 0) {
         //Note: we are on the main thread
@@ -765,6 +1535,8 @@ v8::Local<v8::FunctionTemplate> AminoTexture::GetInitFunction() {
     Nan::SetPrototypeMethod(tpl, "loadTextureFromVideo", LoadTextureFromVideo);
     Nan::SetPrototypeMethod(tpl, "loadTextureFromBuffer", LoadTextureFromBuffer);
     Nan::SetPrototypeMethod(tpl, "loadTextureFromFont", LoadTextureFromFont);
+    Nan::SetPrototypeMethod(tpl, "createSurface", CreateSurface);
+    Nan::SetPrototypeMethod(tpl, "commitSurface", CommitSurface);
 
     Nan::SetPrototypeMethod(tpl, "destroy", Destroy);
 
@@ -815,137 +1587,361 @@ GLuint AminoTexture::getTexture() {
     if (activeTexture >= 0) {
         assert(textureIds);
 
-        return textureIds[activeTexture];
+        return textureIds[activeTexture];
+    }
+
+    return INVALID_TEXTURE;
+}
+
+/**
+ * Load texture asynchronously.
+ *
+ * loadTextureFromImage(img, callback)
+ */
+NAN_METHOD(AminoTexture::LoadTextureFromImage) {
+    if (DEBUG_IMAGES) {
+        printf("-> loadTextureFromImage()\n");
+    }
+
+    assert(info.Length() == 2);
+
+    AminoTexture *obj = Nan::ObjectWrap::Unwrap<AminoTexture>(info.This());
+    v8::Local<v8::Function> callback = info[1].As<v8::Function>();
+
+    assert(obj);
+
+    if (obj->callback || obj->pendingUploads > 0 || obj->textureCount > 0) {
+        //already set
+        int argc = 1;
+        v8::Local<v8::Value> argv[1] = { Nan::Error("already loading") };
+
+        callback->Call(info.This(), argc, argv);
+        return;
+    }
+
+    //image
+    AminoImage *img = Nan::ObjectWrap::Unwrap<AminoImage>(info[0]->ToObject());
+
+    assert(img);
+
+    if (!img->hasImage()) {
+        //missing image
+        int argc = 1;
+        v8::Local<v8::Value> argv[1] = { Nan::Error("image not loaded") };
+
+        callback->Call(info.This(), argc, argv);
+        return;
+    }
+
+    //upload
+    amino_texture_upload_t *upload = new amino_texture_upload_t();
+
+    upload->data = img->getPixels();
+    upload->w = img->w;
+    upload->h = img->h;
+    upload->bpp = img->bpp;
+    upload->allowTiles = true;
+    upload->callback = new Nan::Callback(callback);
+
+    //keep pixels until all rows are uploaded (image might be reloaded or destroyed)
+    upload->buffer.Reset(img->getBuffer());
+
+    v8::Local<v8::Value> value = info[0];
+
+    obj->enqueueUpload(upload, value);
+}
+
+/**
+ * Queue a texture upload.
+ *
+ * Note: called on main thread.
+ */
+void AminoTexture::enqueueUpload(amino_texture_upload_t *upload, v8::Local<v8::Value> &value) {
+    if (DEBUG_BASE) {
+        printf("enqueue: create texture\n");
+    }
+
+    upload->texture = this;
+
+    //released after the callback
+    retain();
+    pendingUploads++;
+
+    enqueueValueUpdate(value, upload, static_cast<asyncValueCallback>(&AminoTexture::createTexture));
+}
+
+/**
+ * Pass texture upload to scheduler.
+ */
+void AminoTexture::createTexture(AsyncValueUpdate *update, int state) {
+    if (state == AsyncValueUpdate::STATE_APPLY) {
+        //on OpenGL thread
+        amino_texture_upload_t *upload = (amino_texture_upload_t *)update->data;
+
+        assert(upload);
+
+        if (DEBUG_IMAGES) {
+            printf("-> createTexture() %ix%i bpp=%i\n", upload->w, upload->h, upload->bpp);
+        }
+
+        //owned by the scheduler (freed after the last upload)
+        (static_cast<AminoGfx *>(eventHandler))->addTextureUpload(upload);
+        update->data = NULL;
+    } else if (state == AsyncValueUpdate::STATE_DELETE) {
+        //on main thread
+        amino_texture_upload_t *upload = (amino_texture_upload_t *)update->data;
+
+        if (!upload) {
+            //applied
+            return;
+        }
+
+        //not applied (renderer stopped)
+        upload->failed = true;
+        finishUpload(upload, true);
+        update->data = NULL;
+    }
+}
+
+/**
+ * Prepare the texture before the first slice is uploaded.
+ *
+ * Note: called on rendering thread.
+ */
+bool AminoTexture::startUpload(amino_texture_upload_t *upload) {
+    if (!upload->data || upload->w <= 0 || upload->h <= 0 || upload->bpp < 1 || upload->bpp > 4) {
+        return false;
+    }
+
+    AminoGfx *gfx = static_cast<AminoGfx *>(eventHandler);
+    bool newTexture = textureCount == 0;
+
+    //large image
+    int tileSize = gfx->getTextureTileSize();
+
+    if (newTexture && upload->allowTiles && tileSize > 0 && (upload->w > tileSize || upload->h > tileSize)) {
+        createTiles(upload->w, upload->h, tileSize);
+        bpp = upload->bpp;
+
+        return true;
+    }
+
+    if (newTexture) {
+        textureIds = new GLuint[1];
+        glGenTextures(1, textureIds);
+        textureCount = 1;
+        activeTexture = 0;
+        ownTexture = true;
+
+        gfx->notifyTextureCreated(1);
+    } else {
+        //re-used texture
+        if (!tiles.empty() || getTexture() == INVALID_TEXTURE) {
+            return false;
+        }
+
+        //keep storage of same size
+        upload->allocate = upload->w != w || upload->h != h || upload->bpp != bpp;
+    }
+
+    w = upload->w;
+    h = upload->h;
+    bpp = upload->bpp;
+
+    return true;
+}
+
+/**
+ * Split an image into tiles.
+ *
+ * Note: called on rendering thread.
+ */
+void AminoTexture::createTiles(int imgW, int imgH, int tileSize) {
+    int cols = (imgW + tileSize - 1) / tileSize;
+    int rows = (imgH + tileSize - 1) / tileSize;
+    int count = cols * rows;
+
+    if (DEBUG_IMAGES) {
+        printf("-> createTiles() %ix%i tiles (size=%i)\n", cols, rows, tileSize);
+    }
+
+    textureIds = new GLuint[count];
+    glGenTextures(count, textureIds);
+
+    tiles.clear();
+
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            amino_texture_tile_t tile;
+
+            tile.x = col * tileSize;
+            tile.y = row * tileSize;
+            tile.w = std::min(tileSize, imgW - tile.x);
+            tile.h = std::min(tileSize, imgH - tile.y);
+            tile.uploaded = false;
+
+            tiles.push_back(tile);
+        }
     }
 
-    return INVALID_TEXTURE;
+    textureCount = count;
+    activeTexture = 0;
+    ownTexture = true;
+
+    w = imgW;
+    h = imgH;
+
+    (static_cast<AminoGfx *>(eventHandler))->notifyTextureCreated(count);
 }
 
 /**
- * Load texture asynchronously.
+ * Upload the next rows (at least one row, up to maxBytes).
  *
- * loadTextureFromImage(img, callback)
+ * Returns true if the upload is done.
+ *
+ * Note: called on rendering thread.
  */
-NAN_METHOD(AminoTexture::LoadTextureFromImage) {
-    if (DEBUG_IMAGES) {
-        printf("-> loadTextureFromImage()\n");
-    }
+bool AminoTexture::uploadSlice(amino_texture_upload_t *upload, size_t maxBytes, size_t &bytes) {
+    bytes = 0;
 
-    assert(info.Length() == 2);
+    if (!upload->started) {
+        upload->started = true;
 
-    AminoTexture *obj = Nan::ObjectWrap::Unwrap<AminoTexture>(info.This());
-    v8::Local<v8::Function> callback = info[1].As<v8::Function>();
+        if (!startUpload(upload)) {
+            upload->failed = true;
+        }
+    }
 
-    assert(obj);
+    //texture destroyed
+    if (!upload->failed && textureCount == 0) {
+        upload->failed = true;
+    }
 
-    if (obj->callback || obj->textureCount > 0) {
-        //already set
-        int argc = 1;
-        v8::Local<v8::Value> argv[1] = { Nan::Error("already loading") };
+    if (upload->failed) {
+        return true;
+    }
 
-        callback->Call(info.This(), argc, argv);
-        return;
+    //target region
+    bool tiled = !tiles.empty();
+    int x = 0;
+    int y = 0;
+    int regionW = upload->w;
+    int regionH = upload->h;
+    GLuint textureId;
+
+    if (tiled) {
+        amino_texture_tile_t &tile = tiles[upload->tile];
+
+        x = tile.x;
+        y = tile.y;
+        regionW = tile.w;
+        regionH = tile.h;
+        textureId = textureIds[upload->tile];
+    } else {
+        textureId = getTexture();
     }
 
-    //image
-    AminoImage *img = Nan::ObjectWrap::Unwrap<AminoImage>(info[0]->ToObject());
+    //rows
+    size_t stride = upload->w * upload->bpp;
+    size_t rowLength = regionW * upload->bpp;
+    int rows = std::max(1, std::min(regionH - upload->row, (int)(maxBytes / rowLength)));
+    char *src = upload->data + (y + upload->row) * stride + x * upload->bpp;
 
-    assert(img);
+    if (upload->allocate && upload->row == 0 && rows == regionH && stride == rowLength) {
+        //complete texture
+        AminoImage::createTexture(textureId, src, rowLength * rows, regionW, regionH, upload->bpp);
+    } else {
+        if (upload->allocate && upload->row == 0) {
+            AminoImage::createTexture(textureId, NULL, 0, regionW, regionH, upload->bpp);
+        }
 
-    if (!img->hasImage()) {
-        //missing image
-        int argc = 1;
-        v8::Local<v8::Value> argv[1] = { Nan::Error("image not loaded") };
+        int allocations = 0;
 
-        callback->Call(info.This(), argc, argv);
-        return;
-    }
+        AminoImage::updateTexture(textureId, src, stride, 0, upload->row, regionW, rows, upload->bpp, &allocations);
 
-    if (DEBUG_BASE) {
-        printf("enqueue: create texture\n");
+        if (allocations) {
+            (static_cast<AminoGfx *>(eventHandler))->addBufferAllocations(allocations);
+        }
     }
 
-    //async loading
-    obj->callback = new Nan::Callback(callback);
-    obj->enqueueValueUpdate(img, static_cast<asyncValueCallback>(&AminoTexture::createTexture));
-}
+    upload->row += rows;
+    bytes = rowLength * rows;
 
-/**
- * Create texture from image.
- */
-void AminoTexture::createTexture(AsyncValueUpdate *update, int state) {
-    if (state == AsyncValueUpdate::STATE_APPLY) {
-        //create texture on OpenGL thread
+    if (upload->row < regionH) {
+        return false;
+    }
 
-        if (DEBUG_IMAGES) {
-            printf("-> createTexture()\n");
-        }
+    //region done
+    if (!tiled) {
+        return true;
+    }
 
-        AminoImage *img = static_cast<AminoImage *>(update->valueObj);
+    tiles[upload->tile].uploaded = true;
+    upload->tile++;
+    upload->row = 0;
 
-        assert(img);
+    return upload->tile >= tiles.size();
+}
 
-        bool newTexture = textureCount == 0;
-        GLuint textureId = img->createTexture(getTexture());
+/**
+ * Upload done (switch to main thread).
+ *
+ * Note: called on rendering thread.
+ */
+void AminoTexture::notifyUploadDone(amino_texture_upload_t *upload) {
+    enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoTexture::handleUploadDone), NULL, upload);
+}
 
-        //debug
-        //printf("-> createTexture() new=%i id=%i\n", (int)newTexture, (int)textureId);
+/**
+ * Upload done (on main thread).
+ */
+void AminoTexture::handleUploadDone(JSCallbackUpdate *update) {
+    //create scope
+    Nan::HandleScope scope;
 
-        if (textureId != INVALID_TEXTURE) {
-            //set values
-            if (newTexture) {
-                textureIds = new GLuint[1];
-                textureIds[0] = textureId;
-                textureCount = 1;
-                activeTexture = 0;
-                ownTexture = true;
-            } else {
-                //re-used texture
-                assert(getTexture() == textureId);
-            }
+    amino_texture_upload_t *upload = (amino_texture_upload_t *)update->data;
 
-            w = img->w;
-            h = img->h;
+    assert(upload);
 
-            if (newTexture) {
-               (static_cast<AminoGfx *>(eventHandler))->notifyTextureCreated(1);
-            }
-        } else {
-            activeTexture = -1;
-        }
-    } else if (state == AsyncValueUpdate::STATE_DELETE) {
-        //on main thread
+    finishUpload(upload, true);
+}
 
+/**
+ * Call the callback and free the upload.
+ *
+ * Note: called on main thread.
+ */
+void AminoTexture::finishUpload(amino_texture_upload_t *upload, bool notify) {
+    if (notify && upload->callback) {
         v8::Local<v8::Object> obj = handle();
 
-        if (activeTexture < 0) {
+        if (upload->failed || textureCount == 0) {
             //failed
+            int argc = 1;
+            v8::Local<v8::Value> argv[1] = { Nan::Error("could not create texture") };
 
-            if (callback) {
-                int argc = 1;
-                v8::Local<v8::Value> argv[1] = { Nan::Error("could not create texture") };
-
-                callback->Call(obj, argc, argv);
-                delete callback;
-                callback = NULL;
-            }
-
-            return;
-        }
-
-        Nan::Set(obj, Nan::New("w").ToLocalChecked(), Nan::New(w));
-        Nan::Set(obj, Nan::New("h").ToLocalChecked(), Nan::New(h));
+            upload->callback->Call(obj, argc, argv);
+        } else {
+            Nan::Set(obj, Nan::New("w").ToLocalChecked(), Nan::New(w));
+            Nan::Set(obj, Nan::New("h").ToLocalChecked(), Nan::New(h));
 
-        //callback
-        if (callback) {
             int argc = 2;
             v8::Local<v8::Value> argv[2] = { Nan::Null(), obj };
 
-            callback->Call(obj, argc, argv);
-            delete callback;
-            callback = NULL;
+            upload->callback->Call(obj, argc, argv);
         }
     }
+
+    //free
+    if (upload->callback) {
+        delete upload->callback;
+    }
+
+    upload->buffer.Reset();
+    delete upload;
+
+    pendingUploads--;
+    release();
 }
 
 /**
@@ -1277,27 +2273,26 @@ void AminoTexture::handleFireVideoEvent(JSCallbackUpdate *update) {
     //create scope
     Nan::HandleScope scope;
 
-    //call
+    callFireEvent(event->c_str());
+
+    delete event;
+}
+
+/**
+ * Call JS fireEvent() (on main thread).
+ */
+void AminoTexture::callFireEvent(const char *event) {
     v8::Local<v8::Function> fireEventFunc = Nan::Get(handle(), Nan::New<v8::String>("fireEvent").ToLocalChecked()).ToLocalChecked().As<v8::Function>();
     int argc = 1;
-    v8::Local<v8::Value> argv[] = { Nan::New<v8::String>(event->c_str()).ToLocalChecked() };
+    v8::Local<v8::Value> argv[] = { Nan::New<v8::String>(event).ToLocalChecked() };
 
     fireEventFunc->Call(handle(), argc, argv);
-
-    delete event;
 }
 
-typedef struct {
-    char *bufferData;
-    size_t bufferLen;
-    int w;
-    int h;
-    int bpp;
-    Nan::Callback *callback;
-} amino_texture_t;
-
 /**
  * Load texture from pixel buffer.
+ *
+ * loadTextureFromBuffer(data, callback)
  */
 NAN_METHOD(AminoTexture::LoadTextureFromBuffer) {
     if (DEBUG_IMAGES) {
@@ -1315,106 +2310,294 @@ NAN_METHOD(AminoTexture::LoadTextureFromBuffer) {
     v8::Local<v8::Value> data = info[0];
     v8::Local<v8::Object> dataObj = data->ToObject();
     v8::Local<v8::Object> bufferObj = Nan::Get(dataObj, Nan::New<v8::String>("buffer").ToLocalChecked()).ToLocalChecked()->ToObject();
-    amino_texture_t *textureData = new amino_texture_t();
+    amino_texture_upload_t *upload = new amino_texture_upload_t();
 
-    textureData->bufferData = node::Buffer::Data(bufferObj);
-    textureData->bufferLen = node::Buffer::Length(bufferObj);
+    upload->data = node::Buffer::Data(bufferObj);
+    upload->w = Nan::Get(dataObj, Nan::New<v8::String>("w").ToLocalChecked()).ToLocalChecked()->IntegerValue();
+    upload->h = Nan::Get(dataObj, Nan::New<v8::String>("h").ToLocalChecked()).ToLocalChecked()->IntegerValue();
+    upload->bpp = Nan::Get(dataObj, Nan::New<v8::String>("bpp").ToLocalChecked()).ToLocalChecked()->IntegerValue();
 
-    textureData->w = Nan::Get(dataObj, Nan::New<v8::String>("w").ToLocalChecked()).ToLocalChecked()->IntegerValue();
-    textureData->h = Nan::Get(dataObj, Nan::New<v8::String>("h").ToLocalChecked()).ToLocalChecked()->IntegerValue();
-    textureData->bpp = Nan::Get(dataObj, Nan::New<v8::String>("bpp").ToLocalChecked()).ToLocalChecked()->IntegerValue();
+    assert(upload->w * upload->h * upload->bpp == (int)node::Buffer::Length(bufferObj));
+
+    //keep buffer until all rows are uploaded
+    upload->buffer.Reset(bufferObj);
 
     //callback
     v8::Local<v8::Function> callback = info[1].As<v8::Function>();
 
-    textureData->callback = new Nan::Callback(callback);
+    upload->callback = new Nan::Callback(callback);
 
-    if (DEBUG_BASE) {
-        printf("enqueue: create texture from buffer\n");
+    //async loading
+    obj->enqueueUpload(upload, data);
+}
+
+/**
+ * Create a pixel surface.
+ *
+ * createSurface(w, h, bpp, callback)
+ *
+ * Returns the pixel buffers (double buffering). The callback is called once the texture was created.
+ */
+NAN_METHOD(AminoTexture::CreateSurface) {
+    if (DEBUG_IMAGES) {
+        printf("-> createSurface()\n");
     }
 
-    //async loading
-    obj->enqueueValueUpdate(data, textureData, static_cast<asyncValueCallback>(&AminoTexture::createTextureFromBuffer));
+    assert(info.Length() == 4);
+
+    AminoTexture *obj = Nan::ObjectWrap::Unwrap<AminoTexture>(info.This());
+
+    assert(obj);
+
+    int w = info[0]->Int32Value();
+    int h = info[1]->Int32Value();
+    int bpp = info[2]->Int32Value();
+    v8::Local<v8::Function> callback = info[3].As<v8::Function>();
+
+    if (obj->surface || obj->callback || obj->pendingUploads > 0 || obj->textureCount > 0) {
+        //already set
+        int argc = 1;
+        v8::Local<v8::Value> argv[1] = { Nan::Error("already loading") };
+
+        callback->Call(info.This(), argc, argv);
+        return;
+    }
+
+    if (w <= 0 || h <= 0 || bpp < 1 || bpp > 4) {
+        Nan::ThrowRangeError("invalid surface");
+        return;
+    }
+
+    //buffers
+    amino_pixel_surface_t *surface = new amino_pixel_surface_t();
+    v8::Local<v8::Array> arr = Nan::New<v8::Array>();
+    size_t len = w * h * bpp;
+
+    surface->w = w;
+    surface->h = h;
+    surface->bpp = bpp;
+
+    for (int i = 0; i < PIXEL_SURFACE_BUFFERS; i++) {
+        v8::Local<v8::Object> buffer = Nan::NewBuffer(len).ToLocalChecked();
+
+        surface->data[i] = node::Buffer::Data(buffer);
+        surface->buffers[i].Reset(buffer);
+        memset(surface->data[i], 0, len);
+
+        Nan::Set(arr, i, buffer);
+    }
+
+    //lock
+    if (!obj->surfaceLockUsed) {
+        uv_mutex_init(&obj->surfaceLock);
+        obj->surfaceLockUsed = true;
+    }
+
+    obj->surface = surface;
+
+    //upload committed rectangles once per frame
+    (static_cast<AminoGfx *>(obj->eventHandler))->addSurface(obj);
+
+    //create texture (first buffer)
+    amino_texture_upload_t *upload = new amino_texture_upload_t();
+    v8::Local<v8::Value> value = arr;
+
+    upload->data = surface->data[0];
+    upload->w = w;
+    upload->h = h;
+    upload->bpp = bpp;
+    upload->buffer.Reset(Nan::Get(arr, 0).ToLocalChecked());
+    upload->callback = new Nan::Callback(callback);
+
+    obj->enqueueUpload(upload, value);
+
+    info.GetReturnValue().Set(arr);
 }
 
 /**
- * Create texture.
+ * Commit the dirty rectangles of the current buffer.
+ *
+ * commitSurface([ x, y, w, h, ... ])
+ *
+ * No rectangles marks the whole surface. Returns the buffer to write next or -1 if the previous commit is still being
+ * uploaded (the rectangles are kept, commit again after the 'surface' event).
  */
-void AminoTexture::createTextureFromBuffer(AsyncValueUpdate *update, int state) {
-    if (state == AsyncValueUpdate::STATE_APPLY) {
-        //create texture on OpenGL thread
+NAN_METHOD(AminoTexture::CommitSurface) {
+    AminoTexture *obj = Nan::ObjectWrap::Unwrap<AminoTexture>(info.This());
 
-        if (DEBUG_IMAGES) {
-            printf("-> createTextureFromBuffer()\n");
+    assert(obj);
+
+    amino_pixel_surface_t *surface = obj->surface;
+
+    if (!surface) {
+        Nan::ThrowError("no surface");
+        return;
+    }
+
+    //dirty rectangles
+    if (info.Length() == 0 || !info[0]->IsArray()) {
+        obj->addSurfaceRect(0, 0, surface->w, surface->h);
+    } else {
+        v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(info[0]);
+        uint32_t count = arr->Length() / 4;
+
+        for (uint32_t i = 0; i < count; i++) {
+            int x = Nan::Get(arr, i * 4).ToLocalChecked()->Int32Value();
+            int y = Nan::Get(arr, i * 4 + 1).ToLocalChecked()->Int32Value();
+            int w = Nan::Get(arr, i * 4 + 2).ToLocalChecked()->Int32Value();
+            int h = Nan::Get(arr, i * 4 + 3).ToLocalChecked()->Int32Value();
+
+            obj->addSurfaceRect(x, y, w, h);
         }
+    }
+
+    //previous commit not uploaded yet
+    if (surface->uploading) {
+        info.GetReturnValue().Set(-1);
+        return;
+    }
 
-        amino_texture_t *textureData = (amino_texture_t *)update->data;
+    if (surface->dirtyRects.empty()) {
+        info.GetReturnValue().Set(surface->writeBuffer);
+        return;
+    }
 
-        assert(textureData);
+    //pass to rendering thread
+    int committed = surface->writeBuffer;
 
-        bool newTexture = textureCount == 0;
-        GLuint textureId = AminoImage::createTexture(getTexture(), textureData->bufferData, textureData->bufferLen, textureData->w, textureData->h, textureData->bpp);
+    uv_mutex_lock(&obj->surfaceLock);
 
-        if (textureId != INVALID_TEXTURE) {
-            //set values
-            if (newTexture) {
-                textureIds = new GLuint[1];
-                textureIds[0] = textureId;
-                textureCount = 1;
-                activeTexture = 0;
-                ownTexture = true;
-            } else {
-                //re-used texture
-                assert(getTexture() == textureId);
-            }
+    surface->uploadBuffer = committed;
+    surface->uploadRects = surface->dirtyRects;
 
-            w = textureData->w;
-            h = textureData->h;
+    uv_mutex_unlock(&obj->surfaceLock);
 
-            if (newTexture) {
-                (static_cast<AminoGfx *>(eventHandler))->notifyTextureCreated(1);
-            }
-        } else {
-            activeTexture = -1;
+    surface->uploading = true;
+
+    //double buffering: continue with the other buffer
+    int next = (committed + 1) % PIXEL_SURFACE_BUFFERS;
+    size_t stride = surface->w * surface->bpp;
+
+    //copy the committed changes (buffer is not in use)
+    for (auto const &rect : surface->dirtyRects) {
+        size_t offset = rect.y * stride + rect.x * surface->bpp;
+        size_t rowLength = rect.w * surface->bpp;
+
+        for (int i = 0; i < rect.h; i++) {
+            memcpy(surface->data[next] + offset + i * stride, surface->data[committed] + offset + i * stride, rowLength);
         }
-    } else if (state == AsyncValueUpdate::STATE_DELETE) {
-        //on main thread
-        amino_texture_t *textureData = (amino_texture_t *)update->data;
+    }
 
-        assert(textureData);
+    surface->writeBuffer = next;
 
-        if (activeTexture < 0) {
-            //failed
+    surface->dirtyRects.clear();
 
-            if (textureData->callback) {
-                int argc = 1;
-                v8::Local<v8::Value> argv[1] = { Nan::Error("could not create texture") };
+    info.GetReturnValue().Set(surface->writeBuffer);
+}
 
-                textureData->callback->Call(handle(), argc, argv);
-                delete textureData->callback;
-            }
+/**
+ * Add a dirty rectangle (clipped to the surface).
+ *
+ * Note: called on main thread.
+ */
+void AminoTexture::addSurfaceRect(int x, int y, int w, int h) {
+    assert(surface);
 
-            return;
-        }
+    int x2 = std::min(x + w, surface->w);
+    int y2 = std::min(y + h, surface->h);
 
-        v8::Local<v8::Object> obj = handle();
+    x = std::max(x, 0);
+    y = std::max(y, 0);
 
-        Nan::Set(obj, Nan::New("w").ToLocalChecked(), Nan::New(w));
-        Nan::Set(obj, Nan::New("h").ToLocalChecked(), Nan::New(h));
+    if (x2 <= x || y2 <= y) {
+        return;
+    }
 
-        //callback
-        if (textureData->callback) {
-            int argc = 2;
-            v8::Local<v8::Value> argv[2] = { Nan::Null(), obj };
+    std::vector<amino_surface_rect_t> &rects = surface->dirtyRects;
+
+    //merge into bounding box
+    if (rects.size() >= PIXEL_SURFACE_MAX_RECTS) {
+        amino_surface_rect_t &box = rects[0];
+        int boxX2 = x2;
+        int boxY2 = y2;
 
-            textureData->callback->Call(obj, argc, argv);
-            delete textureData->callback;
+        for (auto const &rect : rects) {
+            x = std::min(x, rect.x);
+            y = std::min(y, rect.y);
+            boxX2 = std::max(boxX2, rect.x + rect.w);
+            boxY2 = std::max(boxY2, rect.y + rect.h);
         }
 
-        //free
-        delete textureData;
-        update->data = NULL;
+        box.x = x;
+        box.y = y;
+        box.w = boxX2 - x;
+        box.h = boxY2 - y;
+
+        rects.resize(1);
+        return;
+    }
+
+    amino_surface_rect_t rect;
+
+    rect.x = x;
+    rect.y = y;
+    rect.w = x2 - x;
+    rect.h = y2 - y;
+
+    rects.push_back(rect);
+}
+
+/**
+ * Upload the committed surface rectangles.
+ *
+ * Note: called on rendering thread (before the scene is rendered).
+ */
+void AminoTexture::updateSurfaceTexture() {
+    uv_mutex_lock(&surfaceLock);
+
+    GLuint textureId = getTexture();
+
+    if (!surface || surface->uploadBuffer < 0 || textureId == INVALID_TEXTURE) {
+        uv_mutex_unlock(&surfaceLock);
+        return;
+    }
+
+    char *data = surface->data[surface->uploadBuffer];
+    size_t stride = surface->w * surface->bpp;
+
+    int allocations = 0;
+
+    for (auto const &rect : surface->uploadRects) {
+        AminoImage::updateTexture(textureId, data + rect.y * stride + rect.x * surface->bpp, stride, rect.x, rect.y, rect.w, rect.h, surface->bpp, &allocations);
+    }
+
+    if (allocations) {
+        (static_cast<AminoGfx *>(eventHandler))->addBufferAllocations(allocations);
+    }
+
+    surface->uploadBuffer = -1;
+    surface->uploadRects.clear();
+
+    uv_mutex_unlock(&surfaceLock);
+
+    //switch to main thread
+    enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoTexture::handleSurfaceUploaded), NULL, NULL);
+}
+
+/**
+ * Surface uploaded (on main thread).
+ */
+void AminoTexture::handleSurfaceUploaded(JSCallbackUpdate *update) {
+    if (!surface) {
+        return;
     }
+
+    surface->uploading = false;
+
+    //create scope
+    Nan::HandleScope scope;
+
+    callFireEvent("surface");
 }
 
 /**
@@ -1472,9 +2655,24 @@ void AminoTexture::createTextureFromFont(AsyncValueUpdate *update, int state) {
         assert(eventHandler);
 
         //use current font texture
+        uv_mutex_lock(&AminoText::freeTypeMutex);
+
         texture_atlas_t *atlas = fontSize->fontTexture->atlas;
-        bool newTexture;
-        GLuint textureId = (static_cast<AminoGfx *>(eventHandler))->getAtlasTexture(atlas, true, newTexture).textureId;
+        AminoFont *font = fontSize->font;
+        GLuint textureId = INVALID_TEXTURE;
+
+        for (size_t i = 0; i < font->getPageCount(); i++) {
+            amino_font_page_t *page = font->getPage(i);
+
+            if (page->atlas == atlas) {
+                bool newTexture;
+
+                textureId = (static_cast<AminoGfx *>(eventHandler))->getAtlasTexture(page, true, newTexture).textureId;
+                break;
+            }
+        }
+
+        uv_mutex_unlock(&AminoText::freeTypeMutex);
 
         if (textureId != INVALID_TEXTURE) {
             //set values
@@ -5,7 +5,139 @@
 #include "gfx.h"
 #include "videos.h"
 
+#include <uv.h>
+#include <deque>
+#include <vector>
+
+//decoding memory of all running image workers (configurable)
+#define IMAGE_DECODE_BUDGET (128 * 1024 * 1024)
+
+//scanlines per decoder call
+#define IMAGE_DECODE_ROWS 16
+
+//pooled decoding buffers (power of two size classes from 64 KB to 64 MB)
+#define IMAGE_POOL_MIN_CLASS 16
+#define IMAGE_POOL_MAX_CLASS 26
+#define IMAGE_POOL_MAX_BYTES (32 * 1024 * 1024)
+
+//texture uploads per frame (configurable, 0: no limit)
+#define TEXTURE_UPLOAD_TIME 4
+#define TEXTURE_UPLOAD_BYTES (8 * 1024 * 1024)
+
+//maximum size of a single upload call (granularity of the time budget)
+#define TEXTURE_UPLOAD_SLICE (1024 * 1024)
+
+/**
+ * Size-classed pool of decoding buffers (reused across decodes).
+ *
+ * Note: thread-safe.
+ */
+class AminoImageBufferPool {
+public:
+    AminoImageBufferPool();
+    ~AminoImageBufferPool();
+
+    unsigned char *get(size_t size, bool *allocated = NULL);
+    void put(unsigned char *buffer, size_t size);
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+private:
+    uv_mutex_t lock;
+    std::vector<unsigned char *> buffers[IMAGE_POOL_MAX_CLASS - IMAGE_POOL_MIN_CLASS + 1];
+    size_t pooledBytes = 0;
+
+    //stats
+    unsigned int requests = 0;
+    unsigned int hits = 0;
+
+    static int getSizeClass(size_t size);
+};
+
+/**
+ * Image decoding queue.
+ *
+ * Starts decoding jobs as long as their estimated memory fits into the budget (at least one job is always running).
+ * Jobs are started in order.
+ *
+ * Note: called on main thread.
+ */
+class AminoImageDecodeQueue {
+public:
+    void setBudget(size_t budget);
+    void submit(Nan::AsyncWorker *worker, size_t cost);
+    void release(size_t cost);
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+private:
+    size_t budget = IMAGE_DECODE_BUDGET;
+    size_t used = 0;
+    unsigned int running = 0;
+    std::deque<std::pair<Nan::AsyncWorker *, size_t> > queue;
+
+    void startNext();
+};
+
 class AminoImageFactory;
+class AminoTexture;
+
+/**
+ * Pending texture upload (image or buffer).
+ */
+struct amino_texture_upload_t {
+    AminoTexture *texture = NULL;
+
+    //source
+    char *data = NULL;
+    int w = 0;
+    int h = 0;
+    int bpp = 0;
+    bool allowTiles = false;
+
+    //progress (rendering thread)
+    bool started = false;
+    bool failed = false;
+    bool allocate = true;
+    size_t tile = 0;
+    int row = 0;
+    size_t bytesLeft = 0;
+
+    //source objects (main thread)
+    Nan::Persistent<v8::Value> buffer;
+    Nan::Callback *callback = NULL;
+};
+
+/**
+ * Texture upload scheduler.
+ *
+ * Executes the queued uploads in order within a per-frame time and byte budget. Large uploads are split into row ranges.
+ * At least one slice is uploaded per frame.
+ *
+ * Note: called on rendering thread.
+ */
+class AminoTextureUploader {
+public:
+    void setBudget(double time, size_t bytes);
+    void add(amino_texture_upload_t *upload);
+    void addBytes(size_t bytes);
+    void process();
+    void clear();
+
+    void getStats(v8::Local<v8::Object> &obj);
+
+private:
+    std::deque<amino_texture_upload_t *> queue;
+    double budgetTime = TEXTURE_UPLOAD_TIME;
+    size_t budgetBytes = TEXTURE_UPLOAD_BYTES;
+
+    //current frame
+    size_t frameBytes = 0;
+
+    //stats
+    size_t deferredBytes = 0;
+    size_t lastFrameBytes = 0;
+};
 
 /**
  * Amino Image Loader.
@@ -25,11 +157,19 @@ public:
     bool hasImage();
     void destroy() override;
     void destroyAminoImage();
-    GLuint createTexture(GLuint textureId);
+    char *getPixels();
+    v8::Local<v8::Object> getBuffer();
     static GLuint createTexture(GLuint textureId, char *bufferData, size_t bufferLength, int w, int h, int bpp);
+    static void updateTexture(GLuint textureId, char *bufferData, size_t stride, int x, int y, int w, int h, int bpp, int *allocations = NULL);
 
     void imageLoaded(v8::Local<v8::Object> &buffer, int w, int h, bool alpha, int bpp);
 
+    //decoding
+    static AminoImageBufferPool bufferPool;
+    static AminoImageDecodeQueue decodeQueue;
+
+    static void getStats(v8::Local<v8::Object> &obj);
+
     //creation
     static AminoImageFactory* getFactory();
 
@@ -46,6 +186,7 @@ private:
 
     //JS methods
     static NAN_METHOD(loadImage);
+    static NAN_METHOD(SetDecodeBudget);
 };
 
 /**
@@ -60,8 +201,62 @@ public:
 
 class AminoTextureFactory;
 
+/**
+ * Texture tile (image region).
+ */
+struct amino_texture_tile_t {
+    int x;
+    int y;
+    int w;
+    int h;
+    bool uploaded;
+};
+
+//pixel surface buffers (double buffering)
+#define PIXEL_SURFACE_BUFFERS 2
+
+//merge dirty rectangles above this count
+#define PIXEL_SURFACE_MAX_RECTS 16
+
+/**
+ * Pixel surface rectangle.
+ */
+struct amino_surface_rect_t {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
+/**
+ * Pixel surface.
+ *
+ * JS writes into persistent buffers and commits the dirty rectangles. JS writes the next buffer while the committed one
+ * is uploaded.
+ */
+struct amino_pixel_surface_t {
+    int w = 0;
+    int h = 0;
+    int bpp = 0;
+    char *data[PIXEL_SURFACE_BUFFERS];
+    Nan::Persistent<v8::Object> buffers[PIXEL_SURFACE_BUFFERS];
+
+    //main thread
+    int writeBuffer = 0;
+    bool uploading = false;
+    std::vector<amino_surface_rect_t> dirtyRects;
+
+    //rendering thread (surfaceLock)
+    int uploadBuffer = -1;
+    std::vector<amino_surface_rect_t> uploadRects;
+};
+
 /**
  * Amino Texture class.
+ *
+ * Images larger than the maximum texture size are split into tiles (one texture per tile). All image and buffer uploads
+ * are passed to the upload scheduler of the AminoGfx instance. Pixel surfaces upload their dirty rectangles once per
+ * frame (also if not visible).
  */
 class AminoTexture : public AminoJSObject {
 public:
@@ -71,6 +266,10 @@ public:
     bool ownTexture = true;
     int w = 0;
     int h = 0;
+    int bpp = 0;
+
+    //tiled image (textureIds in row order)
+    std::vector<amino_texture_tile_t> tiles;
 
     AminoTexture();
     ~AminoTexture();
@@ -86,6 +285,9 @@ public:
 
     //texture
     GLuint getTexture();
+    bool uploadSlice(amino_texture_upload_t *upload, size_t maxBytes, size_t &bytes);
+    void notifyUploadDone(amino_texture_upload_t *upload);
+    void finishUpload(amino_texture_upload_t *upload, bool notify);
 
     //video
     void initVideoTexture();
@@ -93,9 +295,20 @@ public:
     void prepareTexture(GLContext *ctx);
     void fireVideoEvent(std::string event);
 
+    //pixel surface
+    void updateSurfaceTexture();
+
 private:
     Nan::Callback *callback = NULL;
 
+    //uploads (on main thread)
+    int pendingUploads = 0;
+
+    //pixel surface
+    amino_pixel_surface_t *surface = NULL;
+    uv_mutex_t surfaceLock;
+    bool surfaceLockUsed = false;
+
     //video
     AminoVideoPlayer *videoPlayer = NULL;
     uv_mutex_t videoLock;
@@ -111,6 +324,8 @@ private:
     static NAN_METHOD(LoadTextureFromVideo);
     static NAN_METHOD(LoadTextureFromBuffer);
     static NAN_METHOD(LoadTextureFromFont);
+    static NAN_METHOD(CreateSurface);
+    static NAN_METHOD(CommitSurface);
     static NAN_METHOD(Destroy);
     static NAN_METHOD(GetMediaTime);
     static NAN_METHOD(GetDuration);
@@ -119,10 +334,16 @@ private:
     static NAN_METHOD(PausePlayback);
     static NAN_METHOD(ResumePlayback);
 
+    void enqueueUpload(amino_texture_upload_t *upload, v8::Local<v8::Value> &value);
     void createTexture(AsyncValueUpdate *update, int state);
+    bool startUpload(amino_texture_upload_t *upload);
+    void createTiles(int imgW, int imgH, int tileSize);
+    void handleUploadDone(JSCallbackUpdate *update);
     void createVideoTexture(AsyncValueUpdate *update, int state);
-    void createTextureFromBuffer(AsyncValueUpdate *update, int state);
     void createTextureFromFont(AsyncValueUpdate *update, int state);
+    void addSurfaceRect(int x, int y, int w, int h);
+    void handleSurfaceUploaded(JSCallbackUpdate *update);
+    void callFireEvent(const char *event);
 
     void initVideoTextureHandler(AsyncValueUpdate *update, int state);
     void handleVideoPlayerInitDone(JSCallbackUpdate *update);
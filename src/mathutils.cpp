@@ -10,11 +10,11 @@ void clear_matrix(GLfloat *m) {
 }
 
 /**
- * Create y-rotation matrix.
+ * Create y-rotation matrix (scalar reference).
  *
  * @param angle angle in degrees.
  */
-void make_y_rot_matrix(GLfloat angle, GLfloat *m) {
+void make_y_rot_matrix_scalar(GLfloat angle, GLfloat *m) {
     float rad = angle * M_PI / 180.0f;
     float c = cos(rad);
     float s = sin(rad);
@@ -35,11 +35,11 @@ void make_y_rot_matrix(GLfloat angle, GLfloat *m) {
 }
 
 /**
- * Create z-rotation matrix.
+ * Create z-rotation matrix (scalar reference).
  *
  * @param angle angle in degrees.
  */
-void make_z_rot_matrix(GLfloat angle, GLfloat *m) {
+void make_z_rot_matrix_scalar(GLfloat angle, GLfloat *m) {
     float rad = angle * M_PI / 180.0f;
     float c = cos(rad);
     float s = sin(rad);
@@ -60,11 +60,11 @@ void make_z_rot_matrix(GLfloat angle, GLfloat *m) {
 }
 
 /**
- * Create x-rotation matrix.
+ * Create x-rotation matrix (scalar reference).
  *
  * @param angle angle in degrees.
  */
-void make_x_rot_matrix(GLfloat angle, GLfloat *m) {
+void make_x_rot_matrix_scalar(GLfloat angle, GLfloat *m) {
     float rad = angle * M_PI / 180.0f;
     float c = cos(rad);
     float s = sin(rad);
@@ -336,11 +336,11 @@ bool make_square_to_quad_matrix(GLfloat dx0, GLfloat dy0, GLfloat dx1, GLfloat d
 }
 
 /**
- * Matrix multiplication (4x4).
+ * Matrix multiplication (4x4, scalar reference).
  *
  * @param prod result
  */
-void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
+void mul_matrix_scalar(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
 #define A(row,col)  a[(col<<2)+row]
 #define B(row,col)  b[(col<<2)+row]
 #define P(row,col)  p[(col<<2)+row]
@@ -397,9 +397,9 @@ void loadOrthoMatrix(GLfloat *modelView, GLfloat left, GLfloat right, GLfloat bo
 }
 
 /**
- * Copy a matrix.
+ * Copy a matrix (scalar reference).
  */
-void copy_matrix(GLfloat *dst, const GLfloat *src) {
+void copy_matrix_scalar(GLfloat *dst, const GLfloat *src) {
     for (int i = 0; i < 16; i++) {
         dst[i] = src[i];
     }
@@ -538,12 +538,10 @@ void transpose_matrix(GLfloat *b, const GLfloat *a) {
 }
 
 /**
- * Invert a matrix.
+ * Calculate the adjugate matrix and determinant.
  */
-bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]) {
+static void adjugate_matrix(const GLfloat m[16], GLfloat inv[16], GLfloat &det) {
     //see http://stackoverflow.com/questions/1148309/inverting-a-4x4-matrix
-    GLfloat inv[16], det;
-    int i;
 
     inv[0] = m[5]  * m[10] * m[15] -
              m[5]  * m[11] * m[14] -
@@ -658,6 +656,16 @@ bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]) {
               m[8] * m[2] * m[5];
 
     det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+}
+
+/**
+ * Invert a matrix (scalar reference).
+ */
+bool invert_matrix_scalar(const GLfloat m[16], GLfloat invOut[16]) {
+    GLfloat inv[16], det;
+    int i;
+
+    adjugate_matrix(m, inv, det);
 
     if (det == 0) {
         return false;
@@ -670,4 +678,306 @@ bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]) {
     }
 
     return true;
-}
\ No newline at end of file
+}
+/*
+ * SIMD kernels (NEON on ARM).
+ *
+ * The scalar versions above are used if AMINO_NO_SIMD is defined or on other architectures (SSE and AVX builds showed
+ * no gain over the auto-vectorized scalar code on x86).
+ */
+
+#if defined(AMINO_SIMD_NEON)
+    #include <arm_neon.h>
+#endif
+
+/**
+ * Store a 4x4 matrix by columns.
+ */
+static inline void store_matrix_columns(GLfloat *m, GLfloat c0x, GLfloat c0y, GLfloat c0z, GLfloat c1x, GLfloat c1y, GLfloat c1z, GLfloat c2x, GLfloat c2y, GLfloat c2z) {
+#if defined(AMINO_SIMD_NEON)
+    const float32x4_t col0 = { c0x, c0y, c0z, 0.f };
+    const float32x4_t col1 = { c1x, c1y, c1z, 0.f };
+    const float32x4_t col2 = { c2x, c2y, c2z, 0.f };
+    const float32x4_t col3 = { 0.f, 0.f, 0.f, 1.f };
+
+    vst1q_f32(m, col0);
+    vst1q_f32(m + 4, col1);
+    vst1q_f32(m + 8, col2);
+    vst1q_f32(m + 12, col3);
+#else
+    m[0] = c0x;  m[1] = c0y;  m[2] = c0z;   m[3] = 0.f;
+    m[4] = c1x;  m[5] = c1y;  m[6] = c1z;   m[7] = 0.f;
+    m[8] = c2x;  m[9] = c2y;  m[10] = c2z;  m[11] = 0.f;
+    m[12] = 0.f; m[13] = 0.f; m[14] = 0.f;  m[15] = 1.f;
+#endif
+}
+
+/**
+ * Create x-rotation matrix.
+ *
+ * @param angle angle in degrees.
+ */
+void make_x_rot_matrix(GLfloat angle, GLfloat *m) {
+    float rad = angle * M_PI / 180.0f;
+    float c = cos(rad);
+    float s = sin(rad);
+
+    store_matrix_columns(m,
+        1.f, 0.f, 0.f,
+        0.f, c, s,
+        0.f, -s, c);
+}
+
+/**
+ * Create y-rotation matrix.
+ *
+ * @param angle angle in degrees.
+ */
+void make_y_rot_matrix(GLfloat angle, GLfloat *m) {
+    float rad = angle * M_PI / 180.0f;
+    float c = cos(rad);
+    float s = sin(rad);
+
+    store_matrix_columns(m,
+        c, 0.f, -s,
+        0.f, 1.f, 0.f,
+        s, 0.f, c);
+}
+
+/**
+ * Create z-rotation matrix.
+ *
+ * @param angle angle in degrees.
+ */
+void make_z_rot_matrix(GLfloat angle, GLfloat *m) {
+    float rad = angle * M_PI / 180.0f;
+    float c = cos(rad);
+    float s = sin(rad);
+
+    store_matrix_columns(m,
+        c, s, 0.f,
+        -s, c, 0.f,
+        0.f, 0.f, 1.f);
+}
+
+#if defined(AMINO_SIMD_NEON)
+/**
+ * Calculate a result column: a * b (b is a column of the right matrix).
+ */
+static inline float32x4_t mul_matrix_column(float32x4_t a0, float32x4_t a1, float32x4_t a2, float32x4_t a3, float32x4_t b) {
+    float32x4_t col = vmulq_lane_f32(a0, vget_low_f32(b), 0);
+
+    col = vaddq_f32(col, vmulq_lane_f32(a1, vget_low_f32(b), 1));
+    col = vaddq_f32(col, vmulq_lane_f32(a2, vget_high_f32(b), 0));
+    col = vaddq_f32(col, vmulq_lane_f32(a3, vget_high_f32(b), 1));
+
+    return col;
+}
+#endif
+
+/**
+ * Matrix multiplication (4x4).
+ *
+ * Each result column is a linear combination of the columns of a. Same summation order as the scalar version.
+ *
+ * @param prod result (may be a or b)
+ */
+void mul_matrix(GLfloat *prod, const GLfloat *a, const GLfloat *b) {
+#if defined(AMINO_SIMD_NEON)
+    const float32x4_t a0 = vld1q_f32(a);
+    const float32x4_t a1 = vld1q_f32(a + 4);
+    const float32x4_t a2 = vld1q_f32(a + 8);
+    const float32x4_t a3 = vld1q_f32(a + 12);
+
+    const float32x4_t p0 = mul_matrix_column(a0, a1, a2, a3, vld1q_f32(b));
+    const float32x4_t p1 = mul_matrix_column(a0, a1, a2, a3, vld1q_f32(b + 4));
+    const float32x4_t p2 = mul_matrix_column(a0, a1, a2, a3, vld1q_f32(b + 8));
+    const float32x4_t p3 = mul_matrix_column(a0, a1, a2, a3, vld1q_f32(b + 12));
+
+    //store after all reads (prod may alias a or b)
+    vst1q_f32(prod, p0);
+    vst1q_f32(prod + 4, p1);
+    vst1q_f32(prod + 8, p2);
+    vst1q_f32(prod + 12, p3);
+#else
+    mul_matrix_scalar(prod, a, b);
+#endif
+}
+
+/**
+ * Copy a matrix.
+ */
+void copy_matrix(GLfloat *dst, const GLfloat *src) {
+#if defined(AMINO_SIMD_NEON)
+    vst1q_f32(dst, vld1q_f32(src));
+    vst1q_f32(dst + 4, vld1q_f32(src + 4));
+    vst1q_f32(dst + 8, vld1q_f32(src + 8));
+    vst1q_f32(dst + 12, vld1q_f32(src + 12));
+#else
+    copy_matrix_scalar(dst, src);
+#endif
+}
+
+/**
+ * Invert a matrix.
+ *
+ * Note: the cofactors are calculated by the scalar code (shuffle heavy, only used on perspective changes).
+ */
+bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]) {
+#if defined(AMINO_SIMD_NEON)
+    GLfloat inv[16], det;
+
+    adjugate_matrix(m, inv, det);
+
+    if (det == 0) {
+        return false;
+    }
+
+    det = 1.0f / det;
+
+    for (int i = 0; i < 16; i += 4) {
+        vst1q_f32(invOut + i, vmulq_n_f32(vld1q_f32(inv + i), det));
+    }
+
+    return true;
+#else
+    return invert_matrix_scalar(m, invOut);
+#endif
+}
+
+/**
+ * Get the active matrix kernels.
+ */
+const char* get_matrix_simd_mode() {
+#if defined(AMINO_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+/**
+ * Random matrix value.
+ */
+static GLfloat random_matrix_value() {
+    return (GLfloat)rand() / (GLfloat)RAND_MAX * 200.f - 100.f;
+}
+
+/**
+ * Compare two matrices.
+ */
+static bool compare_matrix(const char *name, const GLfloat *expected, const GLfloat *actual, GLfloat tolerance) {
+    for (int i = 0; i < 16; i++) {
+        GLfloat diff = fabsf(expected[i] - actual[i]);
+        GLfloat limit = tolerance * fmaxf(1.f, fabsf(expected[i]));
+
+        if (diff > limit) {
+            printf("%s mismatch at %i: %f != %f\n", name, i, expected[i], actual[i]);
+            print_matrix((GLfloat *)expected);
+            print_matrix((GLfloat *)actual);
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Verify the SIMD kernels against the scalar reference and measure their performance.
+ *
+ * @return true if all results matched
+ */
+bool check_matrix_performance() {
+    const int count = 10000;
+    const int loops = 1000000;
+    bool res = true;
+
+    printf("matrix kernels: %s\n", get_matrix_simd_mode());
+
+    //randomized equivalence
+    srand(time(NULL));
+
+    for (int i = 0; i < count && res; i++) {
+        GLfloat a[16], b[16], exp[16], act[16];
+
+        for (int j = 0; j < 16; j++) {
+            a[j] = random_matrix_value();
+            b[j] = random_matrix_value();
+        }
+
+        //mul
+        mul_matrix_scalar(exp, a, b);
+        mul_matrix(act, a, b);
+        res &= compare_matrix("mul", exp, act, 1e-5f);
+
+        //mul (in-place)
+        copy_matrix(act, a);
+        mul_matrix(act, act, b);
+        res &= compare_matrix("mul in-place", exp, act, 1e-5f);
+
+        //copy
+        copy_matrix_scalar(exp, a);
+        copy_matrix(act, a);
+        res &= compare_matrix("copy", exp, act, 0.f);
+
+        //invert
+        bool expOk = invert_matrix_scalar(a, exp);
+        bool actOk = invert_matrix(a, act);
+
+        if (expOk != actOk) {
+            printf("invert result mismatch\n");
+            res = false;
+        } else if (expOk) {
+            res &= compare_matrix("invert", exp, act, 1e-5f);
+        }
+
+        //rotation
+        GLfloat angle = random_matrix_value() * 3.6f;
+
+        make_x_rot_matrix_scalar(angle, exp);
+        make_x_rot_matrix(angle, act);
+        res &= compare_matrix("x-rot", exp, act, 0.f);
+
+        make_y_rot_matrix_scalar(angle, exp);
+        make_y_rot_matrix(angle, act);
+        res &= compare_matrix("y-rot", exp, act, 0.f);
+
+        make_z_rot_matrix_scalar(angle, exp);
+        make_z_rot_matrix(angle, act);
+        res &= compare_matrix("z-rot", exp, act, 0.f);
+    }
+
+    printf(" -> equivalence: %s (%i samples)\n", res ? "ok":"failed", count);
+
+    //benchmark (chained rotations, keeps the values bounded)
+    GLfloat rot[16], p[16];
+    GLfloat sum = 0;
+
+    make_z_rot_matrix(1.f, rot);
+    make_identity_matrix(p);
+
+    double start = getTime();
+
+    for (int i = 0; i < loops; i++) {
+        mul_matrix_scalar(p, p, rot);
+    }
+
+    double scalarTime = getTime() - start;
+
+    sum += p[0];
+    make_identity_matrix(p);
+    start = getTime();
+
+    for (int i = 0; i < loops; i++) {
+        mul_matrix(p, p, rot);
+    }
+
+    double simdTime = getTime() - start;
+
+    sum += p[0];
+
+    printf(" -> mul_matrix: scalar %i ms, %s %i ms (%i loops, %f)\n", (int)scalarTime, get_matrix_simd_mode(), (int)simdTime, loops, sum);
+
+    return res;
+}
@@ -8,6 +8,13 @@
 
 #include "gfx.h"
 
+//SIMD matrix kernels (ARM only, needs -mfpu=neon; define AMINO_NO_SIMD to use the scalar code)
+#ifndef AMINO_NO_SIMD
+    #if defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define AMINO_SIMD_NEON
+    #endif
+#endif
+
 //these should probably move into the NodeStage class or a GraphicsUtils class
 #define ASSERT_EQ(A, B) {if ((A) != (B)) {printf ("ERROR: %d\n", __LINE__); exit(9); }}
 #define ASSERT_NE(A, B) {if ((A) == (B)) {printf ("ERROR: %d\n", __LINE__); exit(9); }}
@@ -48,4 +55,15 @@ void transpose_matrix(GLfloat *b, const GLfloat *a);
 
 bool invert_matrix(const GLfloat m[16], GLfloat invOut[16]);
 
+//scalar reference
+void make_y_rot_matrix_scalar(GLfloat angle, GLfloat *m);
+void make_z_rot_matrix_scalar(GLfloat angle, GLfloat *m);
+void make_x_rot_matrix_scalar(GLfloat angle, GLfloat *m);
+void mul_matrix_scalar(GLfloat *prod, const GLfloat *a, const GLfloat *b);
+void copy_matrix_scalar(GLfloat *dst, const GLfloat *src);
+bool invert_matrix_scalar(const GLfloat m[16], GLfloat invOut[16]);
+
+const char* get_matrix_simd_mode();
+bool check_matrix_performance();
+
 #endif
\ No newline at end of file
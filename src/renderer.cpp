@@ -1,5 +1,7 @@
 #include "renderer.h"
 
+#include <algorithm>
+
 #define DEBUG_RENDERER false
 #define DEBUG_RENDERER_ERRORS false
 #define DEBUG_FONT_PERFORMANCE 0
@@ -46,6 +48,12 @@ AminoRenderer::~AminoRenderer () {
         fontShader = NULL;
     }
 
+    if (sdfFontShader) {
+        sdfFontShader->destroy();
+        delete sdfFontShader;
+        sdfFontShader = NULL;
+    }
+
     //color lighting shader
     if (colorLightingShader) {
         colorLightingShader->destroy();
@@ -60,6 +68,31 @@ AminoRenderer::~AminoRenderer () {
         textureLightingShader = NULL;
     }
 
+    //batch shaders
+    if (colorBatchShader) {
+        colorBatchShader->destroy();
+        delete colorBatchShader;
+        colorBatchShader = NULL;
+    }
+
+    if (textureBatchShader) {
+        textureBatchShader->destroy();
+        delete textureBatchShader;
+        textureBatchShader = NULL;
+    }
+
+    if (fontBatchShader) {
+        fontBatchShader->destroy();
+        delete fontBatchShader;
+        fontBatchShader = NULL;
+    }
+
+    //batch buffer
+    if (batchBuffer != INVALID_BUFFER) {
+        glDeleteBuffers(1, &batchBuffer);
+        batchBuffer = INVALID_BUFFER;
+    }
+
     //context
     if (ctx) {
         delete ctx;
@@ -99,6 +132,10 @@ void AminoRenderer::setup() {
 
     //context
     ctx = new GLContext();
+
+    //batch vertices
+    batchVertices.reserve(BATCH_VERTICES_SIZE);
+    ctx->allocations++;
 }
 
 /**
@@ -339,9 +376,33 @@ void AminoRenderer::renderScene(AminoNode *node) {
         printf("-> renderScene()\n");
     }
 
+    //stats
+    drawCalls = 0;
+    batches = 0;
+    batchedRects = 0;
+    batchedTexts = 0;
+
+    //root changed (cached world matrix might be relative to another parent)
+    if (node != lastRoot) {
+        if (node) {
+            node->invalidateWorldMatrix();
+        }
+
+        lastRoot = node;
+    }
+
     render(node);
 
     ctx->reset();
+
+    lastDrawCalls = drawCalls;
+    lastBatches = batches;
+    lastBatchedRects = batchedRects;
+    lastBatchedTexts = batchedTexts;
+
+    //uploads since last frame
+    lastAtlasUploadBytes = atlasUploadBytes;
+    atlasUploadBytes = 0;
 }
 
 /**
@@ -365,19 +426,7 @@ void AminoRenderer::render(AminoNode *root) {
     ctx->save();
 
     //transform
-    if (root->propW) {
-        //apply origin
-        ctx->translate(root->propW->value* root->propOriginX->value, root->propH->value * root->propOriginY->value);
-    }
-
-    ctx->translate(root->propX->value, root->propY->value, root->propZ->value);
-    ctx->scale(root->propScaleX->value, root->propScaleY->value);
-    ctx->rotate(root->propRotateX->value, root->propRotateY->value, root->propRotateZ->value);
-
-    if (root->propW) {
-        //apply origin
-        ctx->translate(- (root->propW->value* root->propOriginX->value), - (root->propH->value * root->propOriginY->value));
-    }
+    applyTransform(root);
 
     //draw
     switch (root->type) {
@@ -415,6 +464,24 @@ void AminoRenderer::render(AminoNode *root) {
     ctx->restore();
 }
 
+/**
+ * Apply the node transformation to the current matrix.
+ *
+ * Note: uses the cached world matrix of the node if nothing has changed.
+ */
+void AminoRenderer::applyTransform(AminoNode *node) {
+    if (node->worldMatrixDirty) {
+        if (node->localMatrixDirty) {
+            node->updateLocalMatrix();
+        }
+
+        mul_matrix(node->worldMatrix, ctx->globaltx, node->localMatrix);
+        node->worldMatrixDirty = false;
+    }
+
+    ctx->setMatrix(node->worldMatrix);
+}
+
 /**
  * Use solid color shader.
  */
@@ -444,6 +511,8 @@ void AminoRenderer::applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count,
         colorShader->drawTriangles(count, mode);
     }
 
+    drawCalls++;
+
     //cleanup
     if (hasAlpha) {
         glDisable(GL_BLEND);
@@ -496,6 +565,8 @@ void AminoRenderer::applyTextureShader(GLfloat *verts, GLsizei dim, GLsizei coun
     shader->setTextureCoordinates(uv);
     shader->drawTriangles(count, GL_TRIANGLES);
 
+    drawCalls++;
+
     //cleanup
     glDisable(GL_BLEND);
 }
@@ -573,10 +644,43 @@ void AminoRenderer::drawGroup(AminoGroup *group) {
     ctx->applyOpacity(group->propOpacity->value);
 
     //render items
-    std::size_t count = group->children.size();
+    std::vector<AminoNode *> &children = group->children;
+    std::size_t count = children.size();
+    std::size_t i = 0;
 
-    for (std::size_t i = 0; i < count; i++) {
-        this->render(group->children[i]);
+    while (i < count) {
+        //batch consecutive compatible rects and texts
+        GLuint texture;
+        int type = getBatchType(children[i], texture);
+
+        if (type != BATCH_NONE) {
+            std::size_t end = i + 1;
+
+            while (end < count) {
+                GLuint texture2;
+
+                if (getBatchType(children[end], texture2) != type || texture2 != texture) {
+                    break;
+                }
+
+                end++;
+            }
+
+            if (end - i > 1) {
+                if (type == BATCH_TEXT) {
+                    drawTextBatch(children, i, end, texture);
+                } else {
+                    drawRectBatch(children, i, end, type, texture);
+                }
+
+                i = end;
+
+                continue;
+            }
+        }
+
+        this->render(children[i]);
+        i++;
     }
 
     //restore opacity
@@ -824,6 +928,8 @@ void AminoRenderer::drawModel(AminoModel *model) {
         shader->drawTriangles(vecVertices->size() / 3, GL_TRIANGLES);
     }
 
+    drawCalls++;
+
     //cleanup
     if (!hasAlpha) {
         ctx->disableDepth();
@@ -878,7 +984,10 @@ void AminoRenderer::drawRect(AminoRect *rect) {
         //has optional texture
         AminoTexture *texture = static_cast<AminoTexture *>(rect->propTexture->value);
 
-        if (texture && texture->textureCount > 0) {
+        if (texture && texture->textureCount > 0 && !texture->tiles.empty()) {
+            //large image
+            drawTextureTiles(rect, texture, opacity);
+        } else if (texture && texture->textureCount > 0) {
             //texture
 
             //debug
@@ -918,6 +1027,425 @@ void AminoRenderer::drawRect(AminoRect *rect) {
     ctx->restore();
 }
 
+/**
+ * Draw the tiles of a large image.
+ *
+ * Each uploaded tile is drawn with the part of the texture coordinates it covers. Repeating is not supported.
+ */
+void AminoRenderer::drawTextureTiles(AminoRect *rect, AminoTexture *texture, GLfloat opacity) {
+    float w = rect->propW->value;
+    float h = rect->propH->value;
+    float tx  = rect->propLeft->value;
+    float ty2 = rect->propBottom->value;
+    float tx2 = rect->propRight->value;
+    float ty  = rect->propTop->value;
+
+    if (tx == tx2 || ty == ty2 || texture->w <= 0 || texture->h <= 0) {
+        return;
+    }
+
+    //visible image region
+    float left = std::max(0.f, std::min(tx, tx2));
+    float right = std::min(1.f, std::max(tx, tx2));
+    float top = std::max(0.f, std::min(ty, ty2));
+    float bottom = std::min(1.f, std::max(ty, ty2));
+    std::size_t count = texture->tiles.size();
+
+    for (std::size_t i = 0; i < count; i++) {
+        amino_texture_tile_t &tile = texture->tiles[i];
+
+        if (!tile.uploaded) {
+            continue;
+        }
+
+        //tile region (image coordinates)
+        float u0 = (float)tile.x / texture->w;
+        float u1 = (float)(tile.x + tile.w) / texture->w;
+        float v0 = (float)tile.y / texture->h;
+        float v1 = (float)(tile.y + tile.h) / texture->h;
+
+        //visible part
+        float a0 = std::max(u0, left);
+        float a1 = std::min(u1, right);
+        float b0 = std::max(v0, top);
+        float b1 = std::min(v1, bottom);
+
+        if (a0 >= a1 || b0 >= b1) {
+            continue;
+        }
+
+        //position
+        float x  = (a0 - tx) / (tx2 - tx) * w;
+        float x2 = (a1 - tx) / (tx2 - tx) * w;
+        float y  = (b0 - ty) / (ty2 - ty) * h;
+        float y2 = (b1 - ty) / (ty2 - ty) * h;
+
+        GLfloat verts[6][2];
+
+        verts[0][0] = x;
+        verts[0][1] = y;
+        verts[1][0] = x2;
+        verts[1][1] = y;
+        verts[2][0] = x2;
+        verts[2][1] = y2;
+
+        verts[3][0] = x2;
+        verts[3][1] = y2;
+        verts[4][0] = x;
+        verts[4][1] = y2;
+        verts[5][0] = x;
+        verts[5][1] = y;
+
+        //tile texture coordinates
+        GLfloat texCoords[6][2];
+        float s0 = (a0 - u0) / (u1 - u0);
+        float s1 = (a1 - u0) / (u1 - u0);
+        float t0 = (b0 - v0) / (v1 - v0);
+        float t1 = (b1 - v0) / (v1 - v0);
+
+        texCoords[0][0] = s0;   texCoords[0][1] = t0;
+        texCoords[1][0] = s1;   texCoords[1][1] = t0;
+        texCoords[2][0] = s1;   texCoords[2][1] = t1;
+
+        texCoords[3][0] = s1;   texCoords[3][1] = t1;
+        texCoords[4][0] = s0;   texCoords[4][1] = t1;
+        texCoords[5][0] = s0;   texCoords[5][1] = t0;
+
+        applyTextureShader((float *)verts, 2, 6, texCoords, texture->textureIds[i], opacity, false, false, false);
+    }
+}
+
+/**
+ * Check if a node can be rendered in a batch.
+ *
+ * Returns the batch type and the texture of textured rects and texts.
+ */
+int AminoRenderer::getBatchType(AminoNode *node, GLuint &texture) {
+    texture = INVALID_TEXTURE;
+
+    if (!node->propVisible->value) {
+        return BATCH_NONE;
+    }
+
+    if (node->type == TEXT) {
+        return getTextBatchType(static_cast<AminoText *>(node), texture);
+    }
+
+    if (node->type != RECT) {
+        return BATCH_NONE;
+    }
+
+    AminoRect *rect = static_cast<AminoRect *>(node);
+
+    if (!rect->hasImage) {
+        return BATCH_COLOR;
+    }
+
+    //texture
+    AminoTexture *tex = static_cast<AminoTexture *>(rect->propTexture->value);
+
+    if (!tex || tex->textureCount == 0 || !tex->tiles.empty()) {
+        return BATCH_NONE;
+    }
+
+    //clamp to border needs own shader
+    float tx  = rect->propLeft->value;
+    float ty2 = rect->propBottom->value;
+    float tx2 = rect->propRight->value;
+    float ty  = rect->propTop->value;
+
+    if ((tx < 0 || tx > 1) || (tx2 < 0 || tx2 > 1) || (ty < 0 || ty > 1) || (ty2 < 0 || ty2 > 1) || rect->repeatX || rect->repeatY) {
+        return BATCH_NONE;
+    }
+
+    tex->prepareTexture(ctx);
+    texture = tex->getTexture();
+
+    if (texture == INVALID_TEXTURE) {
+        return BATCH_NONE;
+    }
+
+    return BATCH_TEXTURE;
+}
+
+/**
+ * Check if a text can be rendered in a text batch.
+ *
+ * Note: only texts on a single atlas page. SDF texts need their own smoothing value.
+ */
+int AminoRenderer::getTextBatchType(AminoText *text, GLuint &texture) {
+    amino_text_mesh_t *mesh = text->mesh;
+
+    if (!mesh || mesh->batches.size() != 1 || !text->hasValidBatches()) {
+        return BATCH_NONE;
+    }
+
+    if (text->fontSize->fontTexture->rendermode == RENDER_SIGNED_DISTANCE_FIELD) {
+        return BATCH_NONE;
+    }
+
+    texture = mesh->batches[0].textureId;
+
+    return BATCH_TEXT;
+}
+
+/**
+ * Draw consecutive rects with a single draw call.
+ *
+ * The vertices are transformed on the CPU and streamed to a shared VBO.
+ */
+void AminoRenderer::drawRectBatch(std::vector<AminoNode *> &nodes, std::size_t start, std::size_t end, int type, GLuint texture) {
+    if (DEBUG_RENDERER) {
+        printf("-> drawRectBatch() rects=%i type=%i\n", (int)(end - start), type);
+    }
+
+    //collect vertices
+    GLsizei stride = type == BATCH_COLOR ? 7 : 6;
+    bool hasAlpha = false;
+
+    batchVertices.clear();
+    reserveBatchVertices((end - start) * 6 * stride);
+
+    for (std::size_t i = start; i < end; i++) {
+        AminoRect *rect = static_cast<AminoRect *>(nodes[i]);
+
+        //world matrix
+        ctx->save();
+        applyTransform(rect);
+
+        GLfloat *m = ctx->globaltx;
+        GLfloat w = rect->propW->value;
+        GLfloat h = rect->propH->value;
+        GLfloat opacity = rect->propOpacity->value * ctx->opacity;
+
+        //corners (two triangles)
+        GLfloat corners[6][2] = {
+            { 0, 0 }, { w, 0 }, { w, h },
+            { w, h }, { 0, h }, { 0, 0 }
+        };
+
+        GLfloat texCoords[6][2];
+
+        if (type == BATCH_TEXTURE) {
+            float tx  = rect->propLeft->value;
+            float ty2 = rect->propBottom->value;
+            float tx2 = rect->propRight->value;
+            float ty  = rect->propTop->value;
+
+            texCoords[0][0] = tx;    texCoords[0][1] = ty;
+            texCoords[1][0] = tx2;   texCoords[1][1] = ty;
+            texCoords[2][0] = tx2;   texCoords[2][1] = ty2;
+
+            texCoords[3][0] = tx2;   texCoords[3][1] = ty2;
+            texCoords[4][0] = tx;    texCoords[4][1] = ty2;
+            texCoords[5][0] = tx;    texCoords[5][1] = ty;
+        } else if (opacity != 1.0) {
+            hasAlpha = true;
+        }
+
+        for (int j = 0; j < 6; j++) {
+            GLfloat x = corners[j][0];
+            GLfloat y = corners[j][1];
+
+            //transform (z = 0)
+            batchVertices.push_back(m[0] * x + m[4] * y + m[12]);
+            batchVertices.push_back(m[1] * x + m[5] * y + m[13]);
+            batchVertices.push_back(m[2] * x + m[6] * y + m[14]);
+
+            if (type == BATCH_COLOR) {
+                batchVertices.push_back(rect->propR->value);
+                batchVertices.push_back(rect->propG->value);
+                batchVertices.push_back(rect->propB->value);
+                batchVertices.push_back(opacity);
+            } else {
+                batchVertices.push_back(texCoords[j][0]);
+                batchVertices.push_back(texCoords[j][1]);
+                batchVertices.push_back(opacity);
+            }
+        }
+
+        ctx->restore();
+    }
+
+    GLsizei vertexCount = batchVertices.size() / stride;
+
+    //upload (orphan previous data)
+    if (batchBuffer == INVALID_BUFFER) {
+        glGenBuffers(1, &batchBuffer);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batchBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * batchVertices.size(), batchVertices.data(), GL_STREAM_DRAW);
+
+    //vertices are already transformed
+    GLfloat identity[16];
+
+    make_identity_matrix(identity);
+
+    if (type == BATCH_COLOR) {
+        if (!colorBatchShader) {
+            colorBatchShader = new ColorBatchShader();
+
+            bool res = colorBatchShader->create();
+
+            assert(res);
+        }
+
+        ctx->useShader(colorBatchShader);
+
+        if (hasAlpha) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+
+        colorBatchShader->setTransformation(modelView, identity);
+        colorBatchShader->setBatchData();
+        colorBatchShader->drawTriangles(vertexCount, GL_TRIANGLES);
+
+        if (hasAlpha) {
+            glDisable(GL_BLEND);
+        }
+    } else {
+        if (!textureBatchShader) {
+            textureBatchShader = new TextureBatchShader();
+
+            bool res = textureBatchShader->create();
+
+            assert(res);
+        }
+
+        ctx->useShader(textureBatchShader);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        textureBatchShader->setTransformation(modelView, identity);
+        ctx->bindTexture(texture);
+        textureBatchShader->setBatchData();
+        textureBatchShader->drawTriangles(vertexCount, GL_TRIANGLES);
+
+        glDisable(GL_BLEND);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    //stats
+    drawCalls++;
+    batches++;
+    batchedRects += end - start;
+}
+
+/**
+ * Draw consecutive texts using the same atlas page with a single draw call.
+ *
+ * The glyph vertices are transformed on the CPU and streamed to the shared batch VBO (with the color and opacity of each text).
+ */
+void AminoRenderer::drawTextBatch(std::vector<AminoNode *> &nodes, std::size_t start, std::size_t end, GLuint texture) {
+    if (DEBUG_RENDERER) {
+        printf("-> drawTextBatch() texts=%i\n", (int)(end - start));
+    }
+
+    //collect vertices
+    const GLsizei stride = 9;
+    size_t size = 0;
+
+    batchVertices.clear();
+
+    for (std::size_t i = start; i < end; i++) {
+        size += static_cast<AminoText *>(nodes[i])->mesh->batches[0].count * stride;
+    }
+
+    reserveBatchVertices(size);
+
+    for (std::size_t i = start; i < end; i++) {
+        AminoText *text = static_cast<AminoText *>(nodes[i]);
+        amino_text_mesh_t *mesh = text->mesh;
+        vertex_buffer_t *buffer = mesh->buffer;
+        amino_text_batch_t &batch = mesh->batches[0];
+
+        //world matrix
+        ctx->save();
+        applyTransform(text);
+        applyTextAlignment(text, mesh);
+
+        GLfloat *m = ctx->globaltx;
+        GLfloat r = text->propR->value;
+        GLfloat g = text->propG->value;
+        GLfloat b = text->propB->value;
+        GLfloat opacity = text->propOpacity->value * ctx->opacity;
+
+        //indexed glyph quads to triangles
+        GLushort *indices = (GLushort *)vector_get(buffer->indices, batch.start);
+
+        for (size_t j = 0; j < batch.count; j++) {
+            vertex_t *vertex = (vertex_t *)vector_get(buffer->vertices, indices[j]);
+            GLfloat x = vertex->x;
+            GLfloat y = vertex->y;
+
+            //transform (z = 0)
+            batchVertices.push_back(m[0] * x + m[4] * y + m[12]);
+            batchVertices.push_back(m[1] * x + m[5] * y + m[13]);
+            batchVertices.push_back(m[2] * x + m[6] * y + m[14]);
+
+            batchVertices.push_back(vertex->s);
+            batchVertices.push_back(vertex->t);
+
+            batchVertices.push_back(r);
+            batchVertices.push_back(g);
+            batchVertices.push_back(b);
+            batchVertices.push_back(opacity);
+        }
+
+        ctx->restore();
+    }
+
+    GLsizei vertexCount = batchVertices.size() / stride;
+
+    if (vertexCount == 0) {
+        return;
+    }
+
+    //upload (orphan previous data)
+    if (batchBuffer == INVALID_BUFFER) {
+        glGenBuffers(1, &batchBuffer);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batchBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * batchVertices.size(), batchVertices.data(), GL_STREAM_DRAW);
+
+    //vertices are already transformed
+    GLfloat identity[16];
+
+    make_identity_matrix(identity);
+
+    if (!fontBatchShader) {
+        fontBatchShader = new AminoFontBatchShader();
+
+        bool res = fontBatchShader->create();
+
+        assert(res);
+    }
+
+    ctx->useShader(fontBatchShader);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    fontBatchShader->setTransformation(modelView, identity);
+    ctx->bindTexture(texture);
+    fontBatchShader->setBatchData();
+    fontBatchShader->drawTriangles(vertexCount, GL_TRIANGLES);
+
+    glDisable(GL_BLEND);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    //stats
+    drawCalls++;
+    batches++;
+    batchedTexts += end - start;
+}
+
 /**
  * Render text.
  */
@@ -926,20 +1454,116 @@ void AminoRenderer::drawText(AminoText *text) {
         printf("-> drawText()\n");
     }
 
-    //get texture
-    GLuint texture = text->getTextureId();
+    //check textures
+    amino_text_mesh_t *mesh = text->mesh;
 
-    if (texture == INVALID_TEXTURE) {
+    if (!mesh || mesh->batches.empty()) {
         return;
     }
 
+    if (!text->hasValidBatches()) {
+        //atlas page was repacked (layout again in next frame)
+        gfx->textUpdateNeeded(text);
+
+        //draw the previous page texture meanwhile (if not repacked twice)
+        for (auto const &batch : mesh->batches) {
+            if (!fontShader->hasBatchTexture(batch)) {
+                return;
+            }
+        }
+    }
+
     ctx->save();
 
+    //alignment
+    applyTextAlignment(text, mesh);
+
+    //use texture
+    if (DEBUG_RENDERER_ERRORS) {
+        showGLErrors("updateTexture()");
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    //font shader
+    texture_font_t *tf = text->fontSize->fontTexture;
+    float scale = text->fontSize->scale;
+    AminoFontShader *shader = fontShader;
+
+    if (tf->rendermode == RENDER_SIGNED_DISTANCE_FIELD) {
+        if (!sdfFontShader) {
+            sdfFontShader = new AminoSdfFontShader();
+
+            bool res = sdfFontShader->create();
+
+            assert(res);
+        }
+
+        shader = sdfFontShader;
+    }
+
+    ctx->useShader(shader);
+
+    //color & opacity
+    shader->setTransformation(modelView, ctx->globaltx);
+    shader->setOpacity(ctx->opacity * text->propOpacity->value);
+
+    GLfloat color[3] = { text->propR->value, text->propG->value, text->propB->value };
+
+    shader->setColor(color);
+
+    if (shader == sdfFontShader) {
+        //pixels per glyph texel (font size and node transformation)
+        GLfloat *m = ctx->globaltx;
+        float pixelScale = scale * sqrtf(fabsf(m[0] * m[5] - m[1] * m[4]));
+
+        //distance field values of one pixel (0.5 / spread per texel), half of it on each side of the outline
+        float smoothing = pixelScale > 0 ? 0.25f / (tf->sdf_spread * pixelScale) : 0.5f;
+
+        sdfFontShader->setSmoothing(std::min(smoothing, 0.5f));
+    }
+
+    if (DEBUG_RENDERER_ERRORS) {
+        showGLErrors("before text rendering");
+    }
+
+    //render (one draw call per atlas page)
+    vertex_buffer_render_setup(mesh->buffer, GL_TRIANGLES);
+
+    for (auto const &batch : mesh->batches) {
+        ctx->bindTexture(batch.textureId);
+        glDrawElements(GL_TRIANGLES, batch.count, GL_UNSIGNED_SHORT, (void *)(batch.start * sizeof(GLushort)));
+        drawCalls++;
+    }
+
+    vertex_buffer_render_finish(mesh->buffer);
+
+    if (DEBUG_RENDERER_ERRORS) {
+        showGLErrors("after text rendering");
+    }
+
+    //cleanup
+    glDisable(GL_BLEND);
+
+    ctx->restore();
+}
+
+/**
+ * Flip the y axis and move the baseline (text alignment).
+ */
+void AminoRenderer::applyTextAlignment(AminoText *text, amino_text_mesh_t *mesh) {
     //flip the y axis
     ctx->scale(1, -1);
 
     //baseline at top/left
     texture_font_t *tf = text->fontSize->fontTexture;
+    float scale = text->fontSize->scale;
+    float ascender = tf->ascender * scale;
+    float descender = tf->descender * scale;
+    float height = tf->height * scale;
 
     //debug
     //sprintf("font: size=%f height=%f ascender=%f descender=%f\n", tf->size, tf->height, tf->ascender, tf->descender);
@@ -947,11 +1571,11 @@ void AminoRenderer::drawText(AminoText *text) {
     //horizontal alignment
     switch (text->align) {
         case AminoText::ALIGN_CENTER:
-            ctx->translate((text->propW->value - text->lineW) / 2, 0);
+            ctx->translate((text->propW->value - mesh->lineW) / 2, 0);
             break;
 
         case AminoText::ALIGN_RIGHT:
-            ctx->translate(text->propW->value - text->lineW, 0);
+            ctx->translate(text->propW->value - mesh->lineW, 0);
             break;
 
         case AminoText::ALIGN_LEFT:
@@ -962,76 +1586,89 @@ void AminoRenderer::drawText(AminoText *text) {
     //vertical alignment
     switch (text->vAlign) {
         case AminoText::VALIGN_TOP:
-            ctx->translate(0, -tf->ascender);
+            ctx->translate(0, -ascender);
             break;
 
         case AminoText::VALIGN_BOTTOM:
-            ctx->translate(0, - text->propH->value - tf->descender + (text->lineNr - 1) * tf->height);
+            ctx->translate(0, - text->propH->value - descender + (mesh->lineNr - 1) * height);
             break;
 
         case AminoText::VALIGN_MIDDLE:
-            ctx->translate(0, - tf->ascender - (text->propH->value - text->lineNr * tf->height) / 2);
+            ctx->translate(0, - ascender - (text->propH->value - mesh->lineNr * height) / 2);
             break;
 
         case AminoText::VALIGN_BASELINE:
         default:
             break;
     }
+}
 
-    //use texture
-    if (DEBUG_RENDERER_ERRORS) {
-        showGLErrors("updateTexture()");
-    }
-
-    glActiveTexture(GL_TEXTURE0);
-    ctx->bindTexture(texture);
+/**
+ * Get texture for atlas page.
+ *
+ * Note: has to be called on OpenGL thread, freeTypeMutex must be locked.
+ */
+amino_atlas_t AminoRenderer::getAtlasTexture(amino_font_page_t *page, bool createIfMissing, bool &newTexture) {
+    assert(fontShader);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    int textureDelta;
+    amino_atlas_t res = fontShader->getAtlasTexture(page, createIfMissing, textureDelta);
 
-    //font shader
-    ctx->useShader(fontShader);
+    newTexture = textureDelta > 0;
 
-    //color & opacity
-    fontShader->setTransformation(modelView, ctx->globaltx);
-    fontShader->setOpacity(ctx->opacity * text->propOpacity->value);
+    if (textureDelta != 0) {
+        gfx->notifyTextureCreated(textureDelta);
+    }
 
-    GLfloat color[3] = { text->propR->value, text->propG->value, text->propB->value };
+    return res;
+}
 
-    fontShader->setColor(color);
+/**
+ * Count uploaded atlas texture data.
+ */
+void AminoRenderer::addAtlasUploadBytes(size_t bytes) {
+    atlasUploadBytes += bytes;
+}
 
-    if (DEBUG_RENDERER_ERRORS) {
-        showGLErrors("before text rendering");
+/**
+ * Count allocations of the reused rendering buffers (texture row buffers not available in the pool).
+ */
+void AminoRenderer::addBufferAllocations(int count) {
+    if (ctx) {
+        ctx->allocations += count;
     }
+}
 
-    //render
-    vertex_buffer_render(text->buffer, GL_TRIANGLES);
-
-    if (DEBUG_RENDERER_ERRORS) {
-        showGLErrors("after text rendering");
+/**
+ * Grow the batch vertices (only if the preallocated capacity is exceeded).
+ */
+void AminoRenderer::reserveBatchVertices(size_t size) {
+    if (size <= batchVertices.capacity()) {
+        return;
     }
 
-    //cleanup
-    glDisable(GL_BLEND);
-
-    ctx->restore();
+    batchVertices.reserve(std::max(size, batchVertices.capacity() * 2));
+    ctx->allocations++;
 }
 
 /**
- * Get texture for atlas.
- *
- * Note: has to be called on OpenGL thread (if createIfMissing is true).
+ * Add renderer stats (last frame).
  */
-amino_atlas_t AminoRenderer::getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture) {
-    assert(fontShader);
+void AminoRenderer::getStats(v8::Local<v8::Object> &obj) {
+    v8::Local<v8::Object> rendererObj = Nan::New<v8::Object>();
 
-    amino_atlas_t res = fontShader->getAtlasTexture(atlas, createIfMissing, newTexture);
+    Nan::Set(rendererObj, Nan::New("drawCalls").ToLocalChecked(), Nan::New(lastDrawCalls));
+    Nan::Set(rendererObj, Nan::New("batches").ToLocalChecked(), Nan::New(lastBatches));
+    Nan::Set(rendererObj, Nan::New("batchedRects").ToLocalChecked(), Nan::New(lastBatchedRects));
+    Nan::Set(rendererObj, Nan::New("batchedTexts").ToLocalChecked(), Nan::New(lastBatchedTexts));
+    Nan::Set(rendererObj, Nan::New("atlasUploadBytes").ToLocalChecked(), Nan::New<v8::Number>(lastAtlasUploadBytes));
 
-    if (newTexture) {
-        gfx->notifyTextureCreated(1);
+    //allocations of the reused buffers: stacks, batch vertices and texture row buffers (should not grow while rendering)
+    if (ctx) {
+        Nan::Set(rendererObj, Nan::New("bufferAllocations").ToLocalChecked(), Nan::New(ctx->allocations));
     }
 
-    return res;
+    Nan::Set(obj, Nan::New("renderer").ToLocalChecked(), rendererObj);
 }
 
 /**
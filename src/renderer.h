@@ -5,15 +5,21 @@
 
 #include "mathutils.h"
 
-#include <stack>
+#define GLCONTEXT_STACK_SIZE 32
+
+//preallocated batch vertices (floats, 256 colored rects)
+#define BATCH_VERTICES_SIZE (256 * 6 * 7)
 
 /**
  * Rendering context.
+ *
+ * Note: matrix and opacity stacks are preallocated (no allocations while rendering). The allocation counter also covers
+ *       the batch vertices and the texture row buffers, not other heap allocations of the rendering thread.
  */
 class GLContext {
 public:
-    std::stack<void *> matrixStack;
-    GLfloat *globaltx = new GLfloat[16];
+    //current matrix (points to top of matrix stack)
+    GLfloat *globaltx = NULL;
     GLfloat opacity = 1;
 
     int depth = 0;
@@ -21,11 +27,22 @@ public:
     AnyAminoShader *prevShader = NULL;
     GLuint prevTex = INVALID_TEXTURE;
 
+    //stats (reused buffer allocations)
+    int allocations = 0;
+
     /**
      * Constructor.
      */
     GLContext() {
+        //stacks
+        matrixStack = new GLfloat[GLCONTEXT_STACK_SIZE * 16];
+        opacityStack = new GLfloat[GLCONTEXT_STACK_SIZE];
+        matrixCapacity = GLCONTEXT_STACK_SIZE;
+        opacityCapacity = GLCONTEXT_STACK_SIZE;
+        allocations += 2;
+
         //matrix
+        globaltx = matrixStack;
         make_identity_matrix(globaltx);
     }
 
@@ -33,15 +50,19 @@ public:
      * Destructor.
      */
     virtual ~GLContext() {
-        assert(matrixStack.empty());
-        delete[] globaltx;
+        assert(matrixPos == 0);
+        assert(opacityPos == 0);
+
+        delete[] matrixStack;
+        delete[] opacityStack;
     }
 
     /**
      * Reset context (prepare for next cycle).
      */
     void reset() {
-        assert(matrixStack.empty());
+        assert(matrixPos == 0);
+        assert(opacityPos == 0);
         assert(depth == 0);
 
         //reset
@@ -67,6 +88,13 @@ public:
         print_matrix(globaltx);
     }
 
+    /**
+     * Replace the current matrix.
+     */
+    void setMatrix(GLfloat *m) {
+        copy_matrix(globaltx, m);
+    }
+
     /**
      * Translate x/y.
      */
@@ -136,46 +164,60 @@ public:
      * Save opacity.
      */
     void saveOpacity() {
-        GLfloat *temp = new GLfloat[1];
+        if (opacityPos == opacityCapacity) {
+            //grow
+            GLfloat *temp = new GLfloat[opacityCapacity * 2];
+
+            memcpy(temp, opacityStack, opacityCapacity * sizeof(GLfloat));
+            delete[] opacityStack;
+            opacityStack = temp;
+            opacityCapacity *= 2;
+            allocations++;
+        }
 
-        temp[0] = opacity;
-        matrixStack.push(temp);
+        opacityStack[opacityPos++] = opacity;
     }
 
     /**
      * Restore the opacity.
      */
     void restoreOpacity() {
-        GLfloat *temp = (GLfloat *)matrixStack.top();
+        assert(opacityPos > 0);
 
-        matrixStack.pop();
-
-        opacity = temp[0];
-        delete[] temp;
+        opacity = opacityStack[--opacityPos];
     }
 
     /**
      * Save matrix.
      */
     void save() {
-        //matrix
-        GLfloat *temp = new GLfloat[16];
+        if (matrixPos + 1 == matrixCapacity) {
+            //grow
+            GLfloat *temp = new GLfloat[matrixCapacity * 2 * 16];
+
+            memcpy(temp, matrixStack, matrixCapacity * 16 * sizeof(GLfloat));
+            delete[] matrixStack;
+            matrixStack = temp;
+            matrixCapacity *= 2;
+            allocations++;
+        }
+
+        //copy current matrix to next slot
+        GLfloat *next = matrixStack + (matrixPos + 1) * 16;
 
-        copy_matrix(temp, globaltx);
-        matrixStack.push(globaltx);
-        globaltx = temp;
+        copy_matrix(next, matrixStack + matrixPos * 16);
+        matrixPos++;
+        globaltx = next;
     }
 
     /**
      * Restore matrix.
      */
     void restore() {
-        //matrix
-        delete[] globaltx;
-        globaltx = (GLfloat *)matrixStack.top();
-        matrixStack.pop();
+        assert(matrixPos > 0);
 
-        assert(globaltx);
+        matrixPos--;
+        globaltx = matrixStack + matrixPos * 16;
     }
 
     /**
@@ -260,6 +302,17 @@ public:
             glDepthMask(GL_FALSE);
         }
     }
+
+private:
+    //matrix stack (16 values per entry)
+    GLfloat *matrixStack = NULL;
+    int matrixPos = 0;
+    int matrixCapacity = 0;
+
+    //opacity stack
+    GLfloat *opacityStack = NULL;
+    int opacityPos = 0;
+    int opacityCapacity = 0;
 };
 
 /**
@@ -277,15 +330,27 @@ public:
     virtual void initScene(GLfloat r, GLfloat g, GLfloat b, GLfloat opacity);
     virtual void renderScene(AminoNode *node);
 
-    amino_atlas_t getAtlasTexture(texture_atlas_t *atlas, bool createIfMissing, bool &newTexture);
+    amino_atlas_t getAtlasTexture(amino_font_page_t *page, bool createIfMissing, bool &newTexture);
 
     static int showGLErrors();
     static int showGLErrors(std::string msg);
 
     static void checkTexturePerformance();
 
+    //stats
+    void addAtlasUploadBytes(size_t bytes);
+    void addBufferAllocations(int count);
+    void getStats(v8::Local<v8::Object> &obj);
+
 protected:
+    //rect & text batching
+    static const int BATCH_NONE    = 0x0;
+    static const int BATCH_COLOR   = 0x1;
+    static const int BATCH_TEXTURE = 0x2;
+    static const int BATCH_TEXT    = 0x3;
+
     virtual void render(AminoNode *node);
+    void applyTransform(AminoNode *node);
 
     virtual void drawGroup(AminoGroup *group);
     virtual void drawRect(AminoRect *rect);
@@ -293,11 +358,20 @@ protected:
     virtual void drawModel(AminoModel *model);
     virtual void drawText(AminoText *text);
 
+    void applyTextAlignment(AminoText *text, amino_text_mesh_t *mesh);
+    void drawTextureTiles(AminoRect *rect, AminoTexture *texture, GLfloat opacity);
+
+    int getBatchType(AminoNode *node, GLuint &texture);
+    int getTextBatchType(AminoText *text, GLuint &texture);
+    void drawRectBatch(std::vector<AminoNode *> &nodes, std::size_t start, std::size_t end, int type, GLuint texture);
+    void drawTextBatch(std::vector<AminoNode *> &nodes, std::size_t start, std::size_t end, GLuint texture);
+
 private:
     AminoGfx *gfx;
 
     //basic shaders
     AminoFontShader *fontShader = NULL;
+    AminoSdfFontShader *sdfFontShader = NULL;
     ColorShader *colorShader = NULL;
     TextureShader *textureShader = NULL;
     TextureClampToBorderShader *textureClampToBorderShader = NULL;
@@ -306,6 +380,29 @@ private:
     ColorLightingShader *colorLightingShader = NULL;
     TextureLightingShader *textureLightingShader = NULL;
 
+    //batch shaders
+    ColorBatchShader *colorBatchShader = NULL;
+    TextureBatchShader *textureBatchShader = NULL;
+    AminoFontBatchShader *fontBatchShader = NULL;
+
+    //batch buffer (streamed)
+    GLuint batchBuffer = INVALID_BUFFER;
+    std::vector<GLfloat> batchVertices;
+
+    void reserveBatchVertices(size_t size);
+
+    //stats (per frame)
+    int drawCalls = 0;
+    int batches = 0;
+    int batchedRects = 0;
+    int batchedTexts = 0;
+    int lastDrawCalls = 0;
+    int lastBatches = 0;
+    int lastBatchedRects = 0;
+    int lastBatchedTexts = 0;
+    size_t atlasUploadBytes = 0;
+    size_t lastAtlasUploadBytes = 0;
+
     //perspective
     bool orthographic = true;
     float near = 150;
@@ -320,6 +417,7 @@ private:
     //matrix
     GLfloat modelView[16];
     GLContext *ctx = NULL;
+    AminoNode *lastRoot = NULL;
 
     void applyColorShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat color[4], GLenum mode = GL_TRIANGLES);
     void applyTextureShader(GLfloat *verts, GLsizei dim, GLsizei count, GLfloat uv[][2], GLuint texId, GLfloat opacity, bool needsClampToBorder, bool repeatX, bool repeatY);
@@ -885,14 +885,14 @@ void AminoGfxRPi::updateWindowTitle() {
 /**
  * Shared atlas texture has changed.
  */
-void AminoGfxRPi::atlasTextureHasChanged(texture_atlas_t *atlas) {
+void AminoGfxRPi::atlasTextureHasChanged(amino_atlas_update_t *update) {
     //check single instance case
     if (instanceCount == 1) {
         return;
     }
 
     //run on main thread
-    enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoGfxRPi::atlasTextureHasChangedHandler), NULL, atlas);
+    enqueueJSCallbackUpdate(static_cast<jsUpdateCallback>(&AminoGfxRPi::atlasTextureHasChangedHandler), static_cast<jsUpdateCallback>(&AminoGfxRPi::atlasTextureHasChangedDone), new amino_atlas_update_t(*update));
 }
 
 /**
@@ -900,14 +900,14 @@ void AminoGfxRPi::atlasTextureHasChanged(texture_atlas_t *atlas) {
  */
 void AminoGfxRPi::atlasTextureHasChangedHandler(JSCallbackUpdate *update) {
     AminoGfx *gfx = static_cast<AminoGfx *>(update->obj);
-    texture_atlas_t *atlas = (texture_atlas_t *)update->data;
+    amino_atlas_update_t *atlasUpdate = (amino_atlas_update_t *)update->data;
 
     for (auto const &item : instances) {
         if (gfx == item) {
             continue;
         }
 
-        static_cast<AminoGfxRPi *>(item)->updateAtlasTexture(atlas);
+        static_cast<AminoGfxRPi *>(item)->updateAtlasTexture(atlasUpdate);
     }
 }
 
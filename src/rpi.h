@@ -86,7 +86,7 @@ private:
     void updateWindowPosition() override;
     void updateWindowTitle() override;
 
-    void atlasTextureHasChanged(texture_atlas_t *atlas) override;
+    void atlasTextureHasChanged(amino_atlas_update_t *update) override;
     void atlasTextureHasChangedHandler(JSCallbackUpdate *update);
 
     AminoVideoPlayer *createVideoPlayer(AminoTexture *texture, AminoVideo *video) override;
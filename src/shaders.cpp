@@ -117,6 +117,15 @@ GLuint AnyShader::compileShader(std::string source, const GLenum type) {
     source = "#version 100\n" + source;
 #endif
 
+#ifdef HEADLESS
+    //add GLSL version (default precision is mandatory in OpenGL ES fragment shaders)
+    if (type == GL_FRAGMENT_SHADER) {
+        source = "precision mediump float;\n" + source;
+    }
+
+    source = "#version 100\n" + source;
+#endif
+
     GLchar *src = (GLchar *)source.c_str();
 
     glShaderSource(handle, 1, (const GLchar **)&src, NULL);
@@ -610,6 +619,159 @@ void TextureClampToBorderShader::setRepeat(bool repeatX, bool repeatY) {
     glUniform2i(uRepeat, repeatX, repeatY);
 }
 
+//
+// ColorBatchShader
+//
+
+/**
+ * Create color batch shader.
+ */
+ColorBatchShader::ColorBatchShader() : AnyAminoShader() {
+    //shaders
+    vertexShader = R"(
+        uniform mat4 mvp;
+        uniform mat4 trans;
+
+        attribute vec4 pos;
+        attribute vec4 color;
+
+        varying vec4 vColor;
+
+        void main() {
+            gl_Position = mvp * trans * pos;
+            vColor = color;
+        }
+    )";
+
+    fragmentShader = R"(
+        varying vec4 vColor;
+
+        void main() {
+            gl_FragColor = vColor;
+        }
+    )";
+}
+
+/**
+ * Initialize the color batch shader.
+ */
+void ColorBatchShader::initShader() {
+    AnyAminoShader::initShader();
+
+    //attributes
+    aColor = getAttributeLocation("color");
+}
+
+/**
+ * Set interleaved vertex data of the bound VBO.
+ */
+void ColorBatchShader::setBatchData() {
+    GLsizei stride = 7 * sizeof(GLfloat);
+
+    glVertexAttribPointer(aPos, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glVertexAttribPointer(aColor, 4, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(GLfloat)));
+}
+
+/**
+ * Draw triangles.
+ */
+void ColorBatchShader::drawTriangles(GLsizei vertices, GLenum mode) {
+    glEnableVertexAttribArray(aColor);
+
+    AnyAminoShader::drawTriangles(vertices, mode);
+
+    glDisableVertexAttribArray(aColor);
+}
+
+//
+// TextureBatchShader
+//
+
+/**
+ * Create texture batch shader.
+ */
+TextureBatchShader::TextureBatchShader() : AnyAminoShader() {
+    //shaders
+    vertexShader = R"(
+        uniform mat4 mvp;
+        uniform mat4 trans;
+
+        attribute vec4 pos;
+        attribute vec2 texCoord;
+        attribute float opacity;
+
+        varying vec2 uv;
+        varying float vOpacity;
+
+        void main() {
+            gl_Position = mvp * trans * pos;
+            uv = texCoord;
+            vOpacity = opacity;
+        }
+    )";
+
+    fragmentShader = R"(
+        varying vec2 uv;
+        varying float vOpacity;
+
+        uniform sampler2D tex;
+
+        void main() {
+            vec4 pixel = texture2D(tex, uv);
+
+            //discard transparent pixels
+            if (pixel.a == 0.) {
+                discard;
+            }
+
+            gl_FragColor = vec4(pixel.rgb, pixel.a * vOpacity);
+        }
+    )";
+}
+
+/**
+ * Initialize the texture batch shader.
+ */
+void TextureBatchShader::initShader() {
+    AnyAminoShader::initShader();
+
+    //attributes
+    aTexCoord = getAttributeLocation("texCoord");
+    aOpacity = getAttributeLocation("opacity");
+
+    //uniforms
+    uTex = getUniformLocation("tex");
+
+    //default values
+    glUniform1i(uTex, 0); //GL_TEXTURE0
+}
+
+/**
+ * Set interleaved vertex data of the bound VBO.
+ */
+void TextureBatchShader::setBatchData() {
+    GLsizei stride = 6 * sizeof(GLfloat);
+
+    glVertexAttribPointer(aPos, 3, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    glVertexAttribPointer(aTexCoord, 2, GL_FLOAT, GL_FALSE, stride, (void *)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(aOpacity, 1, GL_FLOAT, GL_FALSE, stride, (void *)(5 * sizeof(GLfloat)));
+}
+
+/**
+ * Draw triangles.
+ */
+void TextureBatchShader::drawTriangles(GLsizei vertices, GLenum mode) {
+    glEnableVertexAttribArray(aTexCoord);
+    glEnableVertexAttribArray(aOpacity);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    AnyAminoShader::drawTriangles(vertices, mode);
+
+    glDisableVertexAttribArray(aTexCoord);
+    glDisableVertexAttribArray(aOpacity);
+}
+
 //
 // TextureLightingShader
 //
@@ -143,6 +143,49 @@ protected:
     void initShader() override;
 };
 
+/**
+ * Color shader using per vertex colors (batched rendering).
+ *
+ * Interleaved vertex data: x, y, z, r, g, b, a.
+ */
+class ColorBatchShader : public AnyAminoShader {
+public:
+    ColorBatchShader();
+
+    //per vertex data (VBO)
+    void setBatchData();
+
+    //draw
+    void drawTriangles(GLsizei vertices, GLenum mode) override;
+
+protected:
+    GLint aColor;
+
+    void initShader() override;
+};
+
+/**
+ * Texture shader using per vertex opacity (batched rendering).
+ *
+ * Interleaved vertex data: x, y, z, u, v, opacity.
+ */
+class TextureBatchShader : public AnyAminoShader {
+public:
+    TextureBatchShader();
+
+    //per vertex data (VBO)
+    void setBatchData();
+
+    //draw
+    void drawTriangles(GLsizei vertices, GLenum mode) override;
+
+protected:
+    GLint aTexCoord, aOpacity;
+    GLint uTex;
+
+    void initShader() override;
+};
+
 /**
  * Texture Lighting Shader.
  */